@@ -0,0 +1,66 @@
+// Samples per second of Field3DGrid with the ROW_MAJOR and BRICK layouts, on one thread.
+// The coherent walks step along x or along z between samples, the random walk jumps anywhere in the grid.
+
+#include "Helpers/Field.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace LavaCake;
+using namespace LavaCake::Helpers;
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the sum keeps the samples from being optimised away
+static double walk(const Field3DGrid<float>& field, const std::vector<vec3f>& points, float& sum) {
+  auto start = std::chrono::steady_clock::now();
+  for (const vec3f& p : points) {
+    sum += field.sampleLinear(p);
+  }
+  return double(points.size()) / elapsedSeconds(start) / 1.0e6;
+}
+
+int main(int argc, char** argv) {
+  uint32_t resolution = argc > 1 ? uint32_t(std::atoi(argv[1])) : 256;
+  uint32_t walkResolution = resolution / 2;
+
+  ABBox<3> domain(vec3f({ 0.0f, 0.0f, 0.0f }), vec3f({ 1.0f, 1.0f, 1.0f }));
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  std::vector<float> values(size_t(resolution) * resolution * resolution);
+  for (float& v : values) {
+    v = uniform(generator);
+  }
+
+  // the coherent walks sample the middle of the cells of a coarser grid, x or z varying fastest
+  std::vector<vec3f> alongX;
+  std::vector<vec3f> alongZ;
+  std::vector<vec3f> random;
+  float step = 1.0f / float(walkResolution);
+  for (uint32_t a = 0; a < walkResolution; a++) {
+    for (uint32_t b = 0; b < walkResolution; b++) {
+      for (uint32_t c = 0; c < walkResolution; c++) {
+        alongX.push_back(vec3f({ (float(c) + 0.5f) * step, (float(b) + 0.5f) * step, (float(a) + 0.5f) * step }));
+        alongZ.push_back(vec3f({ (float(a) + 0.5f) * step, (float(b) + 0.5f) * step, (float(c) + 0.5f) * step }));
+        random.push_back(vec3f({ uniform(generator), uniform(generator), uniform(generator) }));
+      }
+    }
+  }
+
+  float sum = 0.0f;
+  const char* names[2] = { "ROW_MAJOR", "BRICK" };
+  for (fieldLayout layout : { ROW_MAJOR, BRICK }) {
+    Field3DGrid<float> field(values, resolution, resolution, resolution, domain, nullptr, layout);
+    double x = walk(field, alongX, sum);
+    double z = walk(field, alongZ, sum);
+    double r = walk(field, random, sum);
+    std::cout << names[layout] << " " << resolution << "^3 : " << x << " Msamples/s along x, " << z << " Msamples/s along z, "
+              << r << " Msamples/s random" << std::endl;
+  }
+  std::cout << "checksum " << sum << std::endl;
+  return 0;
+}
@@ -0,0 +1,68 @@
+// CPU and GPU frame time of a headless FrameContext, with one frame in flight and with several.
+// Every frame updates its own uniform buffer and copies a 64 MB buffer on the GPU, so the GPU time dominates and
+// the CPU only overlaps it when frames are in flight.
+
+#include "Framework/Framework.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace LavaCake;
+using namespace LavaCake::Framework;
+
+int main(int argc, char** argv) {
+  uint32_t nbFrames = argc > 1 ? uint32_t(std::atoi(argv[1])) : 200;
+  VkDeviceSize copySize = 64 * 1024 * 1024;
+
+  Device* d = Device::getDevice();
+  d->initDevices(0, 1);
+  if (ErrorCheck::getError()[0] != '\0') {
+    std::cout << "No Vulkan device, " << ErrorCheck::getError() << std::endl;
+    return 0;
+  }
+  GraphicQueue* queue = d->getGraphicQueue(0);
+
+  {
+    Buffer source;
+    source.allocate(copySize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    Buffer destination;
+    destination.allocate(copySize, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    VkBufferCopy region = { 0, 0, copySize };
+
+    for (uint32_t framesInFlight : { 1u, 2u, 3u }) {
+      FrameContext context(framesInFlight, true);
+      PerFrame<UniformBuffer> uniforms(context);
+      uniforms.forEach([](UniformBuffer& uniform) {
+        uniform.addVariable("time", 0.0f);
+        uniform.end();
+      });
+
+      auto start = std::chrono::high_resolution_clock::now();
+      float cpuTime = 0.0f;
+      float gpuTime = 0.0f;
+      uint32_t gpuFrames = 0;
+      for (uint32_t f = 0; f < nbFrames; f++) {
+        context.beginFrame();
+        CommandBuffer& cmdBuff = context.getCommandBuffer();
+        uniforms.current().setVariable("time", float(f));
+        uniforms.current().update(cmdBuff);
+        LavaCake::vkCmdCopyBuffer(cmdBuff.getHandle(), source.getHandle(), destination.getHandle(), 1, &region);
+        context.endFrame(queue);
+        cpuTime += context.getCPUFrameTime();
+        // the GPU time is the one of the last completed frame, there is none during the first frames
+        if (f >= framesInFlight) {
+          gpuTime += context.getGPUFrameTime();
+          gpuFrames++;
+        }
+      }
+      context.waitIdle();
+      float wallTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+      std::cout << framesInFlight << " frame(s) in flight : CPU " << cpuTime / float(nbFrames) << " ms/frame, GPU "
+                << (gpuFrames > 0 ? gpuTime / float(gpuFrames) : 0.0f) << " ms/frame, wall " << wallTime / float(nbFrames) << " ms/frame" << std::endl;
+    }
+  }
+  d->end();
+  return 0;
+}
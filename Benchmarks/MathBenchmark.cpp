@@ -0,0 +1,75 @@
+// Throughput of the mat4 operations of Math/basics, built twice : MathBenchmark uses the path selected for the library,
+// MathBenchmarkScalar compiles basics.cpp with MATH_SCALAR, so running both compares the SIMD and scalar paths.
+// The TLAS workload composes the matrix of every instance and writes it as a VkTransformMatrixKHR, as TopLevelAS::addInstance does.
+
+#include "Math/basics.h"
+#include "Math/simd.h"
+#include "vulkan_core.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace LavaCake;
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static mat4 instanceMatrix(size_t i) {
+  float angle = 0.001f * float(i);
+  mat4 rotation = { std::cos(angle), std::sin(angle), 0.0f, 0.0f,
+                    -std::sin(angle), std::cos(angle), 0.0f, 0.0f,
+                    0.0f, 0.0f, 1.0f, 0.0f,
+                    float(i % 100), float(i / 100 % 100), float(i / 10000), 1.0f };
+  return rotation;
+}
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? size_t(std::atoi(argv[1])) : 1000000;
+#if defined(MATH_SSE)
+  const char* path = "SSE";
+#elif defined(MATH_NEON)
+  const char* path = "NEON";
+#else
+  const char* path = "scalar";
+#endif
+
+  std::vector<mat4> matrices(count);
+  for (size_t i = 0; i < count; i++) {
+    matrices[i] = instanceMatrix(i);
+  }
+  mat4 parent = instanceMatrix(12345);
+  // the sum keeps the results from being optimised away
+  float sum = 0.0f;
+
+  auto start = std::chrono::steady_clock::now();
+  for (const mat4& m : matrices) {
+    sum += (parent * m)[13];
+  }
+  double multiply = elapsedSeconds(start);
+
+  start = std::chrono::steady_clock::now();
+  for (const mat4& m : matrices) {
+    sum += inverse(m)[13];
+  }
+  double invert = elapsedSeconds(start);
+
+  std::vector<VkTransformMatrixKHR> instances(count);
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; i++) {
+    std::array<float, 12> rows = affineRows(parent * matrices[i]);
+    std::memcpy(instances[i].matrix, rows.data(), sizeof(instances[i].matrix));
+  }
+  double tlas = elapsedSeconds(start);
+  sum += instances[count / 2].matrix[1][3];
+
+  double millions = double(count) / 1.0e6;
+  std::cout << path << " : " << millions / multiply << " M mat4 products/s, " << millions / invert << " M mat4 inverses/s, "
+            << millions / tlas << " M TLAS instance transforms/s" << std::endl;
+  std::cout << "checksum " << sum << std::endl;
+  return 0;
+}
@@ -0,0 +1,84 @@
+// Throughput of the parallel OBJ parser and of Load3DModelFromObjFile, compared with tinyobj, the loader they replace.
+// The OBJ file is given as the first argument, a generated grid of quads is written and loaded otherwise.
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+#include "Geometry/meshLoader.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace LavaCake;
+using namespace LavaCake::Geometry;
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// a bumpy grid of n x n quads with normals and uvs, cut in triangles
+static bool writeGrid(const std::string& path, uint32_t n) {
+  std::ofstream file(path, std::ios::trunc);
+  for (uint32_t j = 0; j <= n; j++) {
+    for (uint32_t i = 0; i <= n; i++) {
+      float x = float(i) / float(n);
+      float y = float(j) / float(n);
+      file << "v " << x << " " << y << " " << 0.01f * float((i * 7 + j * 13) % 5) << "\n";
+      file << "vn 0 0 1\n";
+      file << "vt " << x << " " << y << "\n";
+    }
+  }
+  for (uint32_t j = 0; j < n; j++) {
+    for (uint32_t i = 0; i < n; i++) {
+      uint32_t v = j * (n + 1) + i + 1;
+      uint32_t corners[4] = { v, v + 1, v + n + 2, v + n + 1 };
+      file << "f";
+      for (uint32_t c : { 0, 1, 2 }) {
+        file << " " << corners[c] << "/" << corners[c] << "/" << corners[c];
+      }
+      file << "\nf";
+      for (uint32_t c : { 0, 2, 3 }) {
+        file << " " << corners[c] << "/" << corners[c] << "/" << corners[c];
+      }
+      file << "\n";
+    }
+  }
+  return bool(file);
+}
+
+int main(int argc, char** argv) {
+  std::string path = argc > 1 ? argv[1] : "ObjLoaderBenchmark.obj";
+  if (argc <= 1 && !writeGrid(path, 500)) {
+    std::cout << "Could not write " << path << std::endl;
+    return 1;
+  }
+  std::ifstream source(path, std::ios::binary | std::ios::ate);
+  double megabytes = double(source.tellg()) / 1.0e6;
+  if (!source || megabytes <= 0.0) {
+    std::cout << "Could not read " << path << std::endl;
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  tinyobj::attrib_t attributes;
+  std::vector<tinyobj::shape_t> shapes;
+  std::vector<tinyobj::material_t> materials;
+  std::string error;
+  tinyobj::LoadObj(&attributes, &shapes, &materials, &error, path.c_str());
+  double tinyobjTime = elapsedSeconds(start);
+
+  start = std::chrono::steady_clock::now();
+  ObjData data;
+  bool parsed = ParseObjFile(path, data);
+  double parseTime = elapsedSeconds(start);
+
+  start = std::chrono::steady_clock::now();
+  std::pair<std::vector<float>, vertexFormat> mesh = Load3DModelFromObjFile(path, true, true, false, false);
+  double loadTime = elapsedSeconds(start);
+
+  std::cout << path << " : " << megabytes << " MB, " << data.corners.size() << " corners" << std::endl;
+  std::cout << "tinyobj::LoadObj : " << megabytes / tinyobjTime << " MB/s" << std::endl;
+  std::cout << "ParseObjFile : " << megabytes / parseTime << " MB/s" << (parsed ? "" : " (failed)") << std::endl;
+  std::cout << "Load3DModelFromObjFile : " << megabytes / loadTime << " MB/s, " << mesh.first.size() / mesh.second.size() << " vertices" << std::endl;
+  return 0;
+}
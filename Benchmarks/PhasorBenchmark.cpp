@@ -0,0 +1,89 @@
+// Samples per second of the CPU backend of Phasor2D, compared with the compute shaders when a Vulkan device is available.
+// On the GPU, the optimisation iterations per second of a 512x512 cell grid are measured with one submit per iteration and batched in a single command buffer.
+// Run it from the build directory so that the shaders compiled in LavacakeShaders are found.
+
+#include "Framework/Framework.h"
+#include "Phasor/Phasor2D.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace LavaCake;
+using namespace LavaCake::Framework;
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+  uint32_t resolution = argc > 1 ? uint32_t(std::atoi(argv[1])) : 1024;
+  uint32_t nbOptimisation = 5;
+
+  Helpers::ABBox<2> domain(vec2f({ 0.0f, 0.0f }), vec2f({ 100.0f, 100.0f }));
+  std::vector<float> frequencies(16 * 16, 0.5f);
+  std::vector<vec2f> directions(16 * 16, vec2f({ 1.0f, 0.0f }));
+  Helpers::Field2DGrid<float> F(frequencies, 16, 16, domain);
+  Helpers::Field2DGrid<vec2f> D(directions, 16, 16, domain);
+  vec2u sampleResolution = vec2u({ resolution, resolution });
+  double samples = double(resolution) * double(resolution);
+
+  Phasor::Phasor2D cpuPhasor(domain, &F, 0.5f, &D);
+  auto start = std::chrono::steady_clock::now();
+  cpuPhasor.phaseOptimisation(nbOptimisation);
+  double cpuOptimisation = elapsedSeconds(start);
+  start = std::chrono::steady_clock::now();
+  std::vector<float> cpuSamples = cpuPhasor.sample(domain, sampleResolution);
+  double cpuSampling = elapsedSeconds(start);
+  std::cout << "CPU : " << nbOptimisation << " optimisation steps in " << cpuOptimisation * 1000.0 << " ms, "
+            << samples / cpuSampling / 1.0e6 << " Msamples/s" << std::endl;
+
+  Device* d = Device::getDevice();
+  d->initDevices(1, 0);
+  if (ErrorCheck::getError()[0] != '\0') {
+    std::cout << "GPU : no Vulkan device, " << ErrorCheck::getError() << std::endl;
+    return 0;
+  }
+  ComputeQueue* queue = d->getComputeQueue(0);
+  {
+    CommandBuffer cmdBuff;
+    Phasor::Phasor2D gpuPhasor(domain, &F, 0.5f, &D);
+    gpuPhasor.init(queue, cmdBuff);
+    start = std::chrono::steady_clock::now();
+    gpuPhasor.phaseOptimisation(queue, cmdBuff, nbOptimisation);
+    double gpuOptimisation = elapsedSeconds(start);
+
+    // the first sampling creates the pipeline and the sample buffer, the second one is timed
+    gpuPhasor.sample(queue, cmdBuff, domain, sampleResolution);
+    start = std::chrono::steady_clock::now();
+    gpuPhasor.sample(queue, cmdBuff, domain, sampleResolution);
+    double gpuSampling = elapsedSeconds(start);
+    std::cout << "GPU : " << nbOptimisation << " optimisation steps in " << gpuOptimisation * 1000.0 << " ms, "
+              << samples / gpuSampling / 1.0e6 << " Msamples/s" << std::endl;
+    std::cout << "CPU / GPU sampling throughput : " << gpuSampling / cpuSampling << std::endl;
+  }
+
+  {
+    // Fmin cells per unit and two cells of margin on each side : 508 / 0.5 units give 512 cells
+    Helpers::ABBox<2> gridDomain(vec2f({ 0.0f, 0.0f }), vec2f({ 1016.0f, 1016.0f }));
+    uint32_t nbIterations = 100;
+    CommandBuffer cmdBuff;
+    Phasor::Phasor2D gpuPhasor(gridDomain, &F, 0.5f, &D);
+    gpuPhasor.init(queue, cmdBuff);
+    // uploads the uniform buffer, so that both measures only dispatch
+    gpuPhasor.phaseOptimisation(queue, cmdBuff, 1);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < nbIterations; i++) {
+      gpuPhasor.phaseOptimisation(queue, cmdBuff, 1);
+    }
+    double perSubmit = elapsedSeconds(start);
+    start = std::chrono::steady_clock::now();
+    gpuPhasor.phaseOptimisation(queue, cmdBuff, nbIterations);
+    double batched = elapsedSeconds(start);
+    std::cout << "GPU 512x512 cells : " << nbIterations / perSubmit << " iterations/s with one submit per iteration, "
+              << nbIterations / batched << " iterations/s batched in one command buffer" << std::endl;
+  }
+  d->end();
+  return 0;
+}
@@ -121,6 +121,7 @@ DEVICE_LEVEL_VULKAN_FUNCTION( vkBindImageMemory )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkCreateImageView )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkMapMemory )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkFlushMappedMemoryRanges )
+DEVICE_LEVEL_VULKAN_FUNCTION( vkInvalidateMappedMemoryRanges )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkUnmapMemory )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkCmdCopyBuffer )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkCmdCopyBufferToImage )
@@ -137,6 +138,7 @@ DEVICE_LEVEL_VULKAN_FUNCTION( vkAllocateCommandBuffers )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkCreateSemaphore )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkCreateFence )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkWaitForFences )
+DEVICE_LEVEL_VULKAN_FUNCTION( vkGetFenceStatus )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkResetFences )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkDestroyFence )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkDestroySemaphore )
@@ -173,7 +175,11 @@ DEVICE_LEVEL_VULKAN_FUNCTION( vkCreateGraphicsPipelines )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkCreateComputePipelines )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkDestroyPipeline )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkDestroyEvent )
+DEVICE_LEVEL_VULKAN_FUNCTION( vkCreateQueryPool )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkDestroyQueryPool )
+DEVICE_LEVEL_VULKAN_FUNCTION( vkGetQueryPoolResults )
+DEVICE_LEVEL_VULKAN_FUNCTION( vkCmdResetQueryPool )
+DEVICE_LEVEL_VULKAN_FUNCTION( vkCmdWriteTimestamp )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkCreateShaderModule )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkDestroyShaderModule )
 DEVICE_LEVEL_VULKAN_FUNCTION( vkCreatePipelineLayout )
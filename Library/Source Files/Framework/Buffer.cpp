@@ -1,4 +1,6 @@
 #include "Buffer.h"
+#include "StagingRing.h"
+#include "ReadbackPool.h"
 
 namespace LavaCake{
 	namespace Framework {
@@ -8,28 +10,14 @@ namespace LavaCake{
 
 		}
 
-		Buffer::Buffer(const Buffer& a) {
-			*m_buffer = *(a.m_buffer);
-			*m_bufferMemory = *(a.m_bufferMemory);
-			*m_bufferView = *(a.m_bufferView);
-
-			m_dataSize = a.m_dataSize;
-		}
-
 		void Buffer::allocate(uint64_t byteSize, VkBufferUsageFlags usage, VkMemoryPropertyFlagBits memPropertyFlag , VkPipelineStageFlagBits stageFlagBit , VkFormat format ) {
 			Device* d = Device::getDevice();
-			VkPhysicalDevice physical = d->getPhysicalDevice();
 			VkDevice logical = d->getLogicalDevice();
 			m_dataSize = byteSize;
 
 			m_stage = stageFlagBit;
 			m_access = VkAccessFlagBits(0);
 
-			uint32_t memProp = 0;
-			if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
-				memProp = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
-			}
-
 			if (VK_NULL_HANDLE != *m_buffer) {
 				vkDestroyBuffer(logical, *m_buffer, nullptr);
 				*m_buffer = VK_NULL_HANDLE;
@@ -40,10 +28,7 @@ namespace LavaCake{
 				*m_bufferView = VK_NULL_HANDLE;
 			}
 
-			if (VK_NULL_HANDLE != *m_bufferMemory) {
-				vkFreeMemory(logical, *m_bufferMemory, nullptr);
-				*m_bufferMemory = VK_NULL_HANDLE;
-			}
+			MemoryAllocator::getAllocator()->free(m_allocation);
 
 
 			VkBufferCreateInfo buffer_create_info = {
@@ -64,46 +49,10 @@ namespace LavaCake{
 			}
 
 
-			VkPhysicalDeviceMemoryProperties physical_device_memory_properties;
-			vkGetPhysicalDeviceMemoryProperties(physical, &physical_device_memory_properties);
-
-			VkMemoryRequirements memory_requirements;
-			vkGetBufferMemoryRequirements(logical, *m_buffer, &memory_requirements);
-
-			*m_bufferMemory = VK_NULL_HANDLE;
-			for (uint32_t type = 0; type < physical_device_memory_properties.memoryTypeCount; ++type) {
-				if ((memory_requirements.memoryTypeBits & (1 << type)) &&
-					((physical_device_memory_properties.memoryTypes[type].propertyFlags & memPropertyFlag) == memPropertyFlag)) {
-
-					VkMemoryAllocateFlagsInfo next{
-					VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
-					nullptr,
-					memProp,
-					};
-
-					VkMemoryAllocateInfo buffer_memory_allocate_info = {
-						VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,   // VkStructureType    sType
-						&next,                                  // const void       * pNext
-						memory_requirements.size,                 // VkDeviceSize       allocationSize
-						type                          // uint32_t           memoryTypeIndex
-					};
-
-					result = vkAllocateMemory(logical, &buffer_memory_allocate_info, nullptr, &*m_bufferMemory);
-					if (VK_SUCCESS == result) {
-						break;
-					}
-				}
-			}
-
-			if (VK_NULL_HANDLE == *m_bufferMemory) {
+			if (!MemoryAllocator::getAllocator()->allocateForBuffer(*m_buffer, memPropertyFlag, (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) != 0, m_allocation)) {
 				ErrorCheck::setError((char*)"Could not allocate memory for a buffer.");
 			}
 
-			result = vkBindBufferMemory(logical, *m_buffer, *m_bufferMemory, 0);
-			if (VK_SUCCESS != result) {
-				ErrorCheck::setError((char*)"Could not bind memory object to a buffer.");
-			}
-
 			if (usage & VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT) {
 				VkBufferViewCreateInfo buffer_view_create_info = {
 				VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,    // VkStructureType            sType
@@ -123,6 +72,25 @@ namespace LavaCake{
 
 		}
 
+		void Buffer::allocate(StagingRing& ring, const void* data, uint64_t byteSize, VkBufferUsageFlags usage, VkMemoryPropertyFlagBits memPropertyFlag, VkPipelineStageFlagBits stageFlagBit, VkFormat format, VkAccessFlagBits accessmod) {
+			allocate(byteSize, usage, memPropertyFlag, stageFlagBit, format);
+
+			m_access = accessmod;
+			m_queueFamily = ring.getQueue()->getIndex();
+
+			// reserve first : it may submit the batch currently recorded
+			StagingRange range = ring.reserve(m_dataSize);
+			std::memcpy(range.data, data, static_cast<size_t>(m_dataSize));
+
+			CommandBuffer& cmdBuff = ring.getCommandBuffer();
+
+			setAccess(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_QUEUE_FAMILY_IGNORED);
+
+			range.buffer->copyToBuffer(cmdBuff, *this, { { range.offset, 0, m_dataSize } });
+
+			setAccess(cmdBuff, stageFlagBit, accessmod, VK_QUEUE_FAMILY_IGNORED);
+		}
+
 		void Buffer::setAccess(CommandBuffer& cmdBuff, VkPipelineStageFlags dstStage, VkAccessFlagBits dstAccessMode, uint32_t dstQueueFamily ) {
 
 			VkBufferMemoryBarrier bufferMemoryBarrier{};
@@ -175,26 +143,50 @@ namespace LavaCake{
 		}
 
 		VkDeviceMemory& Buffer::getMemory() {
-			return *m_bufferMemory;
+			return m_allocation.memory;
 		}
 
-		void* Buffer::map() {
-			Device* d = Device::getDevice();
-			VkDevice logical = d->getLogicalDevice();
-			VkResult result = vkMapMemory(logical, *m_bufferMemory, 0, m_dataSize, 0, &m_mapped);
+		VkDeviceSize Buffer::getMemoryOffset() {
+			return m_allocation.offset;
+		}
 
-			if (VK_SUCCESS != result) {
-				//std::cout << "Could not map memory object." << std::endl;
-				//return false;
+		void* Buffer::map() {
+			// host visible memory stays mapped by the allocator for its whole lifetime
+			m_mapped = m_allocation.mapped;
+			if (m_mapped == nullptr) {
+				ErrorCheck::setError((char*)"Could not map a buffer that is not host visible.");
 			}
-
 			return m_mapped;
 		}
 
 		void Buffer::unmap() {
+			m_mapped = nullptr;
+		}
+
+		Readback* Buffer::readBack(ReadbackPool& pool) {
+			return pool.readBack(*this);
+		}
+
+		void Buffer::invalidate() {
 			Device* d = Device::getDevice();
 			VkDevice logical = d->getLogicalDevice();
-			vkUnmapMemory(logical, *m_bufferMemory);
+
+			VkMappedMemoryRange memory_range = {
+				VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,  // VkStructureType    sType
+				nullptr,                                // const void       * pNext
+				m_allocation.memory,                    // VkDeviceMemory     memory
+				m_allocation.offset,										// VkDeviceSize       offset
+				m_allocation.size                       // VkDeviceSize       size
+			};
+
+			VkResult result = vkInvalidateMappedMemoryRanges(logical, 1, &memory_range);
+			if (VK_SUCCESS != result) {
+				ErrorCheck::setError((char*)"Could not invalidate mapped memory.");
+			}
+		}
+
+		uint64_t Buffer::getSize() {
+			return m_dataSize;
 		}
 
 #ifdef RAYTRACING
@@ -3,11 +3,15 @@
 #include "CommandBuffer.h"
 #include "Queue.h"
 #include "Image.h"
+#include "MemoryAllocator.h"
 
 namespace LavaCake {
   namespace Framework {
     
 		class Image;
+		class StagingRing;
+		class ReadbackPool;
+		class Readback;
   
   /**
       Class Buffer :
@@ -22,10 +26,9 @@ namespace LavaCake {
 			Buffer();
 
       /**
-       \brief Copy constructor
-        \param buffer : the buffer to be copied
+       \brief A Buffer owns its memory, copying it would free the same memory twice
        */
-			Buffer(const Buffer& buffer);
+			Buffer(const Buffer& buffer) = delete;
       
       
       /**
@@ -41,111 +44,11 @@ namespace LavaCake {
        */
 			template <typename t>
 			void allocate(Queue* queue, CommandBuffer& cmdBuff, std::vector<t>& rawdata, VkBufferUsageFlags usage, VkMemoryPropertyFlagBits memPropertyFlag = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VkPipelineStageFlagBits stageFlagBit = VK_PIPELINE_STAGE_TRANSFER_BIT, VkFormat format = VK_FORMAT_R32_SFLOAT, VkAccessFlagBits accessmod = VK_ACCESS_TRANSFER_WRITE_BIT) {
-				Device* d = Device::getDevice();
-				VkPhysicalDevice physical = d->getPhysicalDevice();
-				VkDevice logical = d->getLogicalDevice();
-				m_dataSize = uint64_t(rawdata.size() * sizeof(t));
+				allocate(uint64_t(rawdata.size() * sizeof(t)), usage, memPropertyFlag, stageFlagBit, format);
 
-				m_stage = stageFlagBit;
 				m_access = accessmod;
 				m_queueFamily = queue->getIndex();
 
-				uint32_t memProp = 0;
-				if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
-					memProp = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
-				}
-
-				if (VK_NULL_HANDLE != *m_buffer) {
-					vkDestroyBuffer(logical, *m_buffer, nullptr);
-					*m_buffer = VK_NULL_HANDLE;
-				}
-
-				if (VK_NULL_HANDLE != *m_bufferView) {
-					vkDestroyBufferView(logical, *m_bufferView, nullptr);
-					*m_bufferView = VK_NULL_HANDLE;
-				}
-
-				if (VK_NULL_HANDLE != *m_bufferMemory) {
-					vkFreeMemory(logical, *m_bufferMemory, nullptr);
-					*m_bufferMemory = VK_NULL_HANDLE;
-				}
-
-
-				VkBufferCreateInfo buffer_create_info = {
-				VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,   // VkStructureType        sType
-				nullptr,                                // const void           * pNext
-				0,                                      // VkBufferCreateFlags    flags
-				m_dataSize,                             // VkDeviceSize           size
-				VK_BUFFER_USAGE_TRANSFER_DST_BIT| usage,// VkBufferUsageFlags     usage
-				VK_SHARING_MODE_EXCLUSIVE,              // VkSharingMode          sharingMode
-				0,                                      // uint32_t               queueFamilyIndexCount
-				nullptr                                 // const uint32_t       * pQueueFamilyIndices
-				};
-
-				VkResult result = vkCreateBuffer(logical, &buffer_create_info, nullptr, &*m_buffer);
-
-				if (result != VK_SUCCESS) {
-					ErrorCheck::setError((char*)"Can't create Buffer");
-				}
-
-
-				VkPhysicalDeviceMemoryProperties physical_device_memory_properties;
-				vkGetPhysicalDeviceMemoryProperties(physical, &physical_device_memory_properties);
-
-				VkMemoryRequirements memory_requirements;
-				vkGetBufferMemoryRequirements(logical, *m_buffer, &memory_requirements);
-
-				*m_bufferMemory = VK_NULL_HANDLE;
-				for (uint32_t type = 0; type < physical_device_memory_properties.memoryTypeCount; ++type) {
-					if ((memory_requirements.memoryTypeBits & (1 << type)) &&
-						((physical_device_memory_properties.memoryTypes[type].propertyFlags & memPropertyFlag) == memPropertyFlag)) {
-
-						VkMemoryAllocateFlagsInfo next{
-						VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
-						nullptr,
-						memProp,
-						};
-
-						VkMemoryAllocateInfo buffer_memory_allocate_info = {
-							VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,   // VkStructureType    sType
-							&next,                                  // const void       * pNext
-							memory_requirements.size,                 // VkDeviceSize       allocationSize
-							type                          // uint32_t           memoryTypeIndex
-						};
-
-						result = vkAllocateMemory(logical, &buffer_memory_allocate_info, nullptr, &*m_bufferMemory);
-						if (VK_SUCCESS == result) {
-							break;
-						}
-					}
-				}
-
-				if (VK_NULL_HANDLE == *m_bufferMemory) {
-					ErrorCheck::setError((char*)"Could not allocate memory for a buffer.");
-				}
-
-				result = vkBindBufferMemory(logical, *m_buffer, *m_bufferMemory, 0);
-				if (VK_SUCCESS != result) {
-					ErrorCheck::setError((char*)"Could not bind memory object to a buffer.");
-				}
-
-				if (usage & VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT) {
-					VkBufferViewCreateInfo buffer_view_create_info = {
-					VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,    // VkStructureType            sType
-					nullptr,                                      // const void               * pNext
-					0,                                            // VkBufferViewCreateFlags    flags
-					*m_buffer,                                    // VkBuffer                   buffer
-					format,                                       // VkFormat                   format
-					0,																						// VkDeviceSize               offset
-					VK_WHOLE_SIZE                                 // VkDeviceSize               range
-					};
-
-					result = vkCreateBufferView(logical, &buffer_view_create_info, nullptr, &*m_bufferView);
-					if (VK_SUCCESS != result) {
-						ErrorCheck::setError((char*)"Could not creat buffer view.");
-					}
-				}
-
 				Buffer stagingBuffer;
 
 				stagingBuffer.allocate(m_dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
@@ -179,6 +82,35 @@ namespace LavaCake {
 
       
       
+      /**
+       \brief Allocate the Buffer and record the upload of a list of data in a StagingRing
+       The data is copied to the ring right away but the Buffer content is only valid once the batch returned by ring.submit() is completed
+        \param ring : the staging ring used to upload the data
+        \param rawdata : a vector of data to be pushed to the buffer
+        \param usage : the usage of the buffer see more <a href="https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkBufferUsageFlags.html">here</a>
+        \param memPropertyFlag : the memory property of the buffer, see more <a href="https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkMemoryPropertyFlagBits.html">here</a>
+        \param stageFlagBit : the stage where the buffer will be used, see more <a href="https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkPipelineStageFlagBits.html">here</a>
+        \param format : the format of the buffer  see more <a href="https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkFormat.html">here</a>
+        \param accessmod : the access mode of the buffer <a href="https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkAccessFlagBits.html">here</a>
+       */
+			template <typename t>
+			void allocate(StagingRing& ring, std::vector<t>& rawdata, VkBufferUsageFlags usage, VkMemoryPropertyFlagBits memPropertyFlag = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VkPipelineStageFlagBits stageFlagBit = VK_PIPELINE_STAGE_TRANSFER_BIT, VkFormat format = VK_FORMAT_R32_SFLOAT, VkAccessFlagBits accessmod = VK_ACCESS_TRANSFER_WRITE_BIT) {
+				allocate(ring, rawdata.data(), uint64_t(rawdata.size() * sizeof(t)), usage, memPropertyFlag, stageFlagBit, format, accessmod);
+			}
+
+      /**
+       \brief Allocate the Buffer and record the upload of raw data in a StagingRing
+        \param ring : the staging ring used to upload the data
+        \param data : a pointer to the data to be pushed to the buffer
+        \param byteSize : the size in byte of the data
+        \param usage : the usage of the buffer
+        \param memPropertyFlag : the memory property of the buffer
+        \param stageFlagBit : the stage where the buffer will be used
+        \param format : the format of the buffer
+        \param accessmod : the access mode of the buffer
+       */
+			void allocate(StagingRing& ring, const void* data, uint64_t byteSize, VkBufferUsageFlags usage, VkMemoryPropertyFlagBits memPropertyFlag = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VkPipelineStageFlagBits stageFlagBit = VK_PIPELINE_STAGE_TRANSFER_BIT, VkFormat format = VK_FORMAT_R32_SFLOAT, VkAccessFlagBits accessmod = VK_ACCESS_TRANSFER_WRITE_BIT);
+
       /**
        \brief Allocate a Buffer of a given size
         \param byteSize : the size in byte of the buffer
@@ -216,6 +148,12 @@ namespace LavaCake {
        \return a VkDeviceMemory : the memory of the buffer on the GPU
        */
       VkDeviceMemory& getMemory();
+
+      /**
+       \brief Return the offset of the buffer inside its memory
+       \return a VkDeviceSize : the offset of the buffer in the VkDeviceMemory returned by getMemory
+       */
+      VkDeviceSize getMemoryOffset();
       
       /**
        \brief Copy a region(s) of the buffer to an image
@@ -281,6 +219,7 @@ namespace LavaCake {
 
         cmdBuff.wait(UINT32_MAX);
         cmdBuff.resetFence();
+        stagingBuffer.invalidate();
         void* local_pointer = stagingBuffer.map();
 
         std::memcpy(&data[0], local_pointer, static_cast<size_t>(m_dataSize));
@@ -288,6 +227,24 @@ namespace LavaCake {
         stagingBuffer.unmap();
       }
 
+      /**
+       \brief Start an asynchronous read back of the buffer, the function returns as soon as the copy is submitted
+       \param pool : the pool providing the staging memory and the queue
+       \return a handle to the copy, to be released with pool.release once the data has been consumed
+       */
+			Readback* readBack(ReadbackPool& pool);
+
+      /**
+       \brief Make the device writes visible to the host, for buffers allocated in host visible but not host coherent memory
+       */
+			void invalidate();
+
+      /**
+       \brief Return the size of the buffer
+       \return the size in byte
+       */
+			uint64_t getSize();
+
       /**
        \brief Get the Buffer device address,
        \return the address of the buffer on the device
@@ -311,9 +268,9 @@ namespace LavaCake {
 					{
 						VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,  // VkStructureType    sType
 						nullptr,                                // const void       * pNext
-						*m_bufferMemory,                       // VkDeviceMemory     memory
-						0,																			// VkDeviceSize       offset
-						VK_WHOLE_SIZE                           // VkDeviceSize       size
+						m_allocation.memory,                    // VkDeviceMemory     memory
+						m_allocation.offset,										// VkDeviceSize       offset
+						m_allocation.size                       // VkDeviceSize       size
 					}
 				};
 
@@ -338,10 +295,7 @@ namespace LavaCake {
 					*m_bufferView = VK_NULL_HANDLE;
 				}
 
-				if (VK_NULL_HANDLE != *m_bufferMemory) {
-					vkFreeMemory(logical, *m_bufferMemory, nullptr);
-					*m_bufferMemory = VK_NULL_HANDLE;
-				}
+				MemoryAllocator::getAllocator()->free(m_allocation);
 			}
 
       VkPipelineStageFlags getStage(){return m_stage;}
@@ -350,7 +304,7 @@ namespace LavaCake {
     protected:
 
       VkDestroyer(VkBuffer)																m_buffer;
-      VkDestroyer(VkDeviceMemory)													m_bufferMemory;
+      MemoryAllocation																		m_allocation;
       VkDestroyer(VkBufferView)														m_bufferView;
 
 
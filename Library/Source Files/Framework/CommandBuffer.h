@@ -18,18 +18,22 @@ namespace LavaCake {
       /**
        Constructor the CommandBuffer class
        \brief Initialise a VkCommandBuffer and a VkFence for it's synchronisation
+       The command buffer is allocated from the command pool of the calling thread, it must only be recorded by this thread
+       \param level (optional) primary or secondary command buffer
+       \param queue (optional) the queue the command buffer will be submitted to, if null the queue family of the device command pool is used
        */
-      CommandBuffer() {
+      CommandBuffer(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY, Queue* queue = nullptr) {
         Device* d = Device::getDevice();
         VkDevice logical = d->getLogicalDevice();
-        VkCommandPool pool = d->getCommandPool();
+        m_pool = queue == nullptr ? d->getCommandPool() : d->getCommandPool(queue->getIndex());
+        m_level = level;
         std::vector<VkCommandBuffer> buffers = { m_commandBuffer };
 
         VkCommandBufferAllocateInfo command_buffer_allocate_info = {
         VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,   // VkStructureType          sType
         nullptr,                                          // const void             * pNext
-        pool,                                     // VkCommandPool            commandPool
-        VK_COMMAND_BUFFER_LEVEL_PRIMARY,                                            // VkCommandBufferLevel     level
+        m_pool,                                           // VkCommandPool            commandPool
+        level,                                            // VkCommandBufferLevel     level
         1                                             // uint32_t                 commandBufferCount
         };
 
@@ -125,6 +129,64 @@ namespace LavaCake {
         }
       }
       
+      /**
+       \brief Put a secondary command buffer in a recording state
+       \param renderPass (optional) the render pass the commands will be executed in, VK_NULL_HANDLE if executed outside of a render pass
+       \param subpass (optional) the index of the subpass the commands will be executed in
+       \param frameBuffer (optional) the frame buffer the commands will render to if known
+       */
+      void beginSecondaryRecord(VkRenderPass renderPass = VK_NULL_HANDLE, uint32_t subpass = 0, VkFramebuffer frameBuffer = VK_NULL_HANDLE) {
+        VkCommandBufferInheritanceInfo command_buffer_inheritance_info = {
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO, // VkStructureType                  sType
+        nullptr,                                          // const void                     * pNext
+        renderPass,                                       // VkRenderPass                     renderPass
+        subpass,                                          // uint32_t                         subpass
+        frameBuffer,                                      // VkFramebuffer                    framebuffer
+        VK_FALSE,                                         // VkBool32                         occlusionQueryEnable
+        0,                                                // VkQueryControlFlags              queryFlags
+        0                                                 // VkQueryPipelineStatisticFlags    pipelineStatistics
+        };
+
+        VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (renderPass != VK_NULL_HANDLE) {
+          usage |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        }
+
+        VkCommandBufferBeginInfo command_buffer_begin_info = {
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,    // VkStructureType                        sType
+        nullptr,                                        // const void                           * pNext
+        usage,                                          // VkCommandBufferUsageFlags              flags
+        &command_buffer_inheritance_info                // const VkCommandBufferInheritanceInfo * pInheritanceInfo
+        };
+
+        VkResult result = vkBeginCommandBuffer(m_commandBuffer, &command_buffer_begin_info);
+        if (VK_SUCCESS != result) {
+          ErrorCheck::setError((char*)"Could not begin secondary command buffer recording operation.");
+        }
+      }
+
+      /**
+       \brief Record the execution of secondary command buffers, in order
+       \param secondaries : the secondary command buffers to execute, they must not be in a recording state
+       */
+      void executeCommands(std::vector<CommandBuffer*> const & secondaries) {
+        std::vector<VkCommandBuffer> handles;
+        for (CommandBuffer* secondary : secondaries) {
+          handles.push_back(secondary->getHandle());
+        }
+        if (handles.size() > 0) {
+          vkCmdExecuteCommands(m_commandBuffer, static_cast<uint32_t>(handles.size()), handles.data());
+        }
+      }
+
+      /**
+       \brief Return the level of the command buffer
+       \return VK_COMMAND_BUFFER_LEVEL_PRIMARY or VK_COMMAND_BUFFER_LEVEL_SECONDARY
+       */
+      VkCommandBufferLevel getLevel() {
+        return m_level;
+      }
+
       /**
        \brief Put the command buffer out of recording state
        */
@@ -212,13 +274,14 @@ namespace LavaCake {
           vkDestroyFence(logical, *m_fence, nullptr);
         }
         if (m_commandBuffer != VK_NULL_HANDLE) {
-          std::vector<VkCommandBuffer> buffers = { m_commandBuffer };
-          vkFreeCommandBuffers(logical, d->getCommandPool(), 1, &buffers[0]);
+          d->freeCommandBuffers(m_pool, 1, &m_commandBuffer);
         }
       };
 
     private:
       VkCommandBuffer                           m_commandBuffer;
+      VkCommandPool                             m_pool;
+      VkCommandBufferLevel                      m_level;
       std::vector<VkDestroyer(VkSemaphore)>     m_semaphores;
       VkDestroyer(VkFence)                      m_fence;
         
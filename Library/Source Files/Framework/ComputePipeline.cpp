@@ -8,7 +8,7 @@ namespace LavaCake {
 			VkDevice logical = d->getLogicalDevice();
 			generateDescriptorLayout();
 			InitVkDestroyer(logical, m_pipelineLayout);
-			if (!CreatePipelineLayout(logical, { *m_descriptorSetLayout }, {}, *m_pipelineLayout)) {
+			if (!CreatePipelineLayout(logical, { m_descriptorSetLayout }, {}, *m_pipelineLayout)) {
 				ErrorCheck::setError((char*)"Can't create compute pipeline layout");
 			}
 
@@ -27,7 +27,9 @@ namespace LavaCake {
 				-1                                                // int32_t                            basePipelineIndex
 			};
 
-			VkResult result = vkCreateComputePipelines(logical, VK_NULL_HANDLE, 1, &compute_pipeline_create_info, nullptr, &*m_pipeline);
+			auto start = std::chrono::high_resolution_clock::now();
+			VkResult result = vkCreateComputePipelines(logical, d->getPipelineCache().getHandle(), 1, &compute_pipeline_create_info, nullptr, &*m_pipeline);
+			d->getPipelineCache().addCreationTime(1, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
 			if (VK_SUCCESS != result) {
 				ErrorCheck::setError((char*)"Can't create compute pipeline");
 			}
@@ -39,9 +41,11 @@ namespace LavaCake {
 
 		void ComputePipeline::compute(CommandBuffer& buffer, uint32_t dimX, uint32_t dimY, uint32_t dimZ) {
 
-			vkCmdBindDescriptorSets(buffer.getHandle(), VK_PIPELINE_BIND_POINT_COMPUTE, *m_pipelineLayout, 0,
-				static_cast<uint32_t>(m_descriptorSets.size()), m_descriptorSets.data(),
-				0, {});
+			if (m_descriptorSets.size() > 0) {
+				vkCmdBindDescriptorSets(buffer.getHandle(), VK_PIPELINE_BIND_POINT_COMPUTE, *m_pipelineLayout, 0,
+					1, &m_descriptorSets[m_currentDescriptorSet],
+					0, {});
+			}
 
 			vkCmdBindPipeline(buffer.getHandle(), VK_PIPELINE_BIND_POINT_COMPUTE, *m_pipeline);
 
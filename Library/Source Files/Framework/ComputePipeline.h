@@ -44,6 +44,15 @@ namespace LavaCake {
 			~ComputePipeline() {
 			
 			}
+		protected :
+
+			std::vector<ShaderModule*> getShaderModules() override {
+				if (m_computeModule == nullptr) {
+					return {};
+				}
+				return { m_computeModule };
+			};
+
 		private :
 			
 			ComputeShaderModule*																	m_computeModule = NULL;
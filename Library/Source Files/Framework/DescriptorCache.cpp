@@ -0,0 +1,206 @@
+#include "DescriptorCache.h"
+
+#include <algorithm>
+
+namespace LavaCake {
+  namespace Framework {
+		DescriptorLayoutCache* DescriptorLayoutCache::m_cache;
+		DescriptorAllocator* DescriptorAllocator::m_sharedAllocator;
+
+		bool DescriptorLayoutCache::LayoutKey::operator==(const LayoutKey& other) const {
+			if (bindings.size() != other.bindings.size()) {
+				return false;
+			}
+			for (size_t i = 0; i < bindings.size(); i++) {
+				const VkDescriptorSetLayoutBinding& a = bindings[i];
+				const VkDescriptorSetLayoutBinding& b = other.bindings[i];
+				if (a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount ||
+					a.stageFlags != b.stageFlags || a.pImmutableSamplers != b.pImmutableSamplers) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		size_t DescriptorLayoutCache::LayoutKeyHash::operator()(const LayoutKey& key) const {
+			size_t hash = key.bindings.size();
+			for (const VkDescriptorSetLayoutBinding& binding : key.bindings) {
+				for (size_t value : { size_t(binding.binding), size_t(binding.descriptorType), size_t(binding.descriptorCount), size_t(binding.stageFlags), size_t(binding.pImmutableSamplers) }) {
+					hash ^= std::hash<size_t>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				}
+			}
+			return hash;
+		}
+
+		VkDescriptorSetLayout DescriptorLayoutCache::getLayout(std::vector<VkDescriptorSetLayoutBinding> bindings) {
+			std::sort(bindings.begin(), bindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+				return a.binding < b.binding;
+			});
+			LayoutKey key = { bindings };
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto found = m_layouts.find(key);
+			if (found != m_layouts.end()) {
+				return found->second;
+			}
+
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+			if (!LavaCake::Core::CreateDescriptorSetLayout(logical, bindings, layout)) {
+				ErrorCheck::setError((char*)"Can't create descriptor set layout");
+				return VK_NULL_HANDLE;
+			}
+
+			std::map<VkDescriptorType, uint32_t>& counts = m_counts[layout];
+			for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+				counts[binding.descriptorType] += binding.descriptorCount;
+			}
+			m_layouts[key] = layout;
+			return layout;
+		}
+
+		std::map<VkDescriptorType, uint32_t> DescriptorLayoutCache::getDescriptorCounts(VkDescriptorSetLayout layout) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto found = m_counts.find(layout);
+			if (found == m_counts.end()) {
+				ErrorCheck::setError((char*)"The descriptor set layout was not created by the DescriptorLayoutCache");
+				return {};
+			}
+			return found->second;
+		}
+
+		uint32_t DescriptorLayoutCache::getLayoutCount() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return uint32_t(m_layouts.size());
+		}
+
+		void DescriptorLayoutCache::clear() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			for (auto& layout : m_layouts) {
+				vkDestroyDescriptorSetLayout(logical, layout.second, nullptr);
+			}
+			m_layouts.clear();
+			m_counts.clear();
+		}
+
+
+
+		DescriptorAllocator::DescriptorAllocator(uint32_t setsPerPool, bool freeIndividualSets) {
+			m_setsPerPool = setsPerPool > 0 ? setsPerPool : 1;
+			m_freeIndividualSets = freeIndividualSets;
+		}
+
+		bool DescriptorAllocator::allocate(VkDescriptorSetLayout layout, VkDescriptorSet& set) {
+			std::map<VkDescriptorType, uint32_t> counts = DescriptorLayoutCache::getCache()->getDescriptorCounts(layout);
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			// the pools created from now on are sized for the largest layout seen
+			for (auto& count : counts) {
+				m_counts[count.first] = std::max(m_counts[count.first], count.second);
+			}
+
+			VkDescriptorSetAllocateInfo descriptor_set_allocate_info = {
+				VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, // VkStructureType                  sType
+				nullptr,                                        // const void                     * pNext
+				VK_NULL_HANDLE,                                 // VkDescriptorPool                 descriptorPool
+				1,                                              // uint32_t                         descriptorSetCount
+				&layout                                         // const VkDescriptorSetLayout    * pSetLayouts
+			};
+
+			// the newest pool is the most likely to have room left
+			for (size_t i = m_pools.size(); i > 0; i--) {
+				descriptor_set_allocate_info.descriptorPool = m_pools[i - 1];
+				VkResult result = vkAllocateDescriptorSets(logical, &descriptor_set_allocate_info, &set);
+				if (result == VK_SUCCESS) {
+					m_setPools[set] = m_pools[i - 1];
+					return true;
+				}
+				if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+					ErrorCheck::setError((char*)"Can't allocate descriptor set");
+					return false;
+				}
+			}
+
+			if (!createPool()) {
+				return false;
+			}
+			descriptor_set_allocate_info.descriptorPool = m_pools.back();
+			if (vkAllocateDescriptorSets(logical, &descriptor_set_allocate_info, &set) != VK_SUCCESS) {
+				ErrorCheck::setError((char*)"Can't allocate descriptor set");
+				return false;
+			}
+			m_setPools[set] = m_pools.back();
+			return true;
+		}
+
+		bool DescriptorAllocator::createPool() {
+			std::vector<VkDescriptorPoolSize> sizes;
+			for (auto& count : m_counts) {
+				if (count.second > 0) {
+					sizes.push_back({ count.first, count.second * m_setsPerPool });
+				}
+			}
+			if (sizes.size() == 0) {
+				// layouts without bindings, a pool needs at least one size
+				sizes.push_back({ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 });
+			}
+
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			VkDescriptorPool pool = VK_NULL_HANDLE;
+			if (!LavaCake::Core::CreateDescriptorPool(logical, m_freeIndividualSets, m_setsPerPool, sizes, pool)) {
+				ErrorCheck::setError((char*)"Can't create descriptor pool");
+				return false;
+			}
+			m_pools.push_back(pool);
+			return true;
+		}
+
+		void DescriptorAllocator::free(VkDescriptorSet set) {
+			if (!m_freeIndividualSets) {
+				ErrorCheck::setError((char*)"This DescriptorAllocator can only be reset");
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto found = m_setPools.find(set);
+			if (found == m_setPools.end()) {
+				return;
+			}
+			vkFreeDescriptorSets(Device::getDevice()->getLogicalDevice(), found->second, 1, &set);
+			m_setPools.erase(found);
+		}
+
+		void DescriptorAllocator::reset() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			for (VkDescriptorPool pool : m_pools) {
+				vkResetDescriptorPool(logical, pool, 0);
+			}
+			m_setPools.clear();
+		}
+
+		uint32_t DescriptorAllocator::getPoolCount() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return uint32_t(m_pools.size());
+		}
+
+		void DescriptorAllocator::destroy() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_pools.empty()) {
+				return;
+			}
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			for (VkDescriptorPool pool : m_pools) {
+				vkDestroyDescriptorPool(logical, pool, nullptr);
+			}
+			m_pools.clear();
+			m_setPools.clear();
+		}
+
+		DescriptorAllocator::~DescriptorAllocator() {
+			destroy();
+		}
+	}
+}
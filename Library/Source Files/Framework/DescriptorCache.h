@@ -0,0 +1,152 @@
+#pragma once
+
+#include "AllHeaders.h"
+#include "Device.h"
+#include "ErrorCheck.h"
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace LavaCake {
+  namespace Framework {
+
+  /**
+   Class DescriptorLayoutCache :
+   \brief Create each distinct VkDescriptorSetLayout once and share it between every pipeline that uses the same bindings
+   Layouts are looked up by a hash of their bindings, the order in which the bindings are given does not matter.
+   This class is a singleton
+   */
+		class DescriptorLayoutCache {
+			static DescriptorLayoutCache* m_cache;
+			DescriptorLayoutCache() {};
+
+		public:
+
+      /**
+       \brief Return the layout cache
+       \return a static reference to the cache
+       */
+			static DescriptorLayoutCache* getCache() {
+				if (!m_cache) {
+					m_cache = new DescriptorLayoutCache();
+				}
+				return m_cache;
+			}
+
+      /**
+       \brief Return the layout matching a list of bindings, created on the first request
+       \param bindings : the bindings of the layout
+       \return a VkDescriptorSetLayout owned by the cache, VK_NULL_HANDLE if it could not be created
+       */
+			VkDescriptorSetLayout getLayout(std::vector<VkDescriptorSetLayoutBinding> bindings);
+
+      /**
+       \brief Return the number of descriptors of each type in a layout created by the cache
+       \param layout : the layout
+       \return the number of descriptors per descriptor type
+       */
+			std::map<VkDescriptorType, uint32_t> getDescriptorCounts(VkDescriptorSetLayout layout);
+
+      /**
+       \brief Return the number of distinct layouts created
+       \return the number of layouts
+       */
+			uint32_t getLayoutCount();
+
+      /**
+       \brief Destroy every layout of the cache, they must not be in use anymore
+       */
+			void clear();
+
+		private :
+
+			struct LayoutKey {
+				std::vector<VkDescriptorSetLayoutBinding>				bindings;
+				bool operator==(const LayoutKey& other) const;
+			};
+
+			struct LayoutKeyHash {
+				size_t operator()(const LayoutKey& key) const;
+			};
+
+			std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHash>	m_layouts;
+			std::map<VkDescriptorSetLayout, std::map<VkDescriptorType, uint32_t>>	m_counts;
+			std::mutex																				m_mutex;
+		};
+
+  /**
+   Class DescriptorAllocator :
+   \brief Hand out descriptor sets from a list of shared pools, a new pool is created when the existing ones are full.
+   Pools are sized from the layouts allocated so far, which must come from the DescriptorLayoutCache.
+   An allocator can either free its sets one by one, as the pipelines do with the shared allocator, or be reset as a whole :
+   use one allocator per frame in flight, with PerFrame<DescriptorAllocator>, and reset it at the start of the frame.
+   */
+		class DescriptorAllocator {
+		public:
+
+      /**
+       \brief Create an allocator, no pool is created before the first allocation
+       \param setsPerPool : the number of sets each pool can hold
+       \param freeIndividualSets : if true sets can be given back with free, otherwise only reset releases them
+       */
+			DescriptorAllocator(uint32_t setsPerPool = 64, bool freeIndividualSets = false);
+
+      /**
+       \brief Return the allocator shared by the pipelines, its sets are freed one by one
+       \return a static reference to the shared allocator
+       */
+			static DescriptorAllocator* getAllocator() {
+				if (!m_sharedAllocator) {
+					m_sharedAllocator = new DescriptorAllocator(64, true);
+				}
+				return m_sharedAllocator;
+			}
+
+      /**
+       \brief Allocate a descriptor set
+       \param layout : a layout created by the DescriptorLayoutCache
+       \param set : the allocated set
+       \return true if the set was allocated
+       */
+			bool allocate(VkDescriptorSetLayout layout, VkDescriptorSet& set);
+
+      /**
+       \brief Give a set back to its pool, the allocator must have been created with freeIndividualSets
+       \param set : the set to free
+       */
+			void free(VkDescriptorSet set);
+
+      /**
+       \brief Give every set back to the pools, the sets must not be used by a pending command buffer anymore
+       */
+			void reset();
+
+      /**
+       \brief Return the number of pools created by the allocator
+       \return the number of pools
+       */
+			uint32_t getPoolCount();
+
+      /**
+       \brief Destroy every pool and the sets allocated from them, called on the shared allocator by Device::end before the logical device is destroyed
+       */
+			void destroy();
+
+			~DescriptorAllocator();
+
+		private :
+
+			bool createPool();
+
+			static DescriptorAllocator*												m_sharedAllocator;
+
+			uint32_t																					m_setsPerPool;
+			bool																							m_freeIndividualSets;
+			std::vector<VkDescriptorPool>											m_pools;
+			std::map<VkDescriptorType, uint32_t>							m_counts;
+			std::map<VkDescriptorSet, VkDescriptorPool>				m_setPools;
+			std::mutex																				m_mutex;
+		};
+	}
+}
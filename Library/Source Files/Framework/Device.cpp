@@ -1,4 +1,6 @@
 #include "Device.h"
+#include "MemoryAllocator.h"
+#include "DescriptorCache.h"
 
 namespace LavaCake {
   namespace Framework {
@@ -13,6 +15,10 @@ namespace LavaCake {
 		}
 
 		PresentationQueue* Device::getPresentQueue() {
+			if (m_headless) {
+				ErrorCheck::setError((char*)"A headless device has no presentation queue");
+				return nullptr;
+			}
 			return m_presentQueue;
 		};
 
@@ -26,17 +32,78 @@ namespace LavaCake {
 
 
 		VkCommandPool  Device::getCommandPool() {
-			return *m_commandPool;
+			if (std::this_thread::get_id() == m_mainThread) {
+				return *m_commandPool;
+			}
+			return getCommandPool(m_commandPoolFamily);
 		};
 
+		VkCommandPool Device::getCommandPool(uint32_t queueFamily) {
+			if (std::this_thread::get_id() == m_mainThread && queueFamily == m_commandPoolFamily) {
+				return *m_commandPool;
+			}
+
+			std::lock_guard<std::mutex> lock(m_commandPoolMutex);
+			std::pair<std::thread::id, uint32_t> key = { std::this_thread::get_id(), queueFamily };
+			auto pool = m_threadCommandPools.find(key);
+			if (pool != m_threadCommandPools.end()) {
+				return pool->second;
+			}
+
+			VkCommandPool commandPool = VK_NULL_HANDLE;
+			if (!LavaCake::Core::CreateCommandPool(*m_logical, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, queueFamily, commandPool)) {
+				ErrorCheck::setError((char*)"The command pool could not be created");
+			}
+			m_threadCommandPools[key] = commandPool;
+			return commandPool;
+		}
+
+		void Device::freeCommandBuffers(VkCommandPool pool, uint32_t count, const VkCommandBuffer* buffers) {
+			std::lock_guard<std::mutex> lock(m_commandPoolMutex);
+			bool alive = m_commandPool && pool == *m_commandPool;
+			for (auto& threadPool : m_threadCommandPools) {
+				alive = alive || threadPool.second == pool;
+			}
+			if (!alive) {
+				ErrorCheck::setError((char*)"Command buffers were freed after their pool was destroyed by Device::end");
+				return;
+			}
+			vkFreeCommandBuffers(*m_logical, pool, count, buffers);
+		}
+
+		PipelineCache& Device::getPipelineCache() {
+			return m_pipelineCache;
+		}
+
 		VkSurfaceKHR  Device::getSurface() {
+			if (m_headless) {
+				ErrorCheck::setError((char*)"A headless device has no presentation surface");
+				return VK_NULL_HANDLE;
+			}
 			return *m_presentationSurface;
 		};
 
 
 		void Device::initDevices(int nbComputeQueue, int nbGraphicQueue, WindowParameters&	WindowParams, VkPhysicalDeviceFeatures* desired_device_features) {
+			createDevice(nbComputeQueue, nbGraphicQueue, &WindowParams, desired_device_features);
+		}
 
+		void Device::initDevices(int nbComputeQueue, int nbGraphicQueue, VkPhysicalDeviceFeatures* desired_device_features) {
+			createDevice(nbComputeQueue, nbGraphicQueue, nullptr, desired_device_features);
+		}
 
+		bool Device::isHeadless() {
+			return m_headless;
+		}
+
+		void Device::createDevice(int nbComputeQueue, int nbGraphicQueue, WindowParameters* WindowParams, VkPhysicalDeviceFeatures* desired_device_features) {
+
+			m_headless = WindowParams == nullptr;
+
+			if (nbComputeQueue < 0 || nbGraphicQueue < 0 || nbComputeQueue + nbGraphicQueue == 0) {
+				ErrorCheck::setError((char*)"A device needs at least one graphic or compute queue");
+				return;
+			}
 
 			if (!LavaCake::Core::ConnectWithVulkanLoaderLibrary(m_vulkanLibrary)) {
 				ErrorCheck::setError((char*)"Could not connect with Vulkan while initializing the device");
@@ -50,15 +117,17 @@ namespace LavaCake {
 				ErrorCheck::setError((char*)"Could not load global level Vulkan functions while initializing the device");
 			}
 
-
-
-			
-
 			std::vector<char const*> instance_extensions;
 			instance_extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
 
 			InitVkDestroyer(m_instance);
-			if (!LavaCake::Core::CreateVulkanInstanceWithWsiExtensionsEnabled(instance_extensions, "LavaCake", *m_instance)) {
+			if (m_headless) {
+				// no window : the surface extensions are not needed and may not be exposed by the driver
+				if (!LavaCake::Core::CreateVulkanInstance(instance_extensions, "LavaCake", *m_instance)) {
+					ErrorCheck::setError((char*)"Could not load Vulkan while initializing the device");
+				}
+			}
+			else if (!LavaCake::Core::CreateVulkanInstanceWithWsiExtensionsEnabled(instance_extensions, "LavaCake", *m_instance)) {
 				ErrorCheck::setError((char*)"Could not load Vulkan while initializing the device");
 			}
 
@@ -66,9 +135,11 @@ namespace LavaCake {
 				ErrorCheck::setError((char*)"Could not load instance level Vulkan functions while initializing the device");
 			}
 
-			InitVkDestroyer(m_instance, m_presentationSurface);
-			if (!LavaCake::Core::CreatePresentationSurface(*m_instance, WindowParams, *m_presentationSurface)) {
-				ErrorCheck::setError((char*)"Failed to create presentation surface");
+			if (!m_headless) {
+				InitVkDestroyer(m_instance, m_presentationSurface);
+				if (!LavaCake::Core::CreatePresentationSurface(*m_instance, *WindowParams, *m_presentationSurface)) {
+					ErrorCheck::setError((char*)"Failed to create presentation surface");
+				}
 			}
 
 			std::vector<VkPhysicalDevice> physical_devices;
@@ -88,101 +159,85 @@ namespace LavaCake {
                 VkPhysicalDeviceAccelerationStructureFeaturesKHR enabledAccelerationStructureFeatures{};
 				std::vector<char const*> device_extensions;
 				std::vector <LavaCake::Core::QueueInfo > requested_queues;
+				std::vector<uint32_t> families;
+				void* features_chain = nullptr;
+
 				for (int i = 0; i < nbGraphicQueue; i++) {
 					if (!m_graphicQueues[i].initIndex(&physical_device)) {
 						goto endloop;
 					}
+					families.push_back(m_graphicQueues[i].getIndex());
 				}
 
 				for (int i = 0; i < nbComputeQueue; i++) {
 					if (!m_computeQueues[i].initIndex(&physical_device)) {
 						goto endloop;
 					}
+					families.push_back(m_computeQueues[i].getIndex());
 				}
 
-				if (!m_presentQueue->initIndex(&physical_device, &(*m_presentationSurface))) {
-					continue;
-				}
-
-				requested_queues.push_back({ m_graphicQueues[0].getIndex(), { 1.0f } });
-				for (int i = 1; i < nbGraphicQueue; i++) {
-					for (int j = 0; j < i; j++) {
-						if (m_graphicQueues[i].getIndex() == m_graphicQueues[j].getIndex()) {
-							goto endConcGrapics;
-						}
+				if (!m_headless) {
+					if (!m_presentQueue->initIndex(&physical_device, &(*m_presentationSurface))) {
+						continue;
 					}
-					requested_queues.push_back({ m_graphicQueues[i].getIndex(),{ 1.0f } });
-				endConcGrapics:;
+					families.push_back(m_presentQueue->getIndex());
 				}
 
-				for (int i = 1; i < nbComputeQueue; i++) {
-					for (int j = 0; j < nbGraphicQueue; j++) {
-						if (m_computeQueues[i].getIndex() == m_graphicQueues[j].getIndex()) {
-							goto 	endConcCompute;
-						}
-					}
-
-					for (int j = 0; j < i; j++) {
-						if (m_graphicQueues[i].getIndex() == m_computeQueues[j].getIndex()) {
-							break;
+				// one VkDeviceQueueCreateInfo per queue family
+				for (size_t i = 0; i < families.size(); i++) {
+					for (size_t j = 0; j < i; j++) {
+						if (families[i] == families[j]) {
+							goto endConcQueue;
 						}
 					}
-					requested_queues.push_back({ m_computeQueues[i].getIndex(),{ 1.0f } });
-				endConcCompute:;
+					requested_queues.push_back({ families[i],{ 1.0f } });
+				endConcQueue:;
 				}
 
-
-				for (int j = 0; j < nbGraphicQueue; j++) {
-					if (m_presentQueue->getIndex() == m_graphicQueues[j].getIndex()) {
-						goto 	endConcPresent;
-					}
-				}
-
-				for (int j = 0; j < nbComputeQueue; j++) {
-					if (m_presentQueue->getIndex() == m_computeQueues[j].getIndex()) {
-						break;
-					}
+				if (requested_queues.size() == 0) {
+					goto endloop;
 				}
-				requested_queues.push_back({ m_presentQueue->getIndex(),{ 1.0f } });
-			endConcPresent:;
-
 
+				if (!m_headless) {
 #ifdef RAYTRACING
-				device_extensions.push_back(VK_KHR_SPIRV_1_4_EXTENSION_NAME);
-				device_extensions.push_back(VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME);
-				device_extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
-				device_extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
-				device_extensions.push_back(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
-				device_extensions.push_back(VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME);
-				device_extensions.push_back(VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME);
-				device_extensions.push_back(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME);
+					device_extensions.push_back(VK_KHR_SPIRV_1_4_EXTENSION_NAME);
+					device_extensions.push_back(VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME);
+					device_extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+					device_extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+					device_extensions.push_back(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+					device_extensions.push_back(VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME);
+					device_extensions.push_back(VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME);
+					device_extensions.push_back(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME);
+
 
 
-				
-				enabledBufferDeviceAddresFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-				enabledBufferDeviceAddresFeatures.bufferDeviceAddress = VK_TRUE;
+					enabledBufferDeviceAddresFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+					enabledBufferDeviceAddresFeatures.bufferDeviceAddress = VK_TRUE;
 
-				enabledRayTracingPipelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
-				enabledRayTracingPipelineFeatures.rayTracingPipeline = VK_TRUE;
-				enabledRayTracingPipelineFeatures.pNext = &enabledBufferDeviceAddresFeatures;
+					enabledRayTracingPipelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
+					enabledRayTracingPipelineFeatures.rayTracingPipeline = VK_TRUE;
+					enabledRayTracingPipelineFeatures.pNext = &enabledBufferDeviceAddresFeatures;
 
 
-				enabledAccelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
-				enabledAccelerationStructureFeatures.accelerationStructure = VK_TRUE;
-				enabledAccelerationStructureFeatures.pNext = &enabledRayTracingPipelineFeatures;
+					enabledAccelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
+					enabledAccelerationStructureFeatures.accelerationStructure = VK_TRUE;
+					enabledAccelerationStructureFeatures.pNext = &enabledRayTracingPipelineFeatures;
 #endif // USE_NV_RAYTRACING
 
 #ifdef RAYQUERY
-				//device_extensions.push_back(VK_KHR_RAY_QUERY_EXTENSION_NAME);
+					//device_extensions.push_back(VK_KHR_RAY_QUERY_EXTENSION_NAME);
 #endif // RAYQUERY
 
+					features_chain = (void*)(&enabledAccelerationStructureFeatures);
+					device_extensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+				}
+
 				InitVkDestroyer(m_logical);
-				device_extensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
 				if (desired_device_features == nullptr) {
 					desired_device_features = new VkPhysicalDeviceFeatures();
 				}
-				if (!LavaCake::Core::CreateLogicalDevice(physical_device, requested_queues, device_extensions, desired_device_features, (void*)(&enabledAccelerationStructureFeatures), *m_logical)) {
+				if (!LavaCake::Core::CreateLogicalDevice(physical_device, requested_queues, device_extensions, desired_device_features, features_chain, *m_logical)) {
 					continue;
 				}
 				else {
@@ -198,7 +253,9 @@ namespace LavaCake {
 						LavaCake::vkGetDeviceQueue(*m_logical, m_computeQueues[i].getIndex(), 0, &m_computeQueues[i].getHandle());
 					}
 
-					LavaCake::vkGetDeviceQueue(*m_logical, m_presentQueue->getIndex(), 0, &m_presentQueue->getHandle());
+					if (!m_headless) {
+						LavaCake::vkGetDeviceQueue(*m_logical, m_presentQueue->getIndex(), 0, &m_presentQueue->getHandle());
+					}
 					break;
 				}
 
@@ -207,13 +264,17 @@ namespace LavaCake {
 
 			if (!m_logical) {
 				ErrorCheck::setError((char*)"The logical device could not be created");
+				return;
 			}
 
-
+			m_commandPoolFamily = nbGraphicQueue > 0 ? m_graphicQueues[0].getIndex() : m_computeQueues[0].getIndex();
+			m_mainThread = std::this_thread::get_id();
 			InitVkDestroyer(m_logical, m_commandPool);
-			if (!LavaCake::Core::CreateCommandPool(*m_logical, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, m_graphicQueues[0].getIndex(), *m_commandPool)) {
+			if (!LavaCake::Core::CreateCommandPool(*m_logical, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, m_commandPoolFamily, *m_commandPool)) {
 				ErrorCheck::setError((char*)"The command pool could not be created");
 			}
+
+			m_pipelineCache.load(m_physical, *m_logical);
 		}
 
 		
@@ -229,6 +290,16 @@ namespace LavaCake {
 
 		void Device::end() {
 			waitForAllCommands();
+			std::lock_guard<std::mutex> lock(m_commandPoolMutex);
+			for (auto& pool : m_threadCommandPools) {
+				vkDestroyCommandPool(*m_logical, pool.second, nullptr);
+			}
+			m_threadCommandPools.clear();
+			m_pipelineCache.save();
+			m_pipelineCache.destroy();
+			DescriptorAllocator::getAllocator()->destroy();
+			DescriptorLayoutCache::getCache()->clear();
+			MemoryAllocator::getAllocator()->destroy();
 		}
 
 
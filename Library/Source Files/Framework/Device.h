@@ -2,6 +2,11 @@
 #include "AllHeaders.h"
 #include "Queue.h"
 #include "ErrorCheck.h"
+#include "PipelineCache.h"
+
+#include <map>
+#include <mutex>
+#include <thread>
 
 
 namespace LavaCake {
@@ -49,20 +54,43 @@ namespace LavaCake {
 			VkDevice& getLogicalDevice();
 
       /**
-       \brief Retourn the Command pool
-       \return the VkCommandPool used by the application
+       \brief Retourn the Command pool of the calling thread
+       Command pools can not be used by two threads at the same time, every thread other than the one that initialised the device gets its own pool, created on first call
+       \return the VkCommandPool used by the calling thread
        */
 			VkCommandPool getCommandPool();
 
+      /**
+       \brief Retourn the Command pool of the calling thread for a given queue family
+       \param queueFamily the index of the queue family the command buffers will be submitted to
+       \return the VkCommandPool used by the calling thread for this queue family
+       */
+			VkCommandPool getCommandPool(uint32_t queueFamily);
+
+      /**
+       \brief Free command buffers allocated from a pool returned by getCommandPool, the pools are locked during the call
+       The command buffers of a pool already destroyed by end are not freed, they must be freed before end is called.
+       \param pool the pool the command buffers were allocated from
+       \param count the number of command buffers
+       \param buffers the command buffers to free
+       */
+			void freeCommandBuffers(VkCommandPool pool, uint32_t count, const VkCommandBuffer* buffers);
+
+      /**
+       \brief Retourn the pipeline cache shared by every pipeline, loaded from the disk by initDevices and saved by end
+       \return a reference to the PipelineCache
+       */
+			PipelineCache& getPipelineCache();
+
       /**
        \brief Retourn the Vulkan surface
-       \return the VkSurfaceKHR used by the application
+       \return the VkSurfaceKHR used by the application, VK_NULL_HANDLE with an error on a headless device
        */
 			VkSurfaceKHR getSurface();
 
       /**
        \brief Retourn the Presentation Queue used to draw on the screen
-       \return a reference to PresentationQueue used by the application
+       \return a reference to PresentationQueue used by the application, nullptr with an error on a headless device
        */
 			PresentationQueue* getPresentQueue();
 
@@ -89,6 +117,22 @@ namespace LavaCake {
        \return a reference to a ComputeQueue
        */
 			void initDevices( int nbComputeQueue, int nbGraphicQueue, WindowParameters&	windowParams, VkPhysicalDeviceFeatures * desiredDeviceFeatures = nullptr);
+
+      /**
+       \brief Initialise the device without any window, surface or presentation queue
+       Intended for compute only applications running on machines without a display.
+       Swapchain and ray tracing extensions are not requested in this mode.
+       \param nbComputeQueue the number of compute queue requiered by the application
+       \param nbGraphicQueue the number of graphic queue requiered by the application, may be 0
+       \param desiredDeviceFeatures the device feature requiered by the application
+       */
+			void initDevices(int nbComputeQueue, int nbGraphicQueue, VkPhysicalDeviceFeatures* desiredDeviceFeatures = nullptr);
+
+      /**
+       \brief Tell if the device was initialised without a window
+       \return true if no surface nor presentation queue are available
+       */
+			bool isHeadless();
       
       
 			
@@ -101,6 +145,8 @@ namespace LavaCake {
 			
 
 			private :
+				void createDevice(int nbComputeQueue, int nbGraphicQueue, WindowParameters* windowParams, VkPhysicalDeviceFeatures* desiredDeviceFeatures);
+
 				VkPhysicalDevice													m_physical = VK_NULL_HANDLE;
 				VkDestroyer(VkDevice)											m_logical;
 				LIBRARY_TYPE															m_vulkanLibrary;
@@ -110,6 +156,14 @@ namespace LavaCake {
 				std::vector<GraphicQueue>									m_graphicQueues;
 				std::vector<ComputeQueue>									m_computeQueues;
 				PresentationQueue*												m_presentQueue = new PresentationQueue();
+				bool																			m_headless = false;
+
+				uint32_t																	m_commandPoolFamily = 0;
+				std::thread::id														m_mainThread;
+				std::map<std::pair<std::thread::id, uint32_t>, VkCommandPool>	m_threadCommandPools;
+				std::mutex																m_commandPoolMutex;
+
+				PipelineCache															m_pipelineCache;
 		};
 	}
 }
@@ -0,0 +1,159 @@
+#include "FrameContext.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+		FrameContext::FrameContext(uint32_t framesInFlight, bool headless) {
+			Device* d = Device::getDevice();
+			VkDevice logical = d->getLogicalDevice();
+			m_headless = headless;
+
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(d->getPhysicalDevice(), &properties);
+			if (properties.limits.timestampComputeAndGraphics) {
+				m_timestampPeriod = properties.limits.timestampPeriod;
+			}
+
+			VkSemaphoreCreateInfo semaphore_create_info = {
+				VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,    // VkStructureType            sType
+				nullptr,                                    // const void               * pNext
+				0                                           // VkSemaphoreCreateFlags     flags
+			};
+
+			VkQueryPoolCreateInfo query_pool_create_info = {
+				VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,   // VkStructureType                  sType
+				nullptr,                                    // const void                     * pNext
+				0,                                          // VkQueryPoolCreateFlags           flags
+				VK_QUERY_TYPE_TIMESTAMP,                    // VkQueryType                      queryType
+				2,                                          // uint32_t                         queryCount
+				0                                           // VkQueryPipelineStatisticFlags    pipelineStatistics
+			};
+
+			m_frames = std::vector<Frame>(framesInFlight);
+			for (Frame& frame : m_frames) {
+				frame.commandBuffer = new CommandBuffer();
+
+				if (!m_headless) {
+					if (vkCreateSemaphore(logical, &semaphore_create_info, nullptr, &frame.imageAvailable) != VK_SUCCESS ||
+						vkCreateSemaphore(logical, &semaphore_create_info, nullptr, &frame.renderFinished) != VK_SUCCESS) {
+						ErrorCheck::setError((char*)"Could not create the semaphores of a frame");
+					}
+				}
+
+				if (m_timestampPeriod > 0.0f) {
+					if (vkCreateQueryPool(logical, &query_pool_create_info, nullptr, &frame.queryPool) != VK_SUCCESS) {
+						frame.queryPool = VK_NULL_HANDLE;
+					}
+				}
+			}
+		}
+
+		void FrameContext::beginFrame() {
+			Device* d = Device::getDevice();
+			VkDevice logical = d->getLogicalDevice();
+			Frame& frame = m_frames[m_current];
+
+			if (frame.submitted) {
+				VkResult result = vkWaitForFences(logical, 1, &frame.commandBuffer->getFence(), VK_TRUE, UINT64_MAX);
+				if (VK_SUCCESS != result) {
+					ErrorCheck::setError((char*)"Waiting on a frame failed");
+				}
+
+				uint64_t timestamps[2];
+				if (frame.queryPool != VK_NULL_HANDLE &&
+					vkGetQueryPoolResults(logical, frame.queryPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+					m_gpuFrameTime = float(double(timestamps[1] - timestamps[0]) * m_timestampPeriod / 1000000.0);
+				}
+				frame.submitted = false;
+			}
+
+			if (!m_headless) {
+				frame.image = &SwapChain::getSwapChain()->acquireImage(frame.imageAvailable);
+			}
+
+			m_frameStart = std::chrono::high_resolution_clock::now();
+
+			frame.commandBuffer->resetFence();
+			frame.commandBuffer->beginRecord();
+
+			if (frame.queryPool != VK_NULL_HANDLE) {
+				vkCmdResetQueryPool(frame.commandBuffer->getHandle(), frame.queryPool, 0, 2);
+				vkCmdWriteTimestamp(frame.commandBuffer->getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, 0);
+			}
+		}
+
+		void FrameContext::endFrame(Queue* queue, PresentationQueue* presentQueue, std::vector<Core::WaitSemaphoreInfo> waitSemaphores, std::vector<VkSemaphore> signalSemaphores) {
+			Frame& frame = m_frames[m_current];
+
+			if (frame.queryPool != VK_NULL_HANDLE) {
+				vkCmdWriteTimestamp(frame.commandBuffer->getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, 1);
+			}
+			frame.commandBuffer->endRecord();
+
+			if (!m_headless) {
+				waitSemaphores.push_back({ frame.imageAvailable, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT });
+				signalSemaphores.push_back(frame.renderFinished);
+			}
+
+			frame.commandBuffer->submit(queue, waitSemaphores, signalSemaphores);
+			frame.submitted = true;
+
+			if (!m_headless && presentQueue != nullptr) {
+				SwapChain::getSwapChain()->presentImage(presentQueue, *frame.image, { frame.renderFinished });
+			}
+
+			m_cpuFrameTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - m_frameStart).count();
+			m_current = (m_current + 1) % m_frames.size();
+		}
+
+		CommandBuffer& FrameContext::getCommandBuffer() {
+			return *m_frames[m_current].commandBuffer;
+		}
+
+		SwapChainImage& FrameContext::getSwapChainImage() {
+			return *m_frames[m_current].image;
+		}
+
+		uint32_t FrameContext::getFrameIndex() {
+			return m_current;
+		}
+
+		uint32_t FrameContext::getFramesInFlight() {
+			return uint32_t(m_frames.size());
+		}
+
+		float FrameContext::getCPUFrameTime() {
+			return m_cpuFrameTime;
+		}
+
+		float FrameContext::getGPUFrameTime() {
+			return m_gpuFrameTime;
+		}
+
+		void FrameContext::waitIdle() {
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			for (Frame& frame : m_frames) {
+				if (frame.submitted) {
+					vkWaitForFences(logical, 1, &frame.commandBuffer->getFence(), VK_TRUE, UINT64_MAX);
+				}
+			}
+		}
+
+		FrameContext::~FrameContext() {
+			waitIdle();
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			for (Frame& frame : m_frames) {
+				delete frame.commandBuffer;
+				if (frame.imageAvailable != VK_NULL_HANDLE) {
+					vkDestroySemaphore(logical, frame.imageAvailable, nullptr);
+				}
+				if (frame.renderFinished != VK_NULL_HANDLE) {
+					vkDestroySemaphore(logical, frame.renderFinished, nullptr);
+				}
+				if (frame.queryPool != VK_NULL_HANDLE) {
+					vkDestroyQueryPool(logical, frame.queryPool, nullptr);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "AllHeaders.h"
+#include "Device.h"
+#include "ErrorCheck.h"
+#include "CommandBuffer.h"
+#include "SwapChain.h"
+#include "Queue.h"
+
+#include <chrono>
+#include <functional>
+
+namespace LavaCake {
+  namespace Framework {
+
+  /**
+   Class FrameContext :
+   \brief Rotates the per-frame resources of a rendering loop so that the CPU can record frame N+1 while the GPU executes frame N
+   Each frame slot owns a command buffer, a fence, an image available and a render finished semaphore and a timestamp query pool.
+   beginFrame only waits for the fence of the slot it reuses, framesInFlight frames back.
+   In headless mode no swapchain image is acquired nor presented, frames are only submitted.
+   */
+		class FrameContext {
+		public:
+
+      /**
+       \brief Create the per-frame resources
+       \param framesInFlight : the number of frames the CPU may record ahead of the GPU
+       \param headless : if true the frames are rendered offscreen, without swapchain
+       */
+			FrameContext(uint32_t framesInFlight = 2, bool headless = false);
+
+      /**
+       \brief Start a new frame : wait for the slot to be free, acquire a swapchain image and start recording the command buffer of the slot
+       */
+			void beginFrame();
+
+      /**
+       \brief End the frame : stop recording, submit the command buffer and present the swapchain image
+       \param queue : the queue the frame is submitted to
+       \param presentQueue : the queue used to present the image, ignored in headless mode
+       \param waitSemaphores : additional semaphores to wait on before executing the frame
+       \param signalSemaphores : additional semaphores signaled by the frame
+       */
+			void endFrame(Queue* queue, PresentationQueue* presentQueue = nullptr, std::vector<Core::WaitSemaphoreInfo> waitSemaphores = {}, std::vector<VkSemaphore> signalSemaphores = {});
+
+      /**
+       \brief Return the command buffer of the current frame, in a recording state between beginFrame and endFrame
+       \return a reference to a CommandBuffer
+       */
+			CommandBuffer& getCommandBuffer();
+
+      /**
+       \brief Return the swapchain image acquired for the current frame
+       \return a reference to a SwapChainImage
+       */
+			SwapChainImage& getSwapChainImage();
+
+      /**
+       \brief Return the index of the current frame slot, between 0 and framesInFlight - 1
+       \return the index of the slot
+       */
+			uint32_t getFrameIndex();
+
+      /**
+       \brief Return the number of frames in flight
+       \return the number of frame slots
+       */
+			uint32_t getFramesInFlight();
+
+      /**
+       \brief Return the time the CPU spent between the end of beginFrame and the end of endFrame for the last frame
+       \return a time in milliseconds
+       */
+			float getCPUFrameTime();
+
+      /**
+       \brief Return the time the GPU spent executing the last completed frame, measured with timestamp queries
+       \return a time in milliseconds, 0 if the queue does not support timestamps
+       */
+			float getGPUFrameTime();
+
+      /**
+       \brief Wait for every frame in flight to be executed
+       */
+			void waitIdle();
+
+			~FrameContext();
+
+		private :
+
+			struct Frame {
+				CommandBuffer*																	commandBuffer;
+				VkSemaphore																			imageAvailable = VK_NULL_HANDLE;
+				VkSemaphore																			renderFinished = VK_NULL_HANDLE;
+				VkQueryPool																			queryPool = VK_NULL_HANDLE;
+				SwapChainImage*																	image = nullptr;
+				bool																						submitted = false;
+			};
+
+			std::vector<Frame>																m_frames;
+			uint32_t																					m_current = 0;
+			bool																							m_headless;
+			float																							m_timestampPeriod = 0.0f;
+			float																							m_cpuFrameTime = 0.0f;
+			float																							m_gpuFrameTime = 0.0f;
+			std::chrono::high_resolution_clock::time_point		m_frameStart;
+		};
+
+  /**
+   Class PerFrame :
+   \brief Hold one copy of a resource per frame slot of a FrameContext, for resources written by the CPU every frame such as UniformBuffer
+   */
+		template <typename T>
+		class PerFrame {
+		public:
+
+      /**
+       \brief Create one default constructed resource per frame slot
+       \param context : the frame context
+       */
+			PerFrame(FrameContext& context) : m_context(context) {
+				for (uint32_t i = 0; i < context.getFramesInFlight(); i++) {
+					m_resources.push_back(new T());
+				}
+			}
+
+      /**
+       \brief Apply a function to every copy, to initialise them
+       \param function : the function to apply
+       */
+			void forEach(std::function<void(T&)> function) {
+				for (T* resource : m_resources) {
+					function(*resource);
+				}
+			}
+
+      /**
+       \brief Return the copy of the current frame slot
+       \return a reference to the resource
+       */
+			T& current() {
+				return *m_resources[m_context.getFrameIndex()];
+			}
+
+      /**
+       \brief Return the copy of a given frame slot
+       \param i : the index of the slot
+       \return a reference to the resource
+       */
+			T& operator[](uint32_t i) {
+				return *m_resources[i];
+			}
+
+			~PerFrame() {
+				for (T* resource : m_resources) {
+					delete resource;
+				}
+			}
+
+		private :
+			FrameContext&																			m_context;
+			std::vector<T*>																		m_resources;
+		};
+	}
+}
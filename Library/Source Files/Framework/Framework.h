@@ -12,9 +12,17 @@
 #include "ComputePipeline.h"
 #include "RenderPass.h"
 #include "Device.h"
+#include "MemoryAllocator.h"
+#include "StagingRing.h"
+#include "ReadbackPool.h"
 #include "ErrorCheck.h"
 #include "UniformBuffer.h"
 #include "Texture.h"
 #include "Constant.h"
 #include "CommandBuffer.h"
+#include "FrameContext.h"
+#include "ParallelRecorder.h"
+#include "PipelineCache.h"
+#include "ShaderReflection.h"
+#include "DescriptorCache.h"
 #include "ImGuiWrapper.h"
\ No newline at end of file
@@ -99,7 +99,7 @@ namespace LavaCake {
 					});
 			}
 
-			if (!Pipeline::CreatePipelineLayout(logical, { *m_descriptorSetLayout }, push_constant_ranges, *m_pipelineLayout)) {
+			if (!Pipeline::CreatePipelineLayout(logical, { m_descriptorSetLayout }, push_constant_ranges, *m_pipelineLayout)) {
 				ErrorCheck::setError((char*)"Can't create pipeline layout");
 			}
 
@@ -222,9 +222,11 @@ namespace LavaCake {
 			};
 
 			std::vector<VkPipeline> pipelines;
-			if (!Pipeline::CreateGraphicsPipelines(logical, { m_pipelineCreateInfo }, VK_NULL_HANDLE, pipelines)) {
+			auto start = std::chrono::high_resolution_clock::now();
+			if (!Pipeline::CreateGraphicsPipelines(logical, { m_pipelineCreateInfo }, d->getPipelineCache().getHandle(), pipelines)) {
 				ErrorCheck::setError((char*)"Can't create Graphics piepeline");
 			}
+			d->getPipelineCache().addCreationTime(1, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
 			InitVkDestroyer(logical, m_pipeline);
 			*m_pipeline = pipelines[0];
 			m_compiled = true;
@@ -235,9 +237,11 @@ namespace LavaCake {
 			VkDevice& logical = d->getLogicalDevice();
 
 			std::vector<VkPipeline> pipelines;
-			if (!Pipeline::CreateGraphicsPipelines(logical, { m_pipelineCreateInfo }, VK_NULL_HANDLE, pipelines)) {
+			auto start = std::chrono::high_resolution_clock::now();
+			if (!Pipeline::CreateGraphicsPipelines(logical, { m_pipelineCreateInfo }, d->getPipelineCache().getHandle(), pipelines)) {
 				ErrorCheck::setError((char*)"Can't create Graphics piepeline");
 			}
+			d->getPipelineCache().addCreationTime(1, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
 			*m_pipeline = pipelines[0];
 		}
 
@@ -307,9 +311,9 @@ namespace LavaCake {
 				vkCmdBindIndexBuffer(buffer.getHandle(), m_vertexBuffer->getIndexBuffer().getHandle(), VkDeviceSize(0), VK_INDEX_TYPE_UINT32);
 			}
 
-			if (m_descriptorCount > 0) {
+			if (m_descriptorSets.size() > 0) {
 				vkCmdBindDescriptorSets(buffer.getHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, *m_pipelineLayout, 0,
-					static_cast<uint32_t>(m_descriptorSets.size()), m_descriptorSets.data(),
+					1, &m_descriptorSets[m_currentDescriptorSet],
 					0, {});
 			}
 
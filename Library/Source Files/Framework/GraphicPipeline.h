@@ -112,6 +112,18 @@ namespace LavaCake {
 
 			}
 
+		protected :
+
+			std::vector<ShaderModule*> getShaderModules() override {
+				std::vector<ShaderModule*> modules;
+				for (ShaderModule* module : std::vector<ShaderModule*>{ m_vertexModule, m_tesselationControlModule, m_tesselationEvaluationModule, m_geometryModule, m_fragmentModule }) {
+					if (module != nullptr) {
+						modules.push_back(module);
+					}
+				}
+				return modules;
+			};
+
 		private:
 
 			void recompile();
@@ -19,9 +19,7 @@ namespace LavaCake {
       VkDevice logical = d->getLogicalDevice();
 
       InitVkDestroyer(logical, m_image);
-      InitVkDestroyer(logical, m_imageMemory);
       InitVkDestroyer(logical, m_imageView);
-      VkPhysicalDevice physical = d->getPhysicalDevice();
 
       VkImageType type = VK_IMAGE_TYPE_1D;
       VkImageViewType view = VK_IMAGE_VIEW_TYPE_1D;
@@ -33,7 +31,7 @@ namespace LavaCake {
         ErrorCheck::setError((char*)"Can't create Image");
       }
 
-      if (!LavaCake::Core::AllocateAndBindMemoryObjectToImage(physical, logical, *m_image, memPropertyFlag, *m_imageMemory)) {
+      if (!MemoryAllocator::getAllocator()->allocateForImage(*m_image, memPropertyFlag, m_allocation)) {
         ErrorCheck::setError((char*)"Can't allocate Image memory");
       }
 
@@ -46,15 +44,11 @@ namespace LavaCake {
     }
 
     void Image::map() {
-			Framework::Device* d = LavaCake::Framework::Device::getDevice();
-			VkDevice logical = d->getLogicalDevice();
-			vkMapMemory(logical, *m_imageMemory, 0, VK_WHOLE_SIZE, 0, &m_mappedMemory);
+			m_mappedMemory = m_allocation.mapped;
     }
 
 		void Image::unmap() {
-			Framework::Device* d = LavaCake::Framework::Device::getDevice();
-			VkDevice logical = d->getLogicalDevice();
-			vkUnmapMemory(logical, *m_imageMemory);
+			m_mappedMemory = nullptr;
 		}
 
 
@@ -194,7 +188,11 @@ namespace LavaCake {
 			return *m_image;
 		}
 		VkDeviceMemory& Image::getImageMemory() {
-			return *m_imageMemory;
+			return m_allocation.memory;
+		}
+
+		VkDeviceSize Image::getImageMemoryOffset() {
+			return m_allocation.offset;
 		}
 
 		VkImageView& Image::getImageView() {
@@ -3,6 +3,7 @@
 #include "CommandBuffer.h"
 #include "Queue.h"
 #include "Buffer.h"
+#include "MemoryAllocator.h"
 
 
 
@@ -90,6 +91,12 @@ namespace LavaCake {
        */
 			VkDeviceMemory& getImageMemory();
 
+      /**
+       \brief Get the offset of the image inside its memory
+       \return VkDeviceSize : the offset of the image in the VkDeviceMemory returned by getImageMemory
+       */
+			VkDeviceSize getImageMemoryOffset();
+
       /**
        \brief Get the handle of the image view
        \return VkImageView : the image view of the image
@@ -111,10 +118,7 @@ namespace LavaCake {
 					*m_imageView = VK_NULL_HANDLE;
 				}
 
-				if (VK_NULL_HANDLE != *m_imageMemory) {
-					vkFreeMemory(logical, *m_imageMemory, nullptr);
-					*m_imageMemory = VK_NULL_HANDLE;
-				}
+				MemoryAllocator::getAllocator()->free(m_allocation);
 
 			}
 
@@ -154,7 +158,7 @@ namespace LavaCake {
 			VkImageAspectFlagBits								m_aspect;
 
       VkDestroyer(VkImage)                m_image;
-      VkDestroyer(VkDeviceMemory)         m_imageMemory;
+      MemoryAllocation                    m_allocation;
       VkDestroyer(VkImageView)            m_imageView;
 
 			bool																m_cubemap;
@@ -0,0 +1,306 @@
+#include "MemoryAllocator.h"
+
+namespace LavaCake {
+  namespace Framework {
+		MemoryAllocator* MemoryAllocator::m_allocator;
+
+		static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+			return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+		}
+
+		bool MemoryAllocator::allocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags memPropertyFlag, bool deviceAddress, MemoryAllocation& allocation) {
+			Device* d = Device::getDevice();
+			VkDevice logical = d->getLogicalDevice();
+
+			VkMemoryRequirements memory_requirements;
+			vkGetBufferMemoryRequirements(logical, buffer, &memory_requirements);
+
+			if (!allocate(memory_requirements, memPropertyFlag, deviceAddress ? RESOURCE_BUFFER_DEVICE_ADDRESS : RESOURCE_BUFFER, allocation)) {
+				return false;
+			}
+
+			VkResult result = vkBindBufferMemory(logical, buffer, allocation.memory, allocation.offset);
+			if (VK_SUCCESS != result) {
+				ErrorCheck::setError((char*)"Could not bind memory object to a buffer.");
+				free(allocation);
+				return false;
+			}
+			return true;
+		}
+
+		bool MemoryAllocator::allocateForImage(VkImage image, VkMemoryPropertyFlags memPropertyFlag, MemoryAllocation& allocation) {
+			Device* d = Device::getDevice();
+			VkDevice logical = d->getLogicalDevice();
+
+			VkMemoryRequirements memory_requirements;
+			vkGetImageMemoryRequirements(logical, image, &memory_requirements);
+
+			if (!allocate(memory_requirements, memPropertyFlag, RESOURCE_IMAGE, allocation)) {
+				return false;
+			}
+
+			VkResult result = vkBindImageMemory(logical, image, allocation.memory, allocation.offset);
+			if (VK_SUCCESS != result) {
+				ErrorCheck::setError((char*)"Could not bind memory object to an image.");
+				free(allocation);
+				return false;
+			}
+			return true;
+		}
+
+		bool MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags memPropertyFlag, resourceKind kind, MemoryAllocation& allocation) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (!m_initialized) {
+				VkPhysicalDevice physical = Device::getDevice()->getPhysicalDevice();
+				vkGetPhysicalDeviceMemoryProperties(physical, &m_memoryProperties);
+				VkPhysicalDeviceProperties properties;
+				vkGetPhysicalDeviceProperties(physical, &properties);
+				m_atomSize = properties.limits.nonCoherentAtomSize;
+				m_initialized = true;
+			}
+
+			for (uint32_t type = 0; type < m_memoryProperties.memoryTypeCount; ++type) {
+				if (!(requirements.memoryTypeBits & (1 << type)) ||
+					((m_memoryProperties.memoryTypes[type].propertyFlags & memPropertyFlag) != memPropertyFlag)) {
+					continue;
+				}
+
+				// host visible ranges are padded to nonCoherentAtomSize so that they can be flushed independently
+				VkDeviceSize alignment = requirements.alignment;
+				VkDeviceSize size = requirements.size;
+				if (m_memoryProperties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+					alignment = std::max(alignment, m_atomSize);
+					size = alignUp(size, m_atomSize);
+				}
+
+				uint32_t poolIndex = UINT32_MAX;
+				for (uint32_t i = 0; i < m_pools.size(); i++) {
+					if (m_pools[i].memoryType == type && m_pools[i].kind == kind) {
+						poolIndex = i;
+						break;
+					}
+				}
+				if (poolIndex == UINT32_MAX) {
+					poolIndex = uint32_t(m_pools.size());
+					m_pools.push_back({ type, kind, {} });
+				}
+				Pool& pool = m_pools[poolIndex];
+
+				VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[type].heapIndex].size;
+				VkDeviceSize blockSize = alignUp(std::min(m_blockSize, heapSize / 8), m_atomSize);
+
+				uint32_t blockIndex = UINT32_MAX;
+				VkDeviceSize offset = 0;
+				if (size > blockSize / 2) {
+					if (!createBlock(pool, size, true, blockIndex)) {
+						continue;
+					}
+					pool.blocks[blockIndex].freeRanges.clear();
+				}
+				else {
+					for (uint32_t i = 0; i < pool.blocks.size(); i++) {
+						Block& block = pool.blocks[i];
+						if (!block.dedicated && block.memory != VK_NULL_HANDLE && allocateFromBlock(block, size, alignment, offset)) {
+							blockIndex = i;
+							break;
+						}
+					}
+					if (blockIndex == UINT32_MAX) {
+						if (!createBlock(pool, blockSize, false, blockIndex)) {
+							continue;
+						}
+						allocateFromBlock(pool.blocks[blockIndex], size, alignment, offset);
+					}
+				}
+
+				Block& block = pool.blocks[blockIndex];
+				block.allocationCount++;
+
+				allocation.memory = block.memory;
+				allocation.offset = offset;
+				allocation.size = size;
+				allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + offset : nullptr;
+				allocation.memoryType = type;
+				allocation.pool = poolIndex;
+				allocation.block = blockIndex;
+				return true;
+			}
+
+			ErrorCheck::setError((char*)"Could not allocate device memory.");
+			return false;
+		}
+
+		bool MemoryAllocator::createBlock(Pool& pool, VkDeviceSize size, bool dedicated, uint32_t& blockIndex) {
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+
+			VkMemoryAllocateFlagsInfo next{
+				VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+				nullptr,
+				VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR,
+				0
+			};
+
+			VkMemoryAllocateInfo memory_allocate_info = {
+				VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,																		// VkStructureType    sType
+				pool.kind == RESOURCE_BUFFER_DEVICE_ADDRESS ? &next : nullptr,						// const void       * pNext
+				size,																																			// VkDeviceSize       allocationSize
+				pool.memoryType																														// uint32_t           memoryTypeIndex
+			};
+
+			Block block;
+			VkResult result = vkAllocateMemory(logical, &memory_allocate_info, nullptr, &block.memory);
+			if (VK_SUCCESS != result) {
+				return false;
+			}
+
+			if (m_memoryProperties.memoryTypes[pool.memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+				result = vkMapMemory(logical, block.memory, 0, VK_WHOLE_SIZE, 0, &block.mapped);
+				if (VK_SUCCESS != result) {
+					vkFreeMemory(logical, block.memory, nullptr);
+					return false;
+				}
+			}
+
+			block.size = size;
+			block.dedicated = dedicated;
+			block.freeRanges[0] = size;
+
+			// reuse the slot of a released block so that indices held by live allocations stay valid
+			for (uint32_t i = 0; i < pool.blocks.size(); i++) {
+				if (pool.blocks[i].memory == VK_NULL_HANDLE) {
+					pool.blocks[i] = block;
+					blockIndex = i;
+					return true;
+				}
+			}
+			blockIndex = uint32_t(pool.blocks.size());
+			pool.blocks.push_back(block);
+			return true;
+		}
+
+		bool MemoryAllocator::allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+			for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); it++) {
+				VkDeviceSize rangeStart = it->first;
+				VkDeviceSize rangeEnd = it->first + it->second;
+				VkDeviceSize start = alignUp(rangeStart, alignment);
+				if (start + size <= rangeEnd) {
+					block.freeRanges.erase(it);
+					if (start > rangeStart) {
+						block.freeRanges[rangeStart] = start - rangeStart;
+					}
+					if (start + size < rangeEnd) {
+						block.freeRanges[start + size] = rangeEnd - (start + size);
+					}
+					offset = start;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void MemoryAllocator::free(MemoryAllocation& allocation) {
+			if (allocation.memory == VK_NULL_HANDLE) {
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			// the blocks are already freed if the allocator was destroyed before the resource
+			if (allocation.pool >= m_pools.size() || allocation.block >= m_pools[allocation.pool].blocks.size()) {
+				allocation = MemoryAllocation();
+				return;
+			}
+			Block& block = m_pools[allocation.pool].blocks[allocation.block];
+
+			block.allocationCount--;
+			if (block.dedicated) {
+				VkDevice logical = Device::getDevice()->getLogicalDevice();
+				vkFreeMemory(logical, block.memory, nullptr);
+				block = Block();
+			}
+			else {
+				// insert the range back and merge it with its neighbours
+				auto it = block.freeRanges.emplace(allocation.offset, allocation.size).first;
+				auto next = std::next(it);
+				if (next != block.freeRanges.end() && it->first + it->second == next->first) {
+					it->second += next->second;
+					block.freeRanges.erase(next);
+				}
+				if (it != block.freeRanges.begin()) {
+					auto prev = std::prev(it);
+					if (prev->first + prev->second == it->first) {
+						prev->second += it->second;
+						block.freeRanges.erase(it);
+					}
+				}
+			}
+
+			allocation = MemoryAllocation();
+		}
+
+		void MemoryAllocator::releaseEmptyBlocks() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			for (Pool& pool : m_pools) {
+				for (Block& block : pool.blocks) {
+					if (block.memory != VK_NULL_HANDLE && block.allocationCount == 0) {
+						vkFreeMemory(logical, block.memory, nullptr);
+						block = Block();
+					}
+				}
+			}
+		}
+
+		void MemoryAllocator::destroy() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			for (Pool& pool : m_pools) {
+				for (Block& block : pool.blocks) {
+					if (block.memory != VK_NULL_HANDLE) {
+						vkFreeMemory(logical, block.memory, nullptr);
+					}
+				}
+			}
+			m_pools.clear();
+			m_initialized = false;
+		}
+
+		void MemoryAllocator::setBlockSize(VkDeviceSize size) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_blockSize = size;
+		}
+
+		MemoryStatistics MemoryAllocator::getStatistics() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			MemoryStatistics stats;
+			VkDeviceSize totalFree = 0;
+			for (Pool& pool : m_pools) {
+				for (Block& block : pool.blocks) {
+					if (block.memory == VK_NULL_HANDLE) {
+						continue;
+					}
+					stats.allocationCount += block.allocationCount;
+					stats.bytesReserved += block.size;
+					if (block.dedicated) {
+						stats.dedicatedCount++;
+						stats.bytesInUse += block.size;
+						continue;
+					}
+					stats.blockCount++;
+					VkDeviceSize blockFree = 0;
+					for (auto& range : block.freeRanges) {
+						blockFree += range.second;
+						stats.largestFreeRange = std::max(stats.largestFreeRange, range.second);
+					}
+					totalFree += blockFree;
+					stats.bytesInUse += block.size - blockFree;
+				}
+			}
+			// 0 when all the free memory is in one range, close to 1 when it is scattered in many small ones
+			if (totalFree > 0) {
+				stats.fragmentation = 1.0f - float(stats.largestFreeRange) / float(totalFree);
+			}
+			return stats;
+		}
+	}
+}
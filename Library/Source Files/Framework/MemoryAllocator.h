@@ -0,0 +1,157 @@
+#pragma once
+
+#include "AllHeaders.h"
+#include "Device.h"
+#include "ErrorCheck.h"
+
+#include <map>
+#include <mutex>
+
+namespace LavaCake {
+  namespace Framework {
+
+  /**
+   Struct MemoryAllocation :
+   \brief a range of device memory handed out by the MemoryAllocator
+   */
+		struct MemoryAllocation {
+			VkDeviceMemory		memory = VK_NULL_HANDLE;
+			VkDeviceSize			offset = 0;
+			VkDeviceSize			size = 0;
+			void*							mapped = nullptr;
+			uint32_t					memoryType = 0;
+			uint32_t					pool = UINT32_MAX;
+			uint32_t					block = UINT32_MAX;
+		};
+
+  /**
+   Struct MemoryStatistics :
+   \brief a snapshot of the MemoryAllocator usage
+   */
+		struct MemoryStatistics {
+			uint32_t					allocationCount = 0;
+			uint32_t					blockCount = 0;
+			uint32_t					dedicatedCount = 0;
+			VkDeviceSize			bytesReserved = 0;
+			VkDeviceSize			bytesInUse = 0;
+			VkDeviceSize			largestFreeRange = 0;
+			float							fragmentation = 0.0f;
+		};
+
+  /**
+   Class MemoryAllocator :
+   \brief sub-allocate buffers and images from large VkDeviceMemory blocks
+   Blocks are grouped by memory type and by resource kind (buffer, device address buffer, image),
+   so linear and optimal resources never share a block and bufferImageGranularity can be ignored.
+   Host visible blocks are mapped once for their whole lifetime.
+   This class is a singleton
+   */
+		class MemoryAllocator {
+			static MemoryAllocator* m_allocator;
+			MemoryAllocator() {};
+
+		public:
+
+			enum resourceKind {
+				RESOURCE_BUFFER = 0,
+				RESOURCE_BUFFER_DEVICE_ADDRESS = 1,
+				RESOURCE_IMAGE = 2
+			};
+
+      /**
+       \brief Return the allocator
+       \return a static reference to the allocator
+       */
+			static MemoryAllocator* getAllocator() {
+				if (!m_allocator) {
+					m_allocator = new MemoryAllocator();
+				}
+				return m_allocator;
+			}
+
+      /**
+       \brief Allocate memory and bind it to a buffer
+       \param buffer the buffer to bind
+       \param memPropertyFlag the required memory properties
+       \param deviceAddress whether the buffer is created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+       \param allocation the resulting allocation
+       \return true if the memory was allocated and bound
+       */
+			bool allocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags memPropertyFlag, bool deviceAddress, MemoryAllocation& allocation);
+
+      /**
+       \brief Allocate memory and bind it to an image
+       \param image the image to bind
+       \param memPropertyFlag the required memory properties
+       \param allocation the resulting allocation
+       \return true if the memory was allocated and bound
+       */
+			bool allocateForImage(VkImage image, VkMemoryPropertyFlags memPropertyFlag, MemoryAllocation& allocation);
+
+      /**
+       \brief Allocate a range of memory
+       \param requirements the memory requirements of the resource
+       \param memPropertyFlag the required memory properties
+       \param kind the kind of resource that will be bound to the range
+       \param allocation the resulting allocation
+       \return true if a range was found
+       */
+			bool allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags memPropertyFlag, resourceKind kind, MemoryAllocation& allocation);
+
+      /**
+       \brief Give a range back to the allocator, the allocation is reset
+       \param allocation the allocation to free
+       */
+			void free(MemoryAllocation& allocation);
+
+      /**
+       \brief Free every block that does not hold any allocation anymore
+       */
+			void releaseEmptyBlocks();
+
+      /**
+       \brief Free every block, including the ones still holding allocations, called by Device::end before the logical device is destroyed
+       */
+			void destroy();
+
+      /**
+       \brief Set the size of the blocks allocated from now on, allocations larger than half a block get their own VkDeviceMemory
+       \param size the block size in bytes
+       */
+			void setBlockSize(VkDeviceSize size);
+
+      /**
+       \brief Return the current usage of the allocator
+       \return a MemoryStatistics
+       */
+			MemoryStatistics getStatistics();
+
+		private :
+
+			struct Block {
+				VkDeviceMemory																	memory = VK_NULL_HANDLE;
+				VkDeviceSize																		size = 0;
+				void*																						mapped = nullptr;
+				uint32_t																				allocationCount = 0;
+				bool																						dedicated = false;
+				std::map<VkDeviceSize, VkDeviceSize>						freeRanges;
+			};
+
+			struct Pool {
+				uint32_t																				memoryType;
+				resourceKind																		kind;
+				std::vector<Block>															blocks;
+			};
+
+			bool createBlock(Pool& pool, VkDeviceSize size, bool dedicated, uint32_t& blockIndex);
+			bool allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+
+			std::vector<Pool>																	m_pools;
+			VkPhysicalDeviceMemoryProperties									m_memoryProperties;
+			VkDeviceSize																			m_atomSize = 0;
+			VkDeviceSize																			m_blockSize = 64 * 1024 * 1024;
+			bool																							m_initialized = false;
+			std::mutex																				m_mutex;
+		};
+	}
+}
@@ -0,0 +1,68 @@
+#include "ParallelRecorder.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+		void ParallelRecorder::record(CommandBuffer& primary, const std::vector<std::function<void(CommandBuffer&)>>& recorders, VkRenderPass renderPass, uint32_t subpass, VkFramebuffer frameBuffer) {
+			if (recorders.size() == 0) {
+				return;
+			}
+
+			Helpers::JobSystem* jobSystem = Helpers::JobSystem::getJobSystem();
+			uint32_t nbThreads = jobSystem->getThreadCount();
+			uint32_t nbChunks = std::min(uint32_t(recorders.size()), nbThreads);
+			size_t chunkSize = (recorders.size() + nbChunks - 1) / nbChunks;
+			nbChunks = uint32_t((recorders.size() + chunkSize - 1) / chunkSize);
+
+			uint32_t call = m_call++;
+			if (m_secondaries.size() <= call) {
+				m_secondaries.push_back({});
+			}
+			if (m_secondaries[call].size() < nbChunks) {
+				m_secondaries[call].resize(nbChunks, std::vector<CommandBuffer*>(nbThreads, nullptr));
+			}
+
+			// a chunk may be recorded by any thread, remember which buffer was used
+			std::vector<CommandBuffer*> recorded(nbChunks, nullptr);
+			std::vector<std::function<void()>> jobs;
+			for (uint32_t chunk = 0; chunk < nbChunks; chunk++) {
+				jobs.push_back([&, chunk]() {
+					CommandBuffer* secondary = getSecondary(call, chunk, Helpers::JobSystem::getThreadIndex());
+					secondary->beginSecondaryRecord(renderPass, subpass, frameBuffer);
+					size_t end = std::min(recorders.size(), (chunk + 1) * chunkSize);
+					for (size_t i = chunk * chunkSize; i < end; i++) {
+						recorders[i](*secondary);
+					}
+					secondary->endRecord();
+					recorded[chunk] = secondary;
+				});
+			}
+			jobSystem->run(jobs);
+
+			primary.executeCommands(recorded);
+		}
+
+		void ParallelRecorder::reset() {
+			m_call = 0;
+		}
+
+		CommandBuffer* ParallelRecorder::getSecondary(uint32_t call, uint32_t chunk, uint32_t thread) {
+			CommandBuffer*& secondary = m_secondaries[call][chunk][thread];
+			if (secondary == nullptr) {
+				// allocated on the recording thread so that it comes from the pool of this thread
+				secondary = new CommandBuffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+			}
+			return secondary;
+		}
+
+		ParallelRecorder::~ParallelRecorder() {
+			for (auto& call : m_secondaries) {
+				for (auto& chunk : call) {
+					for (CommandBuffer* secondary : chunk) {
+						delete secondary;
+					}
+				}
+			}
+		}
+	}
+}
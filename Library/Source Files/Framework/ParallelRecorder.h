@@ -0,0 +1,53 @@
+#pragma once
+
+#include "AllHeaders.h"
+#include "Device.h"
+#include "ErrorCheck.h"
+#include "CommandBuffer.h"
+#include "Helpers/JobSystem.h"
+
+#include <functional>
+
+namespace LavaCake {
+  namespace Framework {
+
+  /**
+   Class ParallelRecorder :
+   \brief Record lists of commands on the threads of the JobSystem into secondary command buffers and execute them, in order, in a primary command buffer
+   The recorders are split in contiguous chunks, one per thread, and every chunk is recorded in a secondary command buffer allocated from the pool of the thread recording it.
+   The secondary command buffers are kept from one frame to the next, a recorder must therefore not be reused before the primary command buffer it recorded to is executed :
+   use one recorder per frame in flight, for instance with PerFrame<ParallelRecorder>, and call reset at the start of each frame.
+   record must be called by a single thread at a time.
+   The secondary command buffers are freed by the destructor through Device::freeCommandBuffers, under the lock of the command pools :
+   a recorder must be destroyed on the thread that initialised the device, while no record is running, and before Device::end destroys the pools of the threads.
+   */
+		class ParallelRecorder {
+		public:
+
+      /**
+       \brief Record commands in parallel and execute them in the primary command buffer
+       \param primary : the primary command buffer, in a recording state, the commands are executed in the order of the recorders
+       \param recorders : the functions recording the commands, each one receives a secondary command buffer in a recording state
+       \param renderPass (optional) the render pass the commands are executed in, it must have been begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+       \param subpass (optional) the index of the subpass the commands are executed in
+       \param frameBuffer (optional) the frame buffer the commands render to
+       */
+			void record(CommandBuffer& primary, const std::vector<std::function<void(CommandBuffer&)>>& recorders, VkRenderPass renderPass = VK_NULL_HANDLE, uint32_t subpass = 0, VkFramebuffer frameBuffer = VK_NULL_HANDLE);
+
+      /**
+       \brief Make the secondary command buffers available for a new frame, the primary command buffers they were executed in must have completed
+       */
+			void reset();
+
+			~ParallelRecorder();
+
+		private :
+
+			CommandBuffer* getSecondary(uint32_t call, uint32_t chunk, uint32_t thread);
+
+			// secondary command buffers per record call, chunk and thread
+			std::vector<std::vector<std::vector<CommandBuffer*>>>	m_secondaries;
+			uint32_t																					m_call = 0;
+		};
+	}
+}
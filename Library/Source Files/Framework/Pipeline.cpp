@@ -57,12 +57,157 @@ namespace LavaCake {
 			return false;
 		}
 
-		void Pipeline::generateDescriptorLayout() {
+		std::vector<ReflectedBinding> Pipeline::getReflectedBindings() {
+			std::vector<const ShaderReflection*> reflections;
+			for (ShaderModule* module : getShaderModules()) {
+				reflections.push_back(&module->getReflection());
+			}
+			return ShaderReflection::merge(reflections);
+		}
 
-			Device* d = Device::getDevice();
-			VkDevice logical = d->getLogicalDevice();
+		static void reflectBinding(const std::vector<ReflectedBinding>& reflected, const std::string& name, VkDescriptorType type, int& binding, VkShaderStageFlags& stage) {
+			const ReflectedBinding* found = nullptr;
+			for (const ReflectedBinding& r : reflected) {
+				// only the descriptor set 0 is used by the pipelines
+				if (r.set == 0 && (name.empty() ? int(r.binding) == binding : (r.name == name || r.typeName == name))) {
+					found = &r;
+					break;
+				}
+			}
+
+			if (found == nullptr) {
+				if (!name.empty()) {
+					ErrorCheck::setError((char*)"No binding of the pipeline shaders has this name");
+				}
+				return;
+			}
+			if (found->type != type) {
+				ErrorCheck::setError((char*)"The type of a binding does not match the one declared in the shaders");
+			}
+			binding = int(found->binding);
+			stage |= found->stage;
+		}
+
+		void Pipeline::applyReflection() {
+			// without reflected bindings the explicit bindings are kept, and every resource added by name sets an error
+			std::vector<ReflectedBinding> reflected = getReflectedBindings();
+
+			for (uniform& u : m_uniforms) {
+				reflectBinding(reflected, u.name, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, u.binding, u.stage);
+			}
+			for (texture& t : m_textures) {
+				reflectBinding(reflected, t.name, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, t.binding, t.stage);
+			}
+			for (frameBuffer& f : m_frameBuffers) {
+				reflectBinding(reflected, f.name, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, f.binding, f.stage);
+			}
+			for (attachment& a : m_attachments) {
+				reflectBinding(reflected, "", VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, a.binding, a.stage);
+			}
+			for (storageImage& s : m_storageImages) {
+				reflectBinding(reflected, s.name, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, s.binding, s.stage);
+			}
+			for (texelBuffer& t : m_texelBuffers) {
+				reflectBinding(reflected, t.name, VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, t.binding, t.stage);
+			}
+			for (buffer& b : m_buffers) {
+				reflectBinding(reflected, b.name, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, b.binding, b.stage);
+			}
+		}
+
+		void Pipeline::allocateDescriptorSet() {
+			for (VkDescriptorSet set : m_descriptorSets) {
+				DescriptorAllocator::getAllocator()->free(set);
+			}
+			m_descriptorSets.clear();
+			m_currentDescriptorSet = 0;
+
+			m_descriptorSetLayout = DescriptorLayoutCache::getCache()->getLayout(m_descriptorSetLayoutBinding);
+			if (m_descriptorCount == 0) return;
+
+			VkDescriptorSet set;
+			if (!DescriptorAllocator::getAllocator()->allocate(m_descriptorSetLayout, set)) {
+				ErrorCheck::setError((char*)"Can't allocate descriptor set");
+				return;
+			}
+			m_descriptorSets.push_back(set);
+		}
+
+		template<typename T>
+		static bool rebind(std::vector<T>& resources, int binding, std::function<void(T&)> assign) {
+			for (T& resource : resources) {
+				if (resource.binding == binding) {
+					assign(resource);
+					return true;
+				}
+			}
+			ErrorCheck::setError((char*)"No resource of this type is registered at this binding");
+			return false;
+		}
+
+		void Pipeline::setUniformBuffer(UniformBuffer* uniform, int binding) {
+			rebind<struct uniform>(m_uniforms, binding, [uniform](struct uniform& u) { u.buffer = uniform; });
+		}
+
+		void Pipeline::setTextureBuffer(TextureBuffer* texture, int binding) {
+			rebind<struct texture>(m_textures, binding, [texture](struct texture& t) { t.t = texture; });
+		}
+
+		void Pipeline::setFrameBuffer(FrameBuffer* frame, int binding, uint32_t view) {
+			rebind<struct frameBuffer>(m_frameBuffers, binding, [frame, view](struct frameBuffer& f) { f.f = frame; f.viewIndex = view; });
+		}
+
+		void Pipeline::setStorageImage(StorageImage* storage, int binding) {
+			rebind<struct storageImage>(m_storageImages, binding, [storage](struct storageImage& s) { s.s = storage; });
+		}
+
+		void Pipeline::setTexelBuffer(Buffer* texel, int binding) {
+			rebind<struct texelBuffer>(m_texelBuffers, binding, [texel](struct texelBuffer& t) { t.t = texel; });
+		}
+
+		void Pipeline::setBuffer(Buffer* buffer, int binding) {
+			rebind<struct buffer>(m_buffers, binding, [buffer](struct buffer& b) { b.t = buffer; });
+		}
+
+		uint32_t Pipeline::addDescriptorSet() {
+			if (m_descriptorSetLayout == VK_NULL_HANDLE || m_descriptorCount == 0) {
+				ErrorCheck::setError((char*)"The pipeline must be compiled and use descriptors before adding descriptor sets");
+				return 0;
+			}
+
+			VkDescriptorSet set;
+			if (!DescriptorAllocator::getAllocator()->allocate(m_descriptorSetLayout, set)) {
+				ErrorCheck::setError((char*)"Can't allocate descriptor set");
+				return m_currentDescriptorSet;
+			}
+			m_descriptorSets.push_back(set);
+			writeDescriptorSet(set);
+			return uint32_t(m_descriptorSets.size() - 1);
+		}
+
+		void Pipeline::selectDescriptorSet(uint32_t index) {
+			if (index >= m_descriptorSets.size()) {
+				ErrorCheck::setError((char*)"The descriptor set does not exist");
+				return;
+			}
+			m_currentDescriptorSet = index;
+		}
+
+		void Pipeline::updateDescriptorSet() {
+			if (m_descriptorSets.size() == 0) {
+				return;
+			}
+			writeDescriptorSet(m_descriptorSets[m_currentDescriptorSet]);
+		}
+
+		uint32_t Pipeline::getDescriptorSetCount() {
+			return uint32_t(m_descriptorSets.size());
+		}
+
+		void Pipeline::generateDescriptorLayout() {
 
 			m_descriptorSetLayoutBinding = {};
+			applyReflection();
 
 			for (uint32_t i = 0; i < m_uniforms.size(); i++) {
 				m_descriptorSetLayoutBinding.push_back({
@@ -119,60 +264,21 @@ namespace LavaCake {
 					});
 			}
 
-			InitVkDestroyer(logical, m_descriptorSetLayout);
-			if (!LavaCake::Core::CreateDescriptorSetLayout(logical, m_descriptorSetLayoutBinding, *m_descriptorSetLayout)) {
-				ErrorCheck::setError((char*)"Can't create descriptor set layout");
-			}
-
 			m_descriptorCount = static_cast<uint32_t>(m_uniforms.size() + m_textures.size() + m_storageImages.size() + m_attachments.size() + m_frameBuffers.size() + m_texelBuffers.size());
+			allocateDescriptorSet();
 			if (m_descriptorCount == 0) return;
 
-			m_descriptorPoolSize = {};
-
-			if (m_uniforms.size() > 0) {
-				m_descriptorPoolSize.push_back({
-					VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-						uint32_t(m_uniforms.size())
-					});
-			}
-			if (m_textures.size() + m_frameBuffers.size() > 0) {
-				m_descriptorPoolSize.push_back({
-					VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-						uint32_t(m_textures.size() + m_frameBuffers.size())
-					});
-			}
-			if (m_attachments.size() > 0) {
-				m_descriptorPoolSize.push_back({
-					VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
-						uint32_t(m_attachments.size())
-					});
-			}
-			if (m_storageImages.size() > 0) {
-				m_descriptorPoolSize.push_back({
-					VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-						uint32_t(m_storageImages.size())
-					});
-			}
-			if (m_texelBuffers.size() > 0) {
-				m_descriptorPoolSize.push_back({
-					VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
-						uint32_t(m_texelBuffers.size())
-					});
-			}
+			writeDescriptorSet(m_descriptorSets[0]);
+		}
 
-			InitVkDestroyer(logical, m_descriptorPool);
-			if (!LavaCake::Core::CreateDescriptorPool(logical, false, m_descriptorCount, m_descriptorPoolSize, *m_descriptorPool)) {
-				ErrorCheck::setError((char*)"Can't create descriptor pool");
-			}
+		void Pipeline::writeDescriptorSet(VkDescriptorSet set) {
+			Device* d = Device::getDevice();
+			VkDevice logical = d->getLogicalDevice();
 
-			if (!LavaCake::Core::AllocateDescriptorSets(logical, *m_descriptorPool, { *m_descriptorSetLayout }, m_descriptorSets)) {
-				ErrorCheck::setError((char*)"Can't allocate descriptor set");
-			}
 			m_bufferDescriptorUpdate = { };
-			int descriptorCount = 0;
 			for (uint32_t i = 0; i < m_uniforms.size(); i++) {
 				m_bufferDescriptorUpdate.push_back({
-					m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+					set,							// VkDescriptorSet                      TargetDescriptorSet
 					uint32_t(m_uniforms[i].binding),								// uint32_t                             TargetDescriptorBinding
 					0,																							// uint32_t                             TargetArrayElement
 					VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,							// VkDescriptorType                     TargetDescriptorType
@@ -189,7 +295,7 @@ namespace LavaCake {
 			m_imageDescriptorUpdate = { };
 			for (uint32_t i = 0; i < m_textures.size(); i++) {
 				m_imageDescriptorUpdate.push_back({
-					m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+					set,							// VkDescriptorSet                      TargetDescriptorSet
 					uint32_t(m_textures[i].binding),								// uint32_t                             TargetDescriptorBinding
 					0,																							// uint32_t                             TargetArrayElement
 					VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,			// VkDescriptorType                     TargetDescriptorType
@@ -212,7 +318,7 @@ namespace LavaCake {
 					});
 
 				m_imageDescriptorUpdate.push_back({
-					m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+					set,							// VkDescriptorSet                      TargetDescriptorSet
 					uint32_t(m_frameBuffers[i].binding),						// uint32_t                             TargetDescriptorBinding
 					0,																							// uint32_t                             TargetArrayElement
 					VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,			// VkDescriptorType                     TargetDescriptorType
@@ -221,7 +327,7 @@ namespace LavaCake {
 			}
 			for (uint32_t i = 0; i < m_attachments.size(); i++) {
 				m_imageDescriptorUpdate.push_back({
-						m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+						set,							// VkDescriptorSet                      TargetDescriptorSet
 						uint32_t(m_attachments[i].binding),								// uint32_t                             TargetDescriptorBinding
 						0,																							// uint32_t                             TargetArrayElement
 						VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,						// VkDescriptorType                     TargetDescriptorType
@@ -237,7 +343,7 @@ namespace LavaCake {
 
 			for (uint32_t i = 0; i < m_storageImages.size(); i++) {
 				m_imageDescriptorUpdate.push_back({
-						m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+						set,							// VkDescriptorSet                      TargetDescriptorSet
 						uint32_t(m_storageImages[i].binding),						// uint32_t                             TargetDescriptorBinding
 						0,																							// uint32_t                             TargetArrayElement
 						VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,								// VkDescriptorType                     TargetDescriptorType
@@ -255,7 +361,7 @@ namespace LavaCake {
 			for (uint32_t i = 0; i < m_texelBuffers.size(); i++) {
 
 				LavaCake::Core::TexelBufferDescriptorInfo info = {
-					m_descriptorSets[descriptorCount],
+					set,
 					uint32_t(m_texelBuffers[i].binding),
 					0,
 					VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
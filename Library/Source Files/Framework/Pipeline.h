@@ -5,6 +5,10 @@
 #include "UniformBuffer.h"
 #include "Texture.h"
 #include "Constant.h"
+#include "DescriptorCache.h"
+
+#include <chrono>
+#include <functional>
 
 namespace LavaCake {
 	namespace Framework {
@@ -13,12 +17,14 @@ namespace LavaCake {
 			UniformBuffer*          buffer;
 			int											binding;
 			VkShaderStageFlags			stage;
+			std::string							name;
 		};
 
 		struct texture {
 			TextureBuffer*          t;
 			int                     binding;
 			VkShaderStageFlags			stage;
+			std::string							name;
 		};
 
 		struct frameBuffer {
@@ -26,6 +32,7 @@ namespace LavaCake {
 			int                     binding;
 			VkShaderStageFlags			stage;
 			uint32_t                viewIndex;
+			std::string							name;
 		};
 
 		struct attachment {
@@ -38,6 +45,7 @@ namespace LavaCake {
 			StorageImage*           s;
 			int                     binding;
 			VkShaderStageFlags			stage;
+			std::string							name;
 		};
 
 		struct constant {
@@ -49,11 +57,13 @@ namespace LavaCake {
 			Buffer*                 t;
 			int                     binding;
 			VkShaderStageFlags			stage;
+			std::string							name;
 		};
 		struct buffer {
 			Buffer*                 t;
 			int                     binding;
 			VkShaderStageFlags			stage;
+			std::string							name;
 		};
 
     /**
@@ -69,7 +79,7 @@ namespace LavaCake {
        \param binding the binding point of the uniform shader, 0 by default
       */
 			virtual void addUniformBuffer(UniformBuffer* uniform, VkShaderStageFlags stage, int binding = 0) {
-				m_uniforms.push_back({uniform ,binding,stage});
+				m_uniforms.push_back({uniform ,binding,stage, ""});
 			};
 
 			/**
@@ -79,7 +89,7 @@ namespace LavaCake {
        \param binding the binding point of the texture buffer, 0 by default
 			*/
 			virtual void addTextureBuffer(TextureBuffer* texture, VkShaderStageFlags stage, int binding = 0) {
-				m_textures.push_back({ texture,binding,stage});
+				m_textures.push_back({ texture,binding,stage, "" });
 			};
 
 			/**
@@ -89,7 +99,7 @@ namespace LavaCake {
        \param binding the binding point of the frame buffer, 0 by default
 			*/
 			virtual void addFrameBuffer(FrameBuffer* frame, VkShaderStageFlags stage, int binding = 0, uint32_t view = 0) {
-				m_frameBuffers.push_back({frame,binding,stage,view});
+				m_frameBuffers.push_back({frame,binding,stage,view, ""});
 			}; 
 
 			/**
@@ -99,7 +109,7 @@ namespace LavaCake {
        \param binding the binding point of the storage image, 0 by default
 			*/
 			virtual void addStorageImage(StorageImage* storage, VkShaderStageFlags stage, int binding = 0) {
-				m_storageImages.push_back({ storage,binding,stage });
+				m_storageImages.push_back({ storage,binding,stage, "" });
 			}; 
 
 
@@ -120,7 +130,7 @@ namespace LavaCake {
        \param binding the binding point of the texel buffer, 0 by default
        */
 			virtual void addTexelBuffer(Buffer* texel, VkShaderStageFlags stage, int binding = 0) {
-				m_texelBuffers.push_back({ texel,binding,stage });
+				m_texelBuffers.push_back({ texel,binding,stage, "" });
 			};
       
       /**
@@ -130,10 +140,138 @@ namespace LavaCake {
        \param binding the binding point of the texel buffer, 0 by default
        */
 			virtual void addBuffer(Buffer* buffer, VkShaderStageFlags stage, int binding = 0) {
-				m_buffers.push_back({ buffer,binding,stage });
+				m_buffers.push_back({ buffer,binding,stage, "" });
 			};
 
-      
+
+      /**
+       \brief Add a uniform Buffer to the pipeline, its binding and shader stages are read from the shader modules
+       \param uniform a pointer to the uniform buffer
+       \param name the name of the uniform block, or of its variable, in the shaders
+       */
+			void addUniformBuffer(UniformBuffer* uniform, std::string name) {
+				m_uniforms.push_back({ uniform, -1, 0, name });
+			};
+
+      /**
+       \brief Add a texture Buffer to the pipeline, its binding and shader stages are read from the shader modules
+       \param texture a pointer to the texture buffer
+       \param name the name of the sampler in the shaders
+       */
+			void addTextureBuffer(TextureBuffer* texture, std::string name) {
+				m_textures.push_back({ texture, -1, 0, name });
+			};
+
+      /**
+       \brief Add a frame Buffer to the pipeline, its binding and shader stages are read from the shader modules
+       \param frame a pointer to the frame buffer
+       \param name the name of the sampler in the shaders
+       \param view the index of the image view of the frame buffer
+       */
+			void addFrameBuffer(FrameBuffer* frame, std::string name, uint32_t view = 0) {
+				m_frameBuffers.push_back({ frame, -1, 0, view, name });
+			};
+
+      /**
+       \brief Add a storage Image to the pipeline, its binding and shader stages are read from the shader modules
+       \param storage a pointer to the storage image
+       \param name the name of the image in the shaders
+       */
+			void addStorageImage(StorageImage* storage, std::string name) {
+				m_storageImages.push_back({ storage, -1, 0, name });
+			};
+
+      /**
+       \brief Add a texel buffer to the pipeline, its binding and shader stages are read from the shader modules
+       \param texel a pointer to the texel buffer
+       \param name the name of the image buffer in the shaders
+       */
+			void addTexelBuffer(Buffer* texel, std::string name) {
+				m_texelBuffers.push_back({ texel, -1, 0, name });
+			};
+
+      /**
+       \brief Add a buffer to the pipeline, its binding and shader stages are read from the shader modules
+       \param buffer a pointer to the buffer
+       \param name the name of the storage block, or of its variable, in the shaders
+       */
+			void addBuffer(Buffer* buffer, std::string name) {
+				m_buffers.push_back({ buffer, -1, 0, name });
+			};
+
+      /**
+       \brief Replace the uniform buffer registered at a binding, see updateDescriptorSet and addDescriptorSet
+       \param uniform a pointer to the new uniform buffer
+       \param binding the binding of the uniform buffer to replace
+       */
+			void setUniformBuffer(UniformBuffer* uniform, int binding);
+
+      /**
+       \brief Replace the texture buffer registered at a binding, see updateDescriptorSet and addDescriptorSet
+       \param texture a pointer to the new texture buffer
+       \param binding the binding of the texture buffer to replace
+       */
+			void setTextureBuffer(TextureBuffer* texture, int binding);
+
+      /**
+       \brief Replace the frame buffer registered at a binding, see updateDescriptorSet and addDescriptorSet
+       \param frame a pointer to the new frame buffer
+       \param binding the binding of the frame buffer to replace
+       \param view the index of the image view of the frame buffer
+       */
+			void setFrameBuffer(FrameBuffer* frame, int binding, uint32_t view = 0);
+
+      /**
+       \brief Replace the storage image registered at a binding, see updateDescriptorSet and addDescriptorSet
+       \param storage a pointer to the new storage image
+       \param binding the binding of the storage image to replace
+       */
+			void setStorageImage(StorageImage* storage, int binding);
+
+      /**
+       \brief Replace the texel buffer registered at a binding, see updateDescriptorSet and addDescriptorSet
+       \param texel a pointer to the new texel buffer
+       \param binding the binding of the texel buffer to replace
+       */
+			void setTexelBuffer(Buffer* texel, int binding);
+
+      /**
+       \brief Replace the buffer registered at a binding, see updateDescriptorSet and addDescriptorSet
+       \param buffer a pointer to the new buffer
+       \param binding the binding of the buffer to replace
+       */
+			void setBuffer(Buffer* buffer, int binding);
+
+      /**
+       \brief Write the resources currently registered into the selected descriptor set of a compiled pipeline, without recompiling it.
+       The selected set must not be used by a command buffer that is still executing, use addDescriptorSet to switch between sets instead.
+       */
+			void updateDescriptorSet();
+
+      /**
+       \brief Allocate a new descriptor set for a compiled pipeline and write the resources currently registered into it
+       \return the index of the new set, to pass to selectDescriptorSet
+       */
+			uint32_t addDescriptorSet();
+
+      /**
+       \brief Choose the descriptor set bound by the next compute, draw or trace calls, the set 0 is the one created by compile
+       \param index the index of the set
+       */
+			void selectDescriptorSet(uint32_t index);
+
+      /**
+       \brief Return the number of descriptor sets of the pipeline
+       \return the number of sets
+       */
+			uint32_t getDescriptorSetCount();
+
+      /**
+       \brief Return the descriptor bindings declared by the shader modules of the pipeline
+       \return the bindings of every stage, merged and sorted by set and binding
+       */
+			std::vector<ReflectedBinding> getReflectedBindings();
+
 			std::vector<attachment>& getAttachments() {
 				return m_attachments;
 			};
@@ -152,20 +290,38 @@ namespace LavaCake {
 					*m_pipelineLayout = VK_NULL_HANDLE;
 				}
 
-				if (VK_NULL_HANDLE != *m_descriptorPool) {
-					vkDestroyDescriptorPool(logical, *m_descriptorPool, nullptr);
-					*m_descriptorPool = VK_NULL_HANDLE;
-				}
-
-				if (VK_NULL_HANDLE != *m_descriptorSetLayout) {
-					vkDestroyDescriptorSetLayout(logical, *m_descriptorSetLayout, nullptr);
-					*m_descriptorSetLayout = VK_NULL_HANDLE;
+				// the layout belongs to the DescriptorLayoutCache, only the sets are given back
+				for (VkDescriptorSet set : m_descriptorSets) {
+					DescriptorAllocator::getAllocator()->free(set);
 				}
+				m_descriptorSets.clear();
 			};
 
 		protected :
 			virtual void generateDescriptorLayout();
 
+			/**
+			 \brief Return the shader modules used by the pipeline, their bindings are used to complete the ones registered with the add functions
+			*/
+			virtual std::vector<ShaderModule*> getShaderModules() {
+				return {};
+			};
+
+			/**
+			 \brief Resolve the bindings registered by name and add the shader stages the shaders use each binding in
+			*/
+			void applyReflection();
+
+			/**
+			 \brief Get the layout of m_descriptorSetLayoutBinding from the DescriptorLayoutCache and allocate the descriptor set from the shared DescriptorAllocator
+			*/
+			void allocateDescriptorSet();
+
+			/**
+			 \brief Write the registered resources into a descriptor set
+			*/
+			virtual void writeDescriptorSet(VkDescriptorSet set);
+
 			void SpecifyPipelineShaderStages(std::vector<Framework::ShaderStageParameters> const& shader_stage_params,
 				std::vector<VkPipelineShaderStageCreateInfo>& shader_stage_create_infos);
 
@@ -186,10 +342,9 @@ namespace LavaCake {
 			VkDestroyer(VkPipeline)																					m_pipeline;
 			VkDestroyer(VkPipelineLayout)																		m_pipelineLayout;
 
-			VkDestroyer(VkDescriptorSetLayout)															m_descriptorSetLayout;
-			VkDestroyer(VkDescriptorPool)																		m_descriptorPool;
+			VkDescriptorSetLayout																						m_descriptorSetLayout = VK_NULL_HANDLE;
 			std::vector<VkDescriptorSet>																		m_descriptorSets;
-			std::vector<VkDescriptorPoolSize>																m_descriptorPoolSize;
+			uint32_t																												m_currentDescriptorSet = 0;
 			std::vector<VkDescriptorSetLayoutBinding>												m_descriptorSetLayoutBinding;
 			uint32_t																												m_descriptorCount = 0;
 
@@ -0,0 +1,163 @@
+#include "PipelineCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace LavaCake {
+  namespace Framework {
+
+		static const uint32_t pipelineCacheMagic = 0x4350434c; // "LCPC"
+		static const uint32_t pipelineCacheVersion = 1;
+
+		void PipelineCache::setPath(const std::string& path) {
+			m_path = path;
+		}
+
+		bool PipelineCache::load(VkPhysicalDevice physical, VkDevice logical) {
+			m_logical = logical;
+			vkGetPhysicalDeviceProperties(physical, &m_properties);
+
+			if (m_path.empty()) {
+				std::stringstream name;
+				name << "LavaCake_" << std::hex << m_properties.vendorID << "_" << m_properties.deviceID << ".pipelinecache";
+				m_path = name.str();
+			}
+
+			std::vector<char> data;
+			FileHeader header = {};
+			std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+			std::streamoff fileSize = file ? std::streamoff(file.tellg()) : 0;
+			file.seekg(0);
+			// the data size of a corrupted header must not decide how much memory is allocated
+			if (file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader)) &&
+				header.magic == pipelineCacheMagic && header.version == pipelineCacheVersion &&
+				header.dataSize <= uint64_t(fileSize) - sizeof(FileHeader)) {
+				data.resize(size_t(header.dataSize));
+				if (!file.read(data.data(), data.size()) || !validate(data)) {
+					data.clear();
+				}
+			}
+
+			if (data.size() > 0) {
+				m_statistics.loaded = true;
+				m_statistics.loadedSize = data.size();
+				m_statistics.coldPipelineCount = header.coldPipelineCount;
+				m_statistics.coldCreationTime = header.coldCreationTime;
+			}
+
+			VkPipelineCacheCreateInfo pipeline_cache_create_info = {
+				VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,     // VkStructureType                sType
+				nullptr,                                          // const void                   * pNext
+				0,                                                // VkPipelineCacheCreateFlags     flags
+				data.size(),                                      // size_t                         initialDataSize
+				data.size() > 0 ? data.data() : nullptr           // const void                   * pInitialData
+			};
+
+			VkResult result = vkCreatePipelineCache(logical, &pipeline_cache_create_info, nullptr, &m_cache);
+			if (VK_SUCCESS != result && data.size() > 0) {
+				// the driver refused the data, start from an empty cache
+				m_statistics = PipelineCacheStatistics();
+				pipeline_cache_create_info.initialDataSize = 0;
+				pipeline_cache_create_info.pInitialData = nullptr;
+				result = vkCreatePipelineCache(logical, &pipeline_cache_create_info, nullptr, &m_cache);
+			}
+			if (VK_SUCCESS != result) {
+				m_cache = VK_NULL_HANDLE;
+				ErrorCheck::setError((char*)"Could not create the pipeline cache");
+				return false;
+			}
+			return m_statistics.loaded;
+		}
+
+		bool PipelineCache::validate(const std::vector<char>& data) {
+			// header of the Vulkan data : size, version, vendor ID, device ID and cache UUID
+			const size_t vulkanHeaderSize = 16 + VK_UUID_SIZE;
+			if (data.size() < vulkanHeaderSize) {
+				return false;
+			}
+
+			uint32_t values[4];
+			memcpy(values, data.data(), sizeof(values));
+			if (values[0] < vulkanHeaderSize || values[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+				return false;
+			}
+			if (values[2] != m_properties.vendorID || values[3] != m_properties.deviceID) {
+				return false;
+			}
+			return memcmp(data.data() + 16, m_properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+
+		bool PipelineCache::save() {
+			if (m_cache == VK_NULL_HANDLE) {
+				return false;
+			}
+
+			size_t size = 0;
+			if (vkGetPipelineCacheData(m_logical, m_cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+				return false;
+			}
+			std::vector<char> data(size);
+			if (vkGetPipelineCacheData(m_logical, m_cache, &size, data.data()) != VK_SUCCESS) {
+				return false;
+			}
+
+			// keep the timings of the run that built the cache from scratch, they are the reference for the saved time
+			FileHeader header = {};
+			header.magic = pipelineCacheMagic;
+			header.version = pipelineCacheVersion;
+			header.dataSize = size;
+			std::lock_guard<std::mutex> lock(m_mutex);
+			header.coldPipelineCount = m_statistics.loaded ? m_statistics.coldPipelineCount : m_statistics.pipelineCount;
+			header.coldCreationTime = m_statistics.loaded ? m_statistics.coldCreationTime : m_statistics.creationTime;
+
+			// written next to the cache then renamed, so that an interrupted save never leaves a truncated cache file
+			std::string temporary = m_path + ".tmp";
+			{
+				std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+				if (!file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader)) || !file.write(data.data(), size)) {
+					file.close();
+					std::remove(temporary.c_str());
+					ErrorCheck::setError((char*)"Could not write the pipeline cache file");
+					return false;
+				}
+			}
+
+			std::remove(m_path.c_str());
+			if (std::rename(temporary.c_str(), m_path.c_str()) != 0) {
+				std::remove(temporary.c_str());
+				ErrorCheck::setError((char*)"Could not write the pipeline cache file");
+				return false;
+			}
+			return true;
+		}
+
+		void PipelineCache::destroy() {
+			if (m_cache != VK_NULL_HANDLE) {
+				vkDestroyPipelineCache(m_logical, m_cache, nullptr);
+				m_cache = VK_NULL_HANDLE;
+			}
+		}
+
+		VkPipelineCache PipelineCache::getHandle() {
+			return m_cache;
+		}
+
+		void PipelineCache::addCreationTime(uint32_t count, double time) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_statistics.pipelineCount += count;
+			m_statistics.creationTime += time;
+		}
+
+		PipelineCacheStatistics PipelineCache::getStatistics() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			PipelineCacheStatistics statistics = m_statistics;
+			if (statistics.loaded && statistics.coldPipelineCount > 0) {
+				double coldAverage = statistics.coldCreationTime / double(statistics.coldPipelineCount);
+				statistics.savedTime = coldAverage * double(statistics.pipelineCount) - statistics.creationTime;
+			}
+			return statistics;
+		}
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "AllHeaders.h"
+#include "ErrorCheck.h"
+
+#include <mutex>
+#include <string>
+
+namespace LavaCake {
+  namespace Framework {
+
+		struct PipelineCacheStatistics {
+			bool																							loaded = false;						// true if valid data was read from the disk
+			size_t																						loadedSize = 0;						// size in bytes of the data read from the disk
+			uint32_t																					pipelineCount = 0;				// number of pipelines created during this run
+			double																						creationTime = 0.0;				// time spent creating pipelines during this run, in milliseconds
+			uint32_t																					coldPipelineCount = 0;		// number of pipelines created by the run that built the cache from scratch
+			double																						coldCreationTime = 0.0;		// time spent creating pipelines by that run, in milliseconds
+			double																						savedTime = 0.0;					// estimated creation time saved by the cache during this run, in milliseconds
+		};
+
+  /**
+   Class PipelineCache :
+   \brief Keep a VkPipelineCache on the disk between two runs of the application
+   The cache is loaded by Device::initDevices and written back by Device::end, it is shared by every GraphicPipeline, ComputePipeline and RayTracingPipeline.
+   Data written by another driver, vendor or device is discarded : the header of the Vulkan data is checked against the properties of the physical device.
+   The time spent creating pipelines is measured, and compared to the run that built the cache to estimate the time saved.
+   */
+		class PipelineCache {
+		public:
+
+      /**
+       \brief Set the file the cache is read from and written to, must be called before Device::initDevices
+       By default the file is named after the vendor and device ID and written in the working directory
+       \param path : the path of the file
+       */
+			void setPath(const std::string& path);
+
+      /**
+       \brief Create the VkPipelineCache, with the content of the cache file if it is valid for this device
+       \param physical : the physical device
+       \param logical : the logical device
+       \return true if valid data was loaded
+       */
+			bool load(VkPhysicalDevice physical, VkDevice logical);
+
+      /**
+       \brief Write the content of the VkPipelineCache to the disk
+       \return true if the file was written
+       */
+			bool save();
+
+      /**
+       \brief Destroy the VkPipelineCache
+       */
+			void destroy();
+
+      /**
+       \brief Return the VkPipelineCache to pass to pipeline creation functions
+       \return the VkPipelineCache, VK_NULL_HANDLE if the cache has not been loaded
+       */
+			VkPipelineCache getHandle();
+
+      /**
+       \brief Record the creation of pipelines, called by the pipeline classes
+       \param count : the number of pipelines created
+       \param time : the time spent creating them, in milliseconds
+       */
+			void addCreationTime(uint32_t count, double time);
+
+      /**
+       \brief Return the statistics of the cache for this run
+       \return a PipelineCacheStatistics
+       */
+			PipelineCacheStatistics getStatistics();
+
+		private :
+
+			struct FileHeader {
+				uint32_t																				magic;
+				uint32_t																				version;
+				uint64_t																				dataSize;
+				uint32_t																				coldPipelineCount;
+				uint32_t																				padding;
+				double																					coldCreationTime;
+			};
+
+			bool validate(const std::vector<char>& data);
+
+			VkPipelineCache																		m_cache = VK_NULL_HANDLE;
+			VkDevice																					m_logical = VK_NULL_HANDLE;
+			VkPhysicalDeviceProperties												m_properties;
+			std::string																				m_path;
+			PipelineCacheStatistics														m_statistics;
+			std::mutex																				m_mutex;
+		};
+	}
+}
@@ -0,0 +1,126 @@
+#include "ReadbackPool.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+		bool Readback::isReady() {
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			return vkGetFenceStatus(logical, m_commandBuffer->getFence()) == VK_SUCCESS;
+		}
+
+		void Readback::wait() {
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			VkResult result = vkWaitForFences(logical, 1, &m_commandBuffer->getFence(), VK_TRUE, UINT64_MAX);
+			if (VK_SUCCESS != result) {
+				ErrorCheck::setError((char*)"Waiting on a readback failed");
+			}
+		}
+
+		VkDeviceSize Readback::size() {
+			return m_size;
+		}
+
+		const void* Readback::data() {
+			if (!m_invalidated) {
+				wait();
+				m_staging->invalidate();
+				m_invalidated = true;
+			}
+			return m_staging->map();
+		}
+
+		ReadbackPool::ReadbackPool(Queue* queue) {
+			m_queue = queue;
+
+			// prefer cached memory : the host reads it, uncached write-combined memory is very slow to read
+			VkPhysicalDeviceMemoryProperties memory_properties;
+			vkGetPhysicalDeviceMemoryProperties(Device::getDevice()->getPhysicalDevice(), &memory_properties);
+
+			m_memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+			for (uint32_t type = 0; type < memory_properties.memoryTypeCount; ++type) {
+				VkMemoryPropertyFlags cached = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+				if ((memory_properties.memoryTypes[type].propertyFlags & cached) == cached) {
+					m_memoryProperties = VkMemoryPropertyFlagBits(cached);
+					break;
+				}
+			}
+		}
+
+		Readback* ReadbackPool::readBack(Buffer& buffer, VkDeviceSize offset, VkDeviceSize size) {
+			if (size == VK_WHOLE_SIZE) {
+				size = buffer.getSize() - offset;
+			}
+
+			Readback* readback = new Readback();
+			readback->m_pool = this;
+			readback->m_size = size;
+			readback->m_staging = acquireStaging(size);
+
+			if (m_freeCommandBuffers.size() > 0) {
+				readback->m_commandBuffer = m_freeCommandBuffers.back();
+				m_freeCommandBuffers.pop_back();
+			}
+			else {
+				readback->m_commandBuffer = new CommandBuffer();
+			}
+
+			CommandBuffer& cmdBuff = *readback->m_commandBuffer;
+			Buffer& staging = *readback->m_staging;
+
+			cmdBuff.resetFence();
+			cmdBuff.beginRecord();
+
+			VkPipelineStageFlags stage = buffer.getStage();
+			VkAccessFlagBits access = buffer.getAccess();
+
+			buffer.setAccess(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+			staging.setAccess(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+			buffer.copyToBuffer(cmdBuff, staging, { { offset, 0, size } });
+
+			buffer.setAccess(cmdBuff, stage, access);
+			staging.setAccess(cmdBuff, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+
+			cmdBuff.endRecord();
+			cmdBuff.submit(m_queue, {}, {});
+
+			return readback;
+		}
+
+		void ReadbackPool::release(Readback* readback) {
+			// the staging memory can only be reused once the copy is done
+			readback->wait();
+			m_freeStaging.push_back(readback->m_staging);
+			m_freeCommandBuffers.push_back(readback->m_commandBuffer);
+			delete readback;
+		}
+
+		Buffer* ReadbackPool::acquireStaging(VkDeviceSize size) {
+			size_t best = m_freeStaging.size();
+			for (size_t i = 0; i < m_freeStaging.size(); i++) {
+				if (m_freeStaging[i]->getSize() >= size && (best == m_freeStaging.size() || m_freeStaging[i]->getSize() < m_freeStaging[best]->getSize())) {
+					best = i;
+				}
+			}
+
+			if (best != m_freeStaging.size()) {
+				Buffer* staging = m_freeStaging[best];
+				m_freeStaging.erase(m_freeStaging.begin() + best);
+				return staging;
+			}
+
+			Buffer* staging = new Buffer();
+			staging->allocate(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, m_memoryProperties);
+			return staging;
+		}
+
+		ReadbackPool::~ReadbackPool() {
+			for (Buffer* staging : m_freeStaging) {
+				delete staging;
+			}
+			for (CommandBuffer* commandBuffer : m_freeCommandBuffers) {
+				delete commandBuffer;
+			}
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "AllHeaders.h"
+#include "Device.h"
+#include "ErrorCheck.h"
+#include "CommandBuffer.h"
+#include "Queue.h"
+#include "Buffer.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+		class ReadbackPool;
+
+  /**
+   Class Readback :
+   \brief A handle on an asynchronous copy of a Buffer to host memory, created by a ReadbackPool
+   */
+		class Readback {
+		public:
+
+      /**
+       \brief Tell if the copy is done without blocking
+       \return true if the data can be read
+       */
+			bool isReady();
+
+      /**
+       \brief Wait for the copy to be done
+       */
+			void wait();
+
+      /**
+       \brief Return the size of the data read back
+       \return the size in byte
+       */
+			VkDeviceSize size();
+
+      /**
+       \brief Wait for the copy and return a pointer to the staging memory, valid until the handle is released
+       \return a pointer to the data
+       */
+			const void* data();
+
+      /**
+       \brief Wait for the copy and write the data into a caller provided array
+       \param dst : the destination array
+       \param count : the number of elements dst can hold
+       */
+			template <typename t>
+			void copyTo(t* dst, size_t count) {
+				const void* src = data();
+				std::memcpy(dst, src, std::min(count * sizeof(t), static_cast<size_t>(m_size)));
+			}
+
+      /**
+       \brief Wait for the copy and write the data into a vector, resized to hold it
+       \param dst : the destination vector
+       */
+			template <typename t>
+			void copyTo(std::vector<t>& dst) {
+				dst.resize(static_cast<size_t>(m_size) / sizeof(t));
+				copyTo(dst.data(), dst.size());
+			}
+
+		private :
+			Readback() {};
+
+			ReadbackPool*																			m_pool = nullptr;
+			Buffer*																						m_staging = nullptr;
+			CommandBuffer*																		m_commandBuffer = nullptr;
+			VkDeviceSize																			m_size = 0;
+			bool																							m_invalidated = false;
+
+			friend class ReadbackPool;
+		};
+
+  /**
+   Class ReadbackPool :
+   \brief Records asynchronous copies of buffers to host visible memory
+   Staging buffers are host cached when the device allows it and are reused once their Readback is released.
+   */
+		class ReadbackPool {
+		public:
+
+      /**
+       \brief Create a readback pool
+       \param queue : the queue the copies will be submitted to
+       */
+			ReadbackPool(Queue* queue);
+
+      /**
+       \brief Submit the copy of a range of a buffer to host memory and return immediately
+       \param buffer : the buffer to read
+       \param offset : the offset in byte of the range to read
+       \param size : the size in byte of the range to read, VK_WHOLE_SIZE reads up to the end of the buffer
+       \return a handle to the copy, it must be given back with release
+       */
+			Readback* readBack(Buffer& buffer, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+      /**
+       \brief Give a handle back to the pool, its staging memory will be reused
+       \param readback : the handle to release
+       */
+			void release(Readback* readback);
+
+			~ReadbackPool();
+
+		private :
+			Buffer* acquireStaging(VkDeviceSize size);
+
+			Queue*																						m_queue;
+			VkMemoryPropertyFlagBits													m_memoryProperties;
+			std::vector<Buffer*>															m_freeStaging;
+			std::vector<CommandBuffer*>												m_freeCommandBuffers;
+		};
+	}
+}
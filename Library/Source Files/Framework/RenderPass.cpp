@@ -272,6 +272,37 @@ namespace LavaCake {
 		}
 
 
+		void RenderPass::draw(CommandBuffer& commandBuffer, FrameBuffer& frameBuffer, vec2u viewportMin, vec2u viewportMax, ParallelRecorder& recorder, std::vector<VkClearValue> const & clear_values) {
+
+			VkRenderPassBeginInfo renderPassBeginInfo = {
+				VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,																																														 // VkStructureType        sType
+				nullptr,																																																														 // const void           * pNext
+				* m_renderPass,																																																											 // VkRenderPass           renderPass
+				frameBuffer.getHandle(),																																																						 // VkFramebuffer          framebuffer
+				{ { 0, 0 },{uint32_t(viewportMax[0] - viewportMin[0]),uint32_t(viewportMax[1] - viewportMin[1])} },                                  // VkRect2D               renderArea
+				static_cast<uint32_t>(clear_values.size()),																																													 // uint32_t               clearValueCount
+				clear_values.data()																																																									 // const VkClearValue   * pClearValues
+			};
+
+			vkCmdBeginRenderPass(commandBuffer.getHandle(), &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+			for (uint32_t i = 0; i < m_subpass.size(); i++) {
+
+				if (i > 0) {
+					vkCmdNextSubpass(commandBuffer.getHandle(), VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+				}
+
+				std::vector<std::function<void(CommandBuffer&)>> recorders;
+				for (uint32_t j = 0; j < m_subpass[i].size(); j++) {
+					GraphicPipeline* pipeline = m_subpass[i][j];
+					recorders.push_back([pipeline](CommandBuffer& secondary) { pipeline->draw(secondary); });
+				}
+				recorder.record(commandBuffer, recorders, *m_renderPass, i, frameBuffer.getHandle());
+			}
+
+			vkCmdEndRenderPass(commandBuffer.getHandle());
+		}
+
+
 		VkRenderPass& RenderPass::getHandle() {
 			return *m_renderPass;
 		}
@@ -279,12 +310,10 @@ namespace LavaCake {
 		void RenderPass::prepareOutputFrameBuffer(FrameBuffer& frameBuffer) {
 			Framework::Device* d = LavaCake::Framework::Device::getDevice();
 			VkDevice logical = d->getLogicalDevice();
-			VkPhysicalDevice physical = d->getPhysicalDevice();
 			VkQueue& graphics_queue = d->getGraphicQueue(0)->getHandle();
 			
 
 			InitVkDestroyer(logical, frameBuffer.m_sampler);
-			InitVkDestroyer(logical, frameBuffer.m_imageMemory);
 		
 			if (!LavaCake::Core::CreateSampler(logical, VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_NEAREST,
 				VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, 
@@ -292,8 +321,6 @@ namespace LavaCake {
 				ErrorCheck::setError((char*)"Can't create an image sampler for this FrameBuffer");
 			}
 
-			bool linear_filtering = true;
-
 			VkImageUsageFlagBits usage;
 			VkImageAspectFlagBits aspect;
 			VkImageLayout layout;
@@ -301,6 +328,7 @@ namespace LavaCake {
 			
 			frameBuffer.m_images = std::vector<VkImage>(m_attachmentype.size());
 			frameBuffer.m_imageViews = std::vector<VkImageView>(m_attachmentype.size());
+			frameBuffer.m_allocations = std::vector<MemoryAllocation>(m_attachmentype.size());
 
 			int attachementIndex = 0;
 
@@ -350,8 +378,16 @@ namespace LavaCake {
 				frameBuffer.m_imageViews[i] =  VkImageView();
 
 
-				if (!LavaCake::Core::CreateSampledImage(physical, logical, VK_IMAGE_TYPE_2D, format,{ (uint32_t)frameBuffer.m_width, (uint32_t)frameBuffer.m_height, 1 }, 1, 1, usage, false, VK_IMAGE_VIEW_TYPE_2D, aspect, linear_filtering, frameBuffer.m_images[i], *frameBuffer.m_imageMemory, frameBuffer.m_imageViews[i])) {
-					ErrorCheck::setError((char*)"Can't create an image sampler for this FrameBuffer");
+				if (!LavaCake::Core::CreateImage(logical, VK_IMAGE_TYPE_2D, format, { (uint32_t)frameBuffer.m_width, (uint32_t)frameBuffer.m_height, 1 }, 1, 1, VK_SAMPLE_COUNT_1_BIT, usage | VK_IMAGE_USAGE_SAMPLED_BIT, false, frameBuffer.m_images[i])) {
+					ErrorCheck::setError((char*)"Can't create an image for this FrameBuffer");
+				}
+
+				if (!MemoryAllocator::getAllocator()->allocateForImage(frameBuffer.m_images[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frameBuffer.m_allocations[i])) {
+					ErrorCheck::setError((char*)"Can't allocate an image memory for this FrameBuffer");
+				}
+
+				if (!LavaCake::Core::CreateImageView(logical, frameBuffer.m_images[i], VK_IMAGE_VIEW_TYPE_2D, format, aspect, frameBuffer.m_imageViews[i])) {
+					ErrorCheck::setError((char*)"Can't create an image view for this FrameBuffer");
 				}
 				
 			}
@@ -2,6 +2,7 @@
 #include "AllHeaders.h"
 #include "GraphicPipeline.h"
 #include "SwapChain.h"
+#include "ParallelRecorder.h"
 
 namespace LavaCake {
 	namespace Framework {
@@ -86,6 +87,11 @@ namespace LavaCake {
 			*/
 			void draw(CommandBuffer& commandBuffer, FrameBuffer& frameBuffer, vec2u viewportMin, vec2u viewportMax, std::vector<VkClearValue> const & clear_values = {{ 1.0f, 0 }});
 
+			/*
+			* Draw the render pass into a framebuffer, the pipelines of each subpass are recorded in parallel into secondary command buffers
+			*/
+			void draw(CommandBuffer& commandBuffer, FrameBuffer& frameBuffer, vec2u viewportMin, vec2u viewportMax, ParallelRecorder& recorder, std::vector<VkClearValue> const & clear_values = {{ 1.0f, 0 }});
+
 			/*
 			*	return the handle of the render pass
 			*/
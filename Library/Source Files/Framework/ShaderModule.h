@@ -2,6 +2,7 @@
 
 #include "AllHeaders.h"
 #include "Device.h"
+#include "ShaderReflection.h"
 
 namespace LavaCake {
 	namespace Framework{
@@ -60,6 +61,20 @@ namespace LavaCake {
 				return m_stageParameter;
 			}
 
+			/**
+			 \brief Return the descriptor bindings used by the module, read from its SPIR-V code on first call
+			 \return a reference to the ShaderReflection of the module
+			*/
+			const ShaderReflection& getReflection() {
+				if (!m_reflected) {
+					if (!m_reflection.reflect(m_spirv, m_stageParameter.ShaderStage)) {
+						ErrorCheck::setError((char*)"Can't read the bindings of the Shader module");
+					}
+					m_reflected = true;
+				}
+				return m_reflection;
+			}
+
 			void refresh() {
 				LavaCake::Framework::Device* d = LavaCake::Framework::Device::getDevice();
 				VkDevice logicalDevice = d->getLogicalDevice();
@@ -73,6 +88,7 @@ namespace LavaCake {
 				}
 
 				m_stageParameter.ShaderModule = *m_module;
+				m_reflected = false;
 			}
 
 			~ShaderModule() {
@@ -118,6 +134,8 @@ namespace LavaCake {
 			std::string																m_path;
 			std::vector<unsigned char>								m_spirv;
 			ShaderStageParameters											m_stageParameter;
+			ShaderReflection													m_reflection;
+			bool																			m_reflected = false;
 		};
 
     /**
@@ -0,0 +1,371 @@
+#include "ShaderReflection.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace LavaCake {
+  namespace Framework {
+
+		// subset of the SPIR-V specification needed to read descriptor bindings
+		enum SpirvOp {
+			SPIRV_OP_NAME = 5,
+			SPIRV_OP_MEMBER_NAME = 6,
+			SPIRV_OP_TYPE_BOOL = 20,
+			SPIRV_OP_TYPE_INT = 21,
+			SPIRV_OP_TYPE_FLOAT = 22,
+			SPIRV_OP_TYPE_VECTOR = 23,
+			SPIRV_OP_TYPE_MATRIX = 24,
+			SPIRV_OP_TYPE_IMAGE = 25,
+			SPIRV_OP_TYPE_SAMPLER = 26,
+			SPIRV_OP_TYPE_SAMPLED_IMAGE = 27,
+			SPIRV_OP_TYPE_ARRAY = 28,
+			SPIRV_OP_TYPE_RUNTIME_ARRAY = 29,
+			SPIRV_OP_TYPE_STRUCT = 30,
+			SPIRV_OP_TYPE_POINTER = 32,
+			SPIRV_OP_CONSTANT = 43,
+			SPIRV_OP_VARIABLE = 59,
+			SPIRV_OP_DECORATE = 71,
+			SPIRV_OP_MEMBER_DECORATE = 72,
+			SPIRV_OP_TYPE_ACCELERATION_STRUCTURE = 5341
+		};
+
+		enum SpirvDecoration {
+			SPIRV_DECORATION_BLOCK = 2,
+			SPIRV_DECORATION_BUFFER_BLOCK = 3,
+			SPIRV_DECORATION_ARRAY_STRIDE = 6,
+			SPIRV_DECORATION_MATRIX_STRIDE = 7,
+			SPIRV_DECORATION_BINDING = 33,
+			SPIRV_DECORATION_DESCRIPTOR_SET = 34,
+			SPIRV_DECORATION_OFFSET = 35
+		};
+
+		enum SpirvStorageClass {
+			SPIRV_STORAGE_UNIFORM_CONSTANT = 0,
+			SPIRV_STORAGE_UNIFORM = 2,
+			SPIRV_STORAGE_STORAGE_BUFFER = 12
+		};
+
+		enum SpirvDim {
+			SPIRV_DIM_BUFFER = 5,
+			SPIRV_DIM_SUBPASS_DATA = 6
+		};
+
+		static std::string readString(const uint32_t* words, uint32_t count) {
+			std::string result;
+			const char* characters = reinterpret_cast<const char*>(words);
+			for (uint32_t i = 0; i < count * 4 && characters[i] != '\0'; i++) {
+				result.push_back(characters[i]);
+			}
+			return result;
+		}
+
+		// the smallest valid word count of the instructions read, the opcode word included, so that their operands can be read without checks
+		static uint32_t minimumWordCount(uint32_t opcode) {
+			switch (opcode) {
+			case SPIRV_OP_TYPE_BOOL:
+			case SPIRV_OP_TYPE_SAMPLER:
+			case SPIRV_OP_TYPE_STRUCT:
+			case SPIRV_OP_TYPE_ACCELERATION_STRUCTURE:
+				return 2;
+			case SPIRV_OP_NAME:
+			case SPIRV_OP_DECORATE:
+			case SPIRV_OP_TYPE_FLOAT:
+			case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+			case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+				return 3;
+			case SPIRV_OP_MEMBER_NAME:
+			case SPIRV_OP_MEMBER_DECORATE:
+			case SPIRV_OP_TYPE_INT:
+			case SPIRV_OP_TYPE_VECTOR:
+			case SPIRV_OP_TYPE_MATRIX:
+			case SPIRV_OP_TYPE_ARRAY:
+			case SPIRV_OP_TYPE_POINTER:
+			case SPIRV_OP_CONSTANT:
+			case SPIRV_OP_VARIABLE:
+				return 4;
+			case SPIRV_OP_TYPE_IMAGE:
+				return 9;
+			default:
+				return 1;
+			}
+		}
+
+		bool ShaderReflection::reflect(const std::vector<unsigned char>& spirv, VkShaderStageFlags stage) {
+			m_types.clear();
+			m_constants.clear();
+			m_names.clear();
+			m_memberNames.clear();
+			m_decorations.clear();
+			m_memberDecorations.clear();
+			m_bindings.clear();
+
+			if (spirv.size() < 20 || spirv.size() % 4 != 0) {
+				return false;
+			}
+			std::vector<uint32_t> words(spirv.size() / 4);
+			memcpy(words.data(), spirv.data(), spirv.size());
+			if (words[0] != 0x07230203) {
+				return false;
+			}
+
+			// result type, storage class
+			std::map<uint32_t, std::pair<uint32_t, uint32_t>> variables;
+
+			size_t position = 5;
+			while (position < words.size()) {
+				uint32_t opcode = words[position] & 0xffff;
+				uint32_t count = words[position] >> 16;
+				if (count < minimumWordCount(opcode) || position + count > words.size()) {
+					return false;
+				}
+				const uint32_t* instruction = &words[position];
+
+				switch (opcode) {
+				case SPIRV_OP_NAME:
+					m_names[instruction[1]] = readString(instruction + 2, count - 2);
+					break;
+				case SPIRV_OP_MEMBER_NAME:
+					m_memberNames[instruction[1]][instruction[2]] = readString(instruction + 3, count - 3);
+					break;
+				case SPIRV_OP_DECORATE:
+					m_decorations[instruction[1]][instruction[2]] = count > 3 ? instruction[3] : 1;
+					break;
+				case SPIRV_OP_MEMBER_DECORATE:
+					m_memberDecorations[instruction[1]][instruction[2]][instruction[3]] = count > 4 ? instruction[4] : 1;
+					break;
+				case SPIRV_OP_CONSTANT:
+					m_constants[instruction[2]] = instruction[3];
+					break;
+				case SPIRV_OP_VARIABLE:
+					variables[instruction[2]] = { instruction[1], instruction[3] };
+					break;
+				case SPIRV_OP_TYPE_BOOL:
+				case SPIRV_OP_TYPE_INT:
+				case SPIRV_OP_TYPE_FLOAT:
+				case SPIRV_OP_TYPE_VECTOR:
+				case SPIRV_OP_TYPE_MATRIX:
+				case SPIRV_OP_TYPE_IMAGE:
+				case SPIRV_OP_TYPE_SAMPLER:
+				case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+				case SPIRV_OP_TYPE_ARRAY:
+				case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+				case SPIRV_OP_TYPE_STRUCT:
+				case SPIRV_OP_TYPE_POINTER:
+				case SPIRV_OP_TYPE_ACCELERATION_STRUCTURE:
+					m_types[instruction[1]] = { opcode, std::vector<uint32_t>(instruction + 2, instruction + count) };
+					break;
+				default:
+					break;
+				}
+				position += count;
+			}
+
+			for (auto& variable : variables) {
+				uint32_t id = variable.first;
+				uint32_t storage = variable.second.second;
+				if (m_decorations[id].count(SPIRV_DECORATION_BINDING) == 0) {
+					continue;
+				}
+				if (storage != SPIRV_STORAGE_UNIFORM_CONSTANT && storage != SPIRV_STORAGE_UNIFORM && storage != SPIRV_STORAGE_STORAGE_BUFFER) {
+					continue;
+				}
+
+				SpirvType& pointer = m_types[variable.second.first];
+				if (pointer.opcode != SPIRV_OP_TYPE_POINTER || pointer.operands.size() < 2) {
+					continue;
+				}
+
+				ReflectedBinding binding;
+				binding.name = m_names[id];
+				binding.set = m_decorations[id].count(SPIRV_DECORATION_DESCRIPTOR_SET) ? m_decorations[id][SPIRV_DECORATION_DESCRIPTOR_SET] : 0;
+				binding.binding = m_decorations[id][SPIRV_DECORATION_BINDING];
+				binding.stage = stage;
+
+				// arrays of descriptors
+				uint32_t type = pointer.operands[1];
+				if (m_types[type].opcode == SPIRV_OP_TYPE_ARRAY) {
+					binding.count = m_constants[m_types[type].operands[1]];
+					type = m_types[type].operands[0];
+				}
+				else if (m_types[type].opcode == SPIRV_OP_TYPE_RUNTIME_ARRAY) {
+					binding.count = 0;
+					type = m_types[type].operands[0];
+				}
+				binding.typeName = m_names[type];
+
+				SpirvType& descriptor = m_types[type];
+				switch (descriptor.opcode) {
+				case SPIRV_OP_TYPE_STRUCT:
+					if (storage == SPIRV_STORAGE_STORAGE_BUFFER || m_decorations[type].count(SPIRV_DECORATION_BUFFER_BLOCK)) {
+						binding.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+					}
+					else {
+						binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+					}
+					reflectMembers(type, binding);
+					break;
+				case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+					binding.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+					break;
+				case SPIRV_OP_TYPE_SAMPLER:
+					binding.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+					break;
+				case SPIRV_OP_TYPE_IMAGE: {
+					uint32_t dim = descriptor.operands[1];
+					bool sampled = descriptor.operands[5] == 1;
+					if (dim == SPIRV_DIM_BUFFER) {
+						binding.type = sampled ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+					}
+					else if (dim == SPIRV_DIM_SUBPASS_DATA) {
+						binding.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+					}
+					else {
+						binding.type = sampled ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+					}
+					break;
+				}
+				case SPIRV_OP_TYPE_ACCELERATION_STRUCTURE:
+					binding.type = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+					break;
+				default:
+					continue;
+				}
+
+				m_bindings.push_back(binding);
+			}
+
+			std::sort(m_bindings.begin(), m_bindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+				return a.set < b.set || (a.set == b.set && a.binding < b.binding);
+			});
+			return true;
+		}
+
+		uint32_t ShaderReflection::typeSize(uint32_t type) {
+			SpirvType& spirvType = m_types[type];
+			switch (spirvType.opcode) {
+			case SPIRV_OP_TYPE_BOOL:
+				return 4;
+			case SPIRV_OP_TYPE_INT:
+			case SPIRV_OP_TYPE_FLOAT:
+				return spirvType.operands[0] / 8;
+			case SPIRV_OP_TYPE_VECTOR:
+			case SPIRV_OP_TYPE_MATRIX:
+				return typeSize(spirvType.operands[0]) * spirvType.operands[1];
+			case SPIRV_OP_TYPE_ARRAY: {
+				uint32_t length = m_constants[spirvType.operands[1]];
+				if (m_decorations[type].count(SPIRV_DECORATION_ARRAY_STRIDE)) {
+					return m_decorations[type][SPIRV_DECORATION_ARRAY_STRIDE] * length;
+				}
+				return typeSize(spirvType.operands[0]) * length;
+			}
+			case SPIRV_OP_TYPE_STRUCT: {
+				ReflectedBinding block;
+				reflectMembers(type, block);
+				return block.blockSize;
+			}
+			default:
+				return 0;
+			}
+		}
+
+		void ShaderReflection::reflectMembers(uint32_t structType, ReflectedBinding& binding) {
+			std::vector<uint32_t> memberTypes = m_types[structType].operands;
+			binding.members.clear();
+			binding.blockSize = 0;
+
+			for (uint32_t i = 0; i < memberTypes.size(); i++) {
+				std::map<uint32_t, uint32_t>& decorations = m_memberDecorations[structType][i];
+				ReflectedBlockMember member;
+				member.name = m_memberNames[structType][i];
+				member.offset = decorations.count(SPIRV_DECORATION_OFFSET) ? decorations[SPIRV_DECORATION_OFFSET] : 0;
+				member.matrixStride = decorations.count(SPIRV_DECORATION_MATRIX_STRIDE) ? decorations[SPIRV_DECORATION_MATRIX_STRIDE] : 0;
+
+				uint32_t type = memberTypes[i];
+				if (m_types[type].opcode == SPIRV_OP_TYPE_ARRAY || m_types[type].opcode == SPIRV_OP_TYPE_RUNTIME_ARRAY) {
+					member.arraySize = m_types[type].opcode == SPIRV_OP_TYPE_ARRAY ? m_constants[m_types[type].operands[1]] : 0;
+					member.arrayStride = m_decorations[type].count(SPIRV_DECORATION_ARRAY_STRIDE) ? m_decorations[type][SPIRV_DECORATION_ARRAY_STRIDE] : 0;
+					type = m_types[type].operands[0];
+				}
+
+				uint32_t elementSize = typeSize(type);
+				if (m_types[type].opcode == SPIRV_OP_TYPE_MATRIX) {
+					member.columns = m_types[type].operands[1];
+					if (member.matrixStride > 0) {
+						elementSize = member.matrixStride * member.columns;
+					}
+				}
+
+				if (member.arrayStride > 0) {
+					member.size = member.arrayStride * member.arraySize;
+				}
+				else {
+					member.size = elementSize * member.arraySize;
+				}
+
+				binding.blockSize = std::max(binding.blockSize, member.offset + member.size);
+				binding.members.push_back(member);
+			}
+		}
+
+		const std::vector<ReflectedBinding>& ShaderReflection::getBindings() const {
+			return m_bindings;
+		}
+
+		const ReflectedBinding* ShaderReflection::getBinding(uint32_t set, uint32_t binding) const {
+			for (const ReflectedBinding& reflected : m_bindings) {
+				if (reflected.set == set && reflected.binding == binding) {
+					return &reflected;
+				}
+			}
+			return nullptr;
+		}
+
+		const ReflectedBinding* ShaderReflection::getBinding(const std::string& name) const {
+			for (const ReflectedBinding& reflected : m_bindings) {
+				if (reflected.name == name || reflected.typeName == name) {
+					return &reflected;
+				}
+			}
+			return nullptr;
+		}
+
+		std::vector<ReflectedBinding> ShaderReflection::merge(const std::vector<const ShaderReflection*>& reflections) {
+			std::vector<ReflectedBinding> merged;
+			for (const ShaderReflection* reflection : reflections) {
+				for (const ReflectedBinding& binding : reflection->getBindings()) {
+					auto existing = std::find_if(merged.begin(), merged.end(), [&binding](const ReflectedBinding& b) {
+						return b.set == binding.set && b.binding == binding.binding;
+					});
+					if (existing != merged.end()) {
+						existing->stage |= binding.stage;
+					}
+					else {
+						merged.push_back(binding);
+					}
+				}
+			}
+
+			std::sort(merged.begin(), merged.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+				return a.set < b.set || (a.set == b.set && a.binding < b.binding);
+			});
+			return merged;
+		}
+
+		std::vector<VkDescriptorSetLayoutBinding> ShaderReflection::getLayoutBindings(const std::vector<ReflectedBinding>& bindings, uint32_t set) {
+			std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+			for (const ReflectedBinding& binding : bindings) {
+				if (binding.set != set) {
+					continue;
+				}
+				layoutBindings.push_back({
+					binding.binding,
+					binding.type,
+					binding.count,
+					binding.stage,
+					nullptr
+					});
+			}
+			return layoutBindings;
+		}
+	}
+}
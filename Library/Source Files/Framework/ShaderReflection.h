@@ -0,0 +1,117 @@
+#pragma once
+
+#include "AllHeaders.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace LavaCake {
+  namespace Framework {
+
+		struct ReflectedBlockMember {
+			std::string																				name;
+			uint32_t																					offset = 0;						// offset in bytes from the start of the block
+			uint32_t																					size = 0;							// size in bytes, array and matrix strides included
+			uint32_t																					arraySize = 1;				// number of elements for arrays, 0 for runtime arrays
+			uint32_t																					arrayStride = 0;
+			uint32_t																					columns = 1;					// number of columns for matrices
+			uint32_t																					matrixStride = 0;
+		};
+
+		struct ReflectedBinding {
+			std::string																				name;									// name of the variable in the shader
+			std::string																				typeName;							// name of the block or of the type of the variable
+			uint32_t																					set = 0;
+			uint32_t																					binding = 0;
+			VkDescriptorType																	type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+			uint32_t																					count = 1;						// number of descriptors, 0 for runtime arrays
+			VkShaderStageFlags																stage = 0;
+			uint32_t																					blockSize = 0;				// size in bytes of uniform and storage blocks
+			std::vector<ReflectedBlockMember>									members;							// members of uniform and storage blocks, with their std140 / std430 offsets
+
+			/**
+			 \brief Find a member of the block by name
+			 \param memberName : the name of the member
+			 \return a pointer to the member, nullptr if it does not exist
+			*/
+			const ReflectedBlockMember* getMember(const std::string& memberName) const {
+				for (const ReflectedBlockMember& member : members) {
+					if (member.name == memberName) {
+						return &member;
+					}
+				}
+				return nullptr;
+			}
+		};
+
+  /**
+   Class ShaderReflection :
+   \brief Read the descriptor bindings used by a SPIR-V module : set, binding, descriptor type, array size and, for blocks, the offsets of their members.
+   Only the decorations and types are read, names are available if the module was not stripped of its debug information.
+   */
+		class ShaderReflection {
+		public:
+
+			/**
+			 \brief Parse a SPIR-V module
+			 \param spirv : the SPIR-V binary
+			 \param stage : the shader stage of the module, reported in the bindings
+			 \return true if the module could be parsed
+			*/
+			bool reflect(const std::vector<unsigned char>& spirv, VkShaderStageFlags stage);
+
+			/**
+			 \brief Return the bindings used by the module
+			 \return a vector of ReflectedBinding sorted by set and binding
+			*/
+			const std::vector<ReflectedBinding>& getBindings() const;
+
+			/**
+			 \brief Find a binding by set and binding number
+			 \return a pointer to the binding, nullptr if it does not exist
+			*/
+			const ReflectedBinding* getBinding(uint32_t set, uint32_t binding) const;
+
+			/**
+			 \brief Find a binding by the name of its variable or of its block
+			 \return a pointer to the binding, nullptr if it does not exist
+			*/
+			const ReflectedBinding* getBinding(const std::string& name) const;
+
+			/**
+			 \brief Merge the bindings of several stages, the stage flags of bindings shared by several stages are combined
+			 \param reflections : the reflections of the stages
+			 \return the merged bindings, sorted by set and binding
+			*/
+			static std::vector<ReflectedBinding> merge(const std::vector<const ShaderReflection*>& reflections);
+
+			/**
+			 \brief Convert bindings to descriptor set layout bindings
+			 \param bindings : the reflected bindings
+			 \param set : the descriptor set to keep
+			 \return the layout bindings of this set
+			*/
+			static std::vector<VkDescriptorSetLayoutBinding> getLayoutBindings(const std::vector<ReflectedBinding>& bindings, uint32_t set = 0);
+
+		private :
+
+			struct SpirvType {
+				uint32_t																				opcode = 0;
+				std::vector<uint32_t>														operands;
+			};
+
+			uint32_t typeSize(uint32_t type);
+			void reflectMembers(uint32_t structType, ReflectedBinding& binding);
+
+			std::map<uint32_t, SpirvType>											m_types;
+			std::map<uint32_t, uint32_t>											m_constants;
+			std::map<uint32_t, std::string>										m_names;
+			std::map<uint32_t, std::map<uint32_t, std::string>>	m_memberNames;
+			std::map<uint32_t, std::map<uint32_t, uint32_t>>	m_decorations;
+			std::map<uint32_t, std::map<uint32_t, std::map<uint32_t, uint32_t>>>	m_memberDecorations;
+
+			std::vector<ReflectedBinding>											m_bindings;
+		};
+	}
+}
@@ -0,0 +1,146 @@
+#include "StagingRing.h"
+
+namespace LavaCake {
+  namespace Framework {
+
+		StagingRing::StagingRing(Queue* queue, VkDeviceSize size) {
+			m_queue = queue;
+			m_size = size;
+			m_buffer.allocate(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VkMemoryPropertyFlagBits(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+			m_mapped = static_cast<char*>(m_buffer.map());
+		}
+
+		StagingRange StagingRing::reserve(VkDeviceSize size, VkDeviceSize alignment) {
+			StagingRange range;
+
+			if (size + alignment > m_size) {
+				Buffer* oversized = new Buffer();
+				oversized->allocate(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VkMemoryPropertyFlagBits(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+				getCommandBuffer();
+				m_current.oversized.push_back(oversized);
+				range.buffer = oversized;
+				range.offset = 0;
+				range.data = oversized->map();
+				return range;
+			}
+
+			while (true) {
+				// head == tail only happens when the ring is empty, a full ring always keeps at least one byte between them
+				if (m_head == m_tail) {
+					m_head = 0;
+					m_tail = 0;
+				}
+
+				VkDeviceSize offset = (m_head + alignment - 1) / alignment * alignment;
+				if (m_head >= m_tail) {
+					if (offset + size <= m_size) {
+						m_head = offset + size;
+						break;
+					}
+					if (size < m_tail) {
+						offset = 0;
+						m_head = size;
+						break;
+					}
+				}
+				else if (offset + size < m_tail) {
+					m_head = offset + size;
+					break;
+				}
+
+				// not enough room : send what is recorded and reclaim the space of the oldest batch
+				if (m_recording) {
+					submit();
+				}
+				wait(m_inFlight.front().ticket);
+			}
+
+			range.buffer = &m_buffer;
+			range.offset = m_head - size;
+			range.data = m_mapped + range.offset;
+			return range;
+		}
+
+		CommandBuffer& StagingRing::getCommandBuffer() {
+			if (!m_recording) {
+				if (m_freeCommandBuffers.size() > 0) {
+					m_current.commandBuffer = m_freeCommandBuffers.back();
+					m_freeCommandBuffers.pop_back();
+				}
+				else {
+					m_current.commandBuffer = new CommandBuffer();
+				}
+				m_current.commandBuffer->resetFence();
+				m_current.commandBuffer->beginRecord();
+				m_recording = true;
+			}
+			return *m_current.commandBuffer;
+		}
+
+		uint64_t StagingRing::submit() {
+			if (!m_recording) {
+				return m_lastTicket;
+			}
+
+			m_current.commandBuffer->endRecord();
+			m_current.commandBuffer->submit(m_queue, {}, {});
+			m_current.ticket = ++m_lastTicket;
+			m_current.end = m_head;
+			m_inFlight.push_back(m_current);
+
+			m_current = Batch();
+			m_recording = false;
+			return m_lastTicket;
+		}
+
+		bool StagingRing::isComplete(uint64_t ticket) {
+			retire();
+			return ticket <= m_completedTicket;
+		}
+
+		void StagingRing::wait(uint64_t ticket) {
+			if (ticket > m_lastTicket) {
+				submit();
+			}
+
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			while (m_inFlight.size() > 0 && m_inFlight.front().ticket <= ticket) {
+				VkResult result = vkWaitForFences(logical, 1, &m_inFlight.front().commandBuffer->getFence(), VK_TRUE, UINT64_MAX);
+				if (VK_SUCCESS != result) {
+					ErrorCheck::setError((char*)"Waiting on a staging batch failed");
+					return;
+				}
+				retire();
+			}
+		}
+
+		void StagingRing::flush() {
+			wait(submit());
+		}
+
+		Queue* StagingRing::getQueue() {
+			return m_queue;
+		}
+
+		void StagingRing::retire() {
+			VkDevice logical = Device::getDevice()->getLogicalDevice();
+			while (m_inFlight.size() > 0 && vkGetFenceStatus(logical, m_inFlight.front().commandBuffer->getFence()) == VK_SUCCESS) {
+				Batch& batch = m_inFlight.front();
+				m_tail = batch.end;
+				m_completedTicket = batch.ticket;
+				for (Buffer* buffer : batch.oversized) {
+					delete buffer;
+				}
+				m_freeCommandBuffers.push_back(batch.commandBuffer);
+				m_inFlight.pop_front();
+			}
+		}
+
+		StagingRing::~StagingRing() {
+			flush();
+			for (CommandBuffer* commandBuffer : m_freeCommandBuffers) {
+				delete commandBuffer;
+			}
+		}
+	}
+}
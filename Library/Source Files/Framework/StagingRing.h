@@ -0,0 +1,116 @@
+#pragma once
+
+#include "AllHeaders.h"
+#include "Device.h"
+#include "ErrorCheck.h"
+#include "CommandBuffer.h"
+#include "Queue.h"
+#include "Buffer.h"
+
+#include <deque>
+
+namespace LavaCake {
+  namespace Framework {
+
+  /**
+   Struct StagingRange :
+   \brief a host visible range reserved in a StagingRing
+   */
+		struct StagingRange {
+			Buffer*						buffer = nullptr;
+			VkDeviceSize			offset = 0;
+			void*							data = nullptr;
+		};
+
+  /**
+   Class StagingRing :
+   \brief A persistently mapped staging buffer used as a ring to batch uploads
+   Copies are recorded in the command buffer of the current batch, nothing is sent to the GPU before submit() is called.
+   Each submitted batch is identified by a ticket that can be polled or waited on.
+   Space is reclaimed as soon as the batches using it are completed.
+   */
+		class StagingRing {
+		public:
+
+      /**
+       \brief Create a staging ring
+       \param queue : the queue the batches will be submitted to
+       \param size : the size in byte of the ring
+       */
+			StagingRing(Queue* queue, VkDeviceSize size = 64 * 1024 * 1024);
+
+      /**
+       \brief Reserve a range of the ring, if there is not enough room the current batch is submitted and the oldest batches are waited for
+       Ranges larger than the ring get their own staging buffer, released with the batch.
+       \param size : the size in byte of the range
+       \param alignment : the alignment of the offset of the range in the staging buffer
+       \return a StagingRange containing the staging buffer, the offset of the range in it and a pointer to its mapped memory
+       */
+			StagingRange reserve(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+      /**
+       \brief Return the command buffer of the current batch, in a recording state
+       Must be called after reserve as reserve may submit the current batch
+       \return a reference to a CommandBuffer
+       */
+			CommandBuffer& getCommandBuffer();
+
+      /**
+       \brief Submit the current batch
+       \return the ticket of the batch, or the ticket of the last batch if nothing was recorded
+       */
+			uint64_t submit();
+
+      /**
+       \brief Tell if a batch has been executed
+       \param ticket : the ticket returned by submit
+       \return true if the batch is completed
+       */
+			bool isComplete(uint64_t ticket);
+
+      /**
+       \brief Wait for a batch to be executed
+       \param ticket : the ticket returned by submit
+       */
+			void wait(uint64_t ticket);
+
+      /**
+       \brief Submit the current batch and wait for every batch to be executed
+       */
+			void flush();
+
+      /**
+       \brief Return the queue the batches are submitted to
+       \return a pointer to a Queue
+       */
+			Queue* getQueue();
+
+			~StagingRing();
+
+		private :
+
+			struct Batch {
+				CommandBuffer*																	commandBuffer = nullptr;
+				uint64_t																				ticket = 0;
+				VkDeviceSize																		end = 0;
+				std::vector<Buffer*>														oversized;
+			};
+
+			void retire();
+
+			Queue*																						m_queue;
+			Buffer																						m_buffer;
+			VkDeviceSize																			m_size;
+			char*																							m_mapped = nullptr;
+			VkDeviceSize																			m_head = 0;
+			VkDeviceSize																			m_tail = 0;
+
+			Batch																							m_current;
+			bool																							m_recording = false;
+			std::deque<Batch>																	m_inFlight;
+			std::vector<CommandBuffer*>												m_freeCommandBuffers;
+			uint64_t																					m_lastTicket = 0;
+			uint64_t																					m_completedTicket = 0;
+		};
+	}
+}
@@ -10,6 +10,10 @@ namespace LavaCake {
 				VkImageUsageFlags													depth_attachment_usage
 			) {
 			Device* d = Device::getDevice();
+			if (d->isHeadless()) {
+				ErrorCheck::setError((char*)"A swapchain can not be created on a headless device");
+				return;
+			}
 			VkDevice logical = d->getLogicalDevice();
 			VkPhysicalDevice physical = d->getPhysicalDevice();
 			VkSurfaceKHR surface = d->getSurface();
@@ -187,6 +187,23 @@ namespace LavaCake {
 				return *m_swapchainImages[index];
 			}
       
+			/**
+			\brief Acquire the next image of the swapchain, signaling a semaphore owned by the caller
+			\param semaphore : the semaphore signaled when the image is available
+			\return a reference to the acquired SwapChainImage
+			*/
+			SwapChainImage& acquireImage(VkSemaphore semaphore) {
+				Device* d = Device::getDevice();
+				VkDevice logical = d->getLogicalDevice();
+				uint32_t index;
+				VkResult result = vkAcquireNextImageKHR(logical, *m_handle, 2000000000, semaphore, VK_NULL_HANDLE, &index);
+				if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+					ErrorCheck::setError((char*)"Could not acquire a swapchain image");
+				}
+				m_swapchainImages[index]->m_index = index;
+				return *m_swapchainImages[index];
+			}
+
       void presentImage(PresentationQueue* queue, SwapChainImage& image, std::vector<VkSemaphore> semaphores){
         Core::PresentInfo present_info = {
           *m_handle,                                    // VkSwapchainKHR         Swapchain
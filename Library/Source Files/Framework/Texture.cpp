@@ -100,6 +100,47 @@ namespace LavaCake {
 		}
 
 
+		void TextureBuffer::allocate(StagingRing& ring, VkPipelineStageFlagBits stageFlagBit) {
+			Framework::Device* d = LavaCake::Framework::Device::getDevice();
+			VkDevice logical = d->getLogicalDevice();
+
+			InitVkDestroyer(logical, m_sampler);
+			if (!LavaCake::Core::CreateSampler(logical, VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_NEAREST, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, 0.0f, false, 1.0f, false, VK_COMPARE_OP_ALWAYS, 0.0f, 1.0f, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, false, *m_sampler)) {
+				ErrorCheck::setError((char*)"Can't create the sampler of a texture buffer");
+			}
+
+			m_image->allocate(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+			StagingRange range = ring.reserve(m_data->size());
+			std::memcpy(range.data, m_data->data(), m_data->size());
+
+			CommandBuffer& commandBuffer = ring.getCommandBuffer();
+
+			VkImageSubresourceRange subresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+			m_image->setLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, subresourceRange);
+
+			VkImageSubresourceLayers image_subresource_layer = {
+				VK_IMAGE_ASPECT_COLOR_BIT,    // VkImageAspectFlags     aspectMask
+				0,                            // uint32_t               mipLevel
+				0,                            // uint32_t               baseArrayLayer
+				1                             // uint32_t               layerCount
+			};
+
+			VkBufferImageCopy region = {
+						range.offset,																																			// VkDeviceSize               bufferOffset
+						0,																																								// uint32_t                   bufferRowLength
+						0,																																								// uint32_t                   bufferImageHeight
+						image_subresource_layer,																													// VkImageSubresourceLayers   imageSubresource
+						{ 0, 0, 0 },																																			// VkOffset3D                 imageOffset
+						{ m_image->width(), m_image->height(), m_image->depth() },												// VkExtent3D                 imageExtent
+			};
+
+			range.buffer->copyToImage(commandBuffer, *m_image, { region });
+
+			m_image->setLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, stageFlagBit, subresourceRange);
+		}
+
 		VkSampler& TextureBuffer::getSampler() {
 			return *m_sampler;
 		}
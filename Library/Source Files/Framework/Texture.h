@@ -8,6 +8,7 @@
 #include "SwapChain.h"
 #include "CommandBuffer.h"
 #include "Image.h"
+#include "StagingRing.h"
 #include "Math/basics.h"
 
 namespace LavaCake {
@@ -48,6 +49,14 @@ namespace LavaCake {
 			*/
 			virtual void allocate(Queue* queue, CommandBuffer& cmdBuff, VkPipelineStageFlagBits stageFlagBit = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
+			/**
+			\brief allocate the Texture buffer on the GPU and record its upload in a StagingRing
+      The texture can be used once the batch returned by ring.submit() is completed
+      \param ring : the staging ring used to upload the texture
+      \param stageFlagBit : the stage where the buffer will be used, see more <a href="https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkPipelineStageFlagBits.html">here</a>
+			*/
+			void allocate(StagingRing& ring, VkPipelineStageFlagBits stageFlagBit = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
 			/**
       \brief get the sampler of the texture buffer
 			\return a VkSampler
@@ -255,9 +264,8 @@ namespace LavaCake {
 					*m_frameBuffer = VK_NULL_HANDLE;
 				}
 
-				if (VK_NULL_HANDLE != *m_imageMemory) {
-					vkFreeMemory(logical, *m_imageMemory, nullptr);
-					*m_imageMemory = VK_NULL_HANDLE;
+				for (MemoryAllocation& allocation : m_allocations) {
+					MemoryAllocator::getAllocator()->free(allocation);
 				}
 			}
 
@@ -268,7 +276,7 @@ namespace LavaCake {
 
 			VkDestroyer(VkFramebuffer)															m_frameBuffer;
 			VkDestroyer(VkSampler)																	m_sampler;
-			VkDestroyer(VkDeviceMemory)															m_imageMemory;
+			std::vector<MemoryAllocation>														m_allocations;
 			std::vector<VkImage>																		m_images;
 			std::vector<VkImageView>																m_imageViews;
 			std::vector<VkImageLayout>															m_layouts;
@@ -10,21 +10,48 @@ namespace LavaCake {
 			VkDevice logical = d->getLogicalDevice();
 			VkPhysicalDevice physical = d->getPhysicalDevice();
 
+			std::vector<std::string> names(m_variables.size());
+			for (auto& name : m_variableNames) {
+				names[name.second] = name.first;
+			}
+
 			for (uint32_t i = 0; i < m_variables.size(); i++) {
 				VkDeviceSize s = sizeof(m_variables[i][0]) * m_variables[i].size();
-				m_typeSizeOffset.push_back(std::pair<VkDeviceSize, VkDeviceSize>(s, m_bufferSize));
-				m_bufferSize += s;
+				if (!m_hasLayout) {
+					m_typeSizeOffset.push_back(std::pair<VkDeviceSize, VkDeviceSize>(s, m_bufferSize));
+					m_elementCountStride.push_back(std::pair<uint32_t, VkDeviceSize>(1, s));
+					m_bufferSize += s;
+					continue;
+				}
+
+				const ReflectedBlockMember* member = m_layout.getMember(names[i]);
+				if (member == nullptr || s > member->size) {
+					ErrorCheck::setError((char*)"The variable does not match any member of the uniform block");
+					m_typeSizeOffset.push_back(std::pair<VkDeviceSize, VkDeviceSize>(0, 0));
+					m_elementCountStride.push_back(std::pair<uint32_t, VkDeviceSize>(0, 0));
+					continue;
+				}
+
+				// tightly packed arrays and matrices are spread to the strides of the block
+				uint32_t elements = member->arraySize > 1 ? member->arraySize : member->columns;
+				VkDeviceSize stride = member->arraySize > 1 ? member->arrayStride : member->matrixStride;
+				if (s == member->size || elements <= 1 || stride == 0 || s % elements != 0) {
+					elements = 1;
+					stride = s;
+				}
+				m_typeSizeOffset.push_back(std::pair<VkDeviceSize, VkDeviceSize>(s, member->offset));
+				m_elementCountStride.push_back(std::pair<uint32_t, VkDeviceSize>(elements, stride));
+			}
+			if (m_hasLayout) {
+				m_bufferSize = m_layout.blockSize;
 			}
 
       VkPhysicalDeviceProperties* p = new  VkPhysicalDeviceProperties();
       vkGetPhysicalDeviceProperties(physical,
                                     p);
       
+      //adding empty space at the end of the buffer to match the atomic size of a buffer;
       VkDeviceSize padding = p->limits.nonCoherentAtomSize - m_bufferSize % p->limits.nonCoherentAtomSize;
-      
-      //adding empty value at the end of the buffer to match the atomic size of a buffer;
-      m_variables.push_back(std::vector<int>(padding/ sizeof(int), 0));
-      m_typeSizeOffset.push_back(std::pair<VkDeviceSize, VkDeviceSize>(padding, m_bufferSize));
       m_bufferSize+=padding;
       
       
@@ -64,12 +91,16 @@ namespace LavaCake {
 			LavaCake::Framework::Device* d = LavaCake::Framework::Device::getDevice();
 			VkDevice logical = d->getLogicalDevice();
 			VkPhysicalDevice physical = d->getPhysicalDevice();
-			std::vector<int> variable;
-			VkDeviceSize size = 0;
+			std::vector<int> variable(size_t(m_bufferSize / sizeof(int)), 0);
+			char* data = reinterpret_cast<char*>(variable.data());
 			for (uint32_t i = 0; i < m_variables.size(); i++) {
-				size += m_typeSizeOffset[i].first;
-				for (uint32_t j = 0; j < m_variables[i].size(); j++) {
-					variable.push_back(m_variables[i][j]);
+				uint32_t elements = m_elementCountStride[i].first;
+				if (elements == 0) {
+					continue;
+				}
+				VkDeviceSize elementSize = m_typeSizeOffset[i].first / elements;
+				for (uint32_t e = 0; e < elements; e++) {
+					std::memcpy(data + m_typeSizeOffset[i].second + e * m_elementCountStride[i].second, reinterpret_cast<const char*>(m_variables[i].data()) + e * elementSize, size_t(elementSize));
 				}
 			}
 
@@ -77,6 +108,15 @@ namespace LavaCake {
 			m_stagingBuffer.write(variable);
 		}
 
+		void UniformBuffer::setLayout(const ReflectedBinding& block) {
+			if (block.type != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+				ErrorCheck::setError((char*)"The layout of a UniformBuffer must be a uniform block");
+				return;
+			}
+			m_layout = block;
+			m_hasLayout = true;
+		}
+
 		void UniformBuffer::addArray(std::string name, std::vector<int>& value) {
 			if (m_variableNames.find(name) != m_variableNames.end()) {
 				ErrorCheck::setError((char*)"The variable allready exist in this UniformBuffer");
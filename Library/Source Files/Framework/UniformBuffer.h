@@ -8,13 +8,31 @@
 #include "Device.h"
 #include "VulkanDestroyer.h"
 #include "Buffer.h"
-#include "UniformBuffer.h"
+#include "ShaderReflection.h"
 
 namespace LavaCake {
   namespace Framework{
     class UniformBuffer {
     public :
 
+      UniformBuffer() {};
+
+      /**
+       \brief Create a uniform buffer laid out as a block of a shader, see setLayout
+       \param block : the reflected uniform block
+       */
+      UniformBuffer(const ReflectedBinding& block) {
+        setLayout(block);
+      };
+
+      /**
+       \brief Lay the variables out as the members of a uniform block of a shader instead of packing them one after the other.
+       Each variable is written at the std140 offset of the member of the same name, arrays and matrices are spread to the member strides when their elements are packed.
+       Must be called before end.
+       \param block : the reflected uniform block, see ShaderModule::getReflection
+       */
+      void setLayout(const ReflectedBinding& block);
+
 
       template<typename T>
       void addVariable(std::string name, T value) {
@@ -59,6 +77,9 @@ namespace LavaCake {
       std::vector<std::vector<int>>                             m_variables;
       std::vector<bool>                                         m_modified;
       std::vector<std::pair<VkDeviceSize, VkDeviceSize>>        m_typeSizeOffset ;
+      std::vector<std::pair<uint32_t, VkDeviceSize>>            m_elementCountStride;
+      ReflectedBinding                                          m_layout;
+      bool                                                      m_hasLayout = false;
     };
   }
 }
\ No newline at end of file
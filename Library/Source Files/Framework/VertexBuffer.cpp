@@ -25,11 +25,37 @@ namespace LavaCake {
 			swapMeshes(m);
 		};
 
+		VertexBuffer::VertexBuffer(std::shared_ptr<LavaCake::Geometry::MeshFile> file, uint32_t binding, VkVertexInputRate inputRate) {
+
+			m_file = file;
+			m_topology = LavaCake::Geometry::TRIANGLE;
+			m_indexed = file->isIndexed();
+
+			LavaCake::Geometry::vertexFormat format = file->getFormat();
+			m_stride = (uint32_t)format.size();
+			m_attributeDescriptions = format.VkDescription();
+
+			for (size_t t = 0; t < m_attributeDescriptions.size(); t++) {
+				m_attributeDescriptions[t].binding = binding;
+			}
+
+			m_bindingDescriptions.push_back(
+				{
+							binding,
+							uint32_t(m_stride * sizeof(float)),
+							inputRate
+				});
+		};
+
 		void VertexBuffer::allocate(Queue* queue, CommandBuffer& cmdBuff, VkBufferUsageFlags otherUsage) {
 			LavaCake::Framework::Device* d = LavaCake::Framework::Device::getDevice();
 			VkDevice logicalDevice = d->getLogicalDevice();
 			VkPhysicalDevice physicalDevice = d->getPhysicalDevice();
 
+			if (m_file && m_vertices.size() == 0) {
+				m_vertices = std::vector<float>(m_file->vertices(), m_file->vertices() + m_file->vertexCount());
+				m_indices = std::vector<uint32_t>(m_file->indices(), m_file->indices() + m_file->indexCount());
+			}
 			if (m_vertices.size() == 0)return;
 
 			m_vertexBuffer.allocate(queue, cmdBuff, m_vertices, (VkBufferUsageFlagBits)(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT| otherUsage), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_FORMAT_R32_SFLOAT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
@@ -43,6 +69,26 @@ namespace LavaCake {
 
 		
 		
+		void VertexBuffer::allocate(StagingRing& ring, VkBufferUsageFlags otherUsage) {
+			if (m_file) {
+				if (m_file->vertexCount() == 0)return;
+
+				m_vertexBuffer.allocate(ring, m_file->vertices(), m_file->vertexCount() * sizeof(float), (VkBufferUsageFlagBits)(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | otherUsage), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_FORMAT_R32_SFLOAT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+
+				if (m_indexed) {
+					m_indexBuffer.allocate(ring, m_file->indices(), m_file->indexCount() * sizeof(uint32_t), (VkBufferUsageFlagBits)(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | otherUsage), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_FORMAT_R32_UINT, VK_ACCESS_INDEX_READ_BIT);
+				}
+				return;
+			}
+			if (m_vertices.size() == 0)return;
+
+			m_vertexBuffer.allocate(ring, m_vertices, (VkBufferUsageFlagBits)(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | otherUsage), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_FORMAT_R32_SFLOAT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+
+			if (m_indexed) {
+				m_indexBuffer.allocate(ring, m_indices, (VkBufferUsageFlagBits)(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | otherUsage), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_FORMAT_R32_UINT, VK_ACCESS_INDEX_READ_BIT);
+			}
+		}
+
 		Buffer& VertexBuffer::getVertexBuffer() {
 			return m_vertexBuffer;
 		}
@@ -66,6 +112,7 @@ namespace LavaCake {
 		
 		void VertexBuffer::swapMeshes(std::vector<LavaCake::Geometry::Mesh_t*>				m) {
 			if (m_topology == m[0]->getTopology()) {
+				m_file = nullptr;
 				m_vertices = std::vector<float>(m[0]->vertices());
 				m_indices = std::vector<uint32_t>(m[0]->indices());
 
@@ -4,7 +4,9 @@
 #include "Queue.h"
 #include "Device.h"
 #include "Geometry/mesh.h"
+#include "Geometry/meshFile.h"
 #include "Buffer.h"
+#include "StagingRing.h"
 
 namespace LavaCake {
 	namespace Framework {
@@ -14,8 +16,15 @@ namespace LavaCake {
 			
 			VertexBuffer(std::vector<LavaCake::Geometry::Mesh_t*> m, uint32_t binding = 0,  VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX);
 
+			/**
+			 *\brief Create a vertex buffer from a mapped mesh file, the file is kept mapped and allocate(StagingRing&) uploads straight from it
+			 */
+			VertexBuffer(std::shared_ptr<LavaCake::Geometry::MeshFile> file, uint32_t binding = 0, VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX);
+
 
 			void allocate(Queue* queue, CommandBuffer& cmdBuff, VkBufferUsageFlags otherUsage = VkBufferUsageFlags(0) );
+
+			void allocate(StagingRing& ring, VkBufferUsageFlags otherUsage = VkBufferUsageFlags(0));
 			
 			Buffer& getVertexBuffer();
 			
@@ -65,11 +74,11 @@ namespace LavaCake {
 			}
 
 			size_t getIndicesNumber() {
-				return m_indices.size();
+				return m_file ? m_file->indexCount() : m_indices.size();
 			}
 
 			size_t getVerticiesNumber() {
-				return m_vertices.size() / m_stride;
+				return (m_file ? m_file->vertexCount() : m_vertices.size()) / m_stride;
 			}
 			
 			uint32_t getStrideSize() {
@@ -99,6 +108,7 @@ namespace LavaCake {
 			std::vector<uint32_t>																m_indices;
 			bool																								m_indexed;
 			LavaCake::Geometry::topology												m_topology;
+			std::shared_ptr<LavaCake::Geometry::MeshFile>				m_file;
 		};
 
 	}
@@ -1,5 +1,6 @@
 #pragma once
 #include "format.h"
+#include "Math/basics.h"
 namespace LavaCake {
   namespace Geometry {
   
@@ -193,5 +194,30 @@ namespace LavaCake {
       return m;
     }
 
+  /**
+   *\brief Transform in place the positions and the normals of a mesh, the other attributes are left unchanged
+   *\param m the mesh to transform
+   *\param matrix the transformation applied to the positions, the normals are transformed by its normal matrix
+   */
+    static void transformMesh(Mesh_t* m, mat4 const& matrix) {
+      size_t vertexSize = m->vertexSize();
+      if (vertexSize == 0 || m->vertices().size() < vertexSize) {
+        return;
+      }
+      size_t count = m->vertices().size() / vertexSize;
+
+      vertexFormat format = m->getFormat();
+      size_t offset = 0;
+      for (primitiveFormat f : format.description()) {
+        if (f == POS3) {
+          transformPositions(matrix, m->vertices().data() + offset, count, vertexSize);
+        }
+        else if (f == NORM3) {
+          transformNormals(matrix, m->vertices().data() + offset, count, vertexSize);
+        }
+        offset += toSize(f);
+      }
+    }
+
   }
 }
@@ -0,0 +1,210 @@
+#include "meshFile.h"
+#include "Helpers/JobSystem.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace LavaCake {
+  namespace Geometry {
+
+    namespace {
+
+      const uint64_t hashChunkSize = 1 << 22;
+      const uint64_t fnvPrime = 0x100000001b3ull;
+      const uint64_t fnvOffset = 0xcbf29ce484222325ull;
+
+      // FNV-1a on 8 bytes words, the tail is hashed byte by byte
+      uint64_t hashRange(const unsigned char* data, size_t size, uint64_t hash) {
+        size_t words = size / 8;
+        for (size_t i = 0; i < words; i++) {
+          uint64_t word;
+          std::memcpy(&word, data + 8 * i, 8);
+          hash = (hash ^ word) * fnvPrime;
+        }
+        for (size_t i = 8 * words; i < size; i++) {
+          hash = (hash ^ data[i]) * fnvPrime;
+        }
+        return hash;
+      }
+
+      uint64_t alignOffset(uint64_t offset) {
+        return (offset + 63) & ~uint64_t(63);
+      }
+    }
+
+    uint64_t HashFileContent(const void* data, size_t size) {
+      const unsigned char* bytes = static_cast<const unsigned char*>(data);
+      size_t chunkCount = size_t((size + hashChunkSize - 1) / hashChunkSize);
+      std::vector<uint64_t> chunkHashes(chunkCount);
+      Helpers::JobSystem::getJobSystem()->parallelFor(0, chunkCount, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+          size_t first = size_t(c * hashChunkSize);
+          size_t length = size - first < hashChunkSize ? size - first : size_t(hashChunkSize);
+          chunkHashes[c] = hashRange(bytes + first, length, fnvOffset);
+        }
+      });
+      uint64_t sizeValue = uint64_t(size);
+      uint64_t hash = hashRange(reinterpret_cast<const unsigned char*>(&sizeValue), sizeof(uint64_t), fnvOffset);
+      return hashRange(reinterpret_cast<const unsigned char*>(chunkHashes.data()), chunkHashes.size() * sizeof(uint64_t), hash);
+    }
+
+    bool WriteMeshFile(const std::string& path, const std::vector<float>& vertices, const std::vector<uint32_t>& indices, vertexFormat format,
+      bool indexed, uint64_t sourceHash, uint64_t sourceSize, uint32_t options) {
+      std::vector<primitiveFormat>& description = format.description();
+      MeshFileHeader header = {};
+      if (description.size() > sizeof(header.attributes) / sizeof(uint32_t)) {
+        std::cout << "Could not write " << path << ", the vertex format has too many attributes" << std::endl;
+        return false;
+      }
+
+      if (format.size() > 0 ? vertices.size() % format.size() != 0 : vertices.size() != 0) {
+        std::cout << "Could not write " << path << ", the vertices do not match the vertex format" << std::endl;
+        return false;
+      }
+
+      header.magic = meshFileMagic;
+      header.version = meshFileVersion;
+      header.sourceHash = sourceHash;
+      header.sourceSize = sourceSize;
+      header.options = options;
+      header.indexed = indexed ? 1 : 0;
+      header.attributeCount = uint32_t(description.size());
+      for (size_t a = 0; a < description.size(); a++) {
+        header.attributes[a] = uint32_t(description[a]);
+      }
+
+      // the bounds of the POS3 or POS2 attribute, they stay at zero when the format has no position
+      size_t stride = format.size();
+      size_t count = stride > 0 ? vertices.size() / stride : 0;
+      size_t position = 0;
+      size_t dimension = 0;
+      for (primitiveFormat f : description) {
+        if (f == POS3 || f == POS2) {
+          dimension = toSize(f);
+          break;
+        }
+        position += toSize(f);
+      }
+      if (dimension == 0) {
+        count = 0;
+      }
+      for (size_t i = 0; i < dimension && count > 0; i++) {
+        header.boundsMin[i] = vertices[position + i];
+        header.boundsMax[i] = header.boundsMin[i];
+      }
+      for (size_t v = 0; v < count; v++) {
+        for (size_t i = 0; i < dimension; i++) {
+          header.boundsMin[i] = std::min(header.boundsMin[i], vertices[v * stride + position + i]);
+          header.boundsMax[i] = std::max(header.boundsMax[i], vertices[v * stride + position + i]);
+        }
+      }
+
+      header.vertexCount = vertices.size();
+      header.indexCount = indexed ? indices.size() : 0;
+      header.vertexOffset = alignOffset(sizeof(MeshFileHeader));
+      header.indexOffset = alignOffset(header.vertexOffset + header.vertexCount * sizeof(float));
+
+      std::string temporary = path + ".tmp";
+      {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        const char padding[64] = {};
+        bool written = bool(file.write(reinterpret_cast<const char*>(&header), sizeof(MeshFileHeader)));
+        written = written && file.write(padding, std::streamsize(header.vertexOffset - sizeof(MeshFileHeader)));
+        written = written && file.write(reinterpret_cast<const char*>(vertices.data()), std::streamsize(header.vertexCount * sizeof(float)));
+        written = written && file.write(padding, std::streamsize(header.indexOffset - header.vertexOffset - header.vertexCount * sizeof(float)));
+        written = written && file.write(reinterpret_cast<const char*>(indices.data()), std::streamsize(header.indexCount * sizeof(uint32_t)));
+        if (!written) {
+          std::cout << "Could not write " << path << std::endl;
+          file.close();
+          std::remove(temporary.c_str());
+          return false;
+        }
+      }
+
+      std::remove(path.c_str());
+      if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cout << "Could not write " << path << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+      }
+      return true;
+    }
+
+    bool MeshFile::open(const std::string& path) {
+      m_header = {};
+      if (!m_file.open(path)) {
+        return false;
+      }
+
+      MeshFileHeader header;
+      if (m_file.size() < sizeof(MeshFileHeader)) {
+        std::cout << "Invalid mesh file " << path << std::endl;
+        m_file.close();
+        return false;
+      }
+      std::memcpy(&header, m_file.data(), sizeof(MeshFileHeader));
+      bool valid = header.magic == meshFileMagic && header.version == meshFileVersion &&
+        header.attributeCount <= sizeof(header.attributes) / sizeof(uint32_t) &&
+        header.vertexOffset % sizeof(float) == 0 && header.indexOffset % sizeof(uint32_t) == 0 &&
+        header.vertexOffset <= m_file.size() && header.vertexCount <= (m_file.size() - header.vertexOffset) / sizeof(float) &&
+        header.indexOffset <= m_file.size() && header.indexCount <= (m_file.size() - header.indexOffset) / sizeof(uint32_t);
+      size_t stride = 0;
+      for (uint32_t a = 0; valid && a < header.attributeCount; a++) {
+        valid = header.attributes[a] <= F4;
+        stride += valid ? toSize(primitiveFormat(header.attributes[a])) : 0;
+      }
+      // the vertices must be whole vertices of the format
+      valid = valid && (stride > 0 ? header.vertexCount % stride == 0 : header.vertexCount == 0);
+      if (!valid) {
+        std::cout << "Invalid mesh file " << path << std::endl;
+        m_file.close();
+        return false;
+      }
+      m_header = header;
+      return true;
+    }
+
+    bool MeshFile::matches(uint64_t sourceHash, uint64_t sourceSize, uint32_t options) const {
+      return m_file.data() != nullptr && m_header.sourceHash == sourceHash && m_header.sourceSize == sourceSize && m_header.options == options;
+    }
+
+    const float* MeshFile::vertices() const {
+      return reinterpret_cast<const float*>(static_cast<const char*>(m_file.data()) + m_header.vertexOffset);
+    }
+
+    size_t MeshFile::vertexCount() const {
+      return size_t(m_header.vertexCount);
+    }
+
+    const uint32_t* MeshFile::indices() const {
+      return reinterpret_cast<const uint32_t*>(static_cast<const char*>(m_file.data()) + m_header.indexOffset);
+    }
+
+    size_t MeshFile::indexCount() const {
+      return size_t(m_header.indexCount);
+    }
+
+    bool MeshFile::isIndexed() const {
+      return m_header.indexed != 0;
+    }
+
+    vertexFormat MeshFile::getFormat() const {
+      std::vector<primitiveFormat> description;
+      for (uint32_t a = 0; a < m_header.attributeCount; a++) {
+        description.push_back(primitiveFormat(m_header.attributes[a]));
+      }
+      return vertexFormat(description);
+    }
+
+    vec3f MeshFile::getMin() const {
+      return vec3f({ m_header.boundsMin[0], m_header.boundsMin[1], m_header.boundsMin[2] });
+    }
+
+    vec3f MeshFile::getMax() const {
+      return vec3f({ m_header.boundsMax[0], m_header.boundsMax[1], m_header.boundsMax[2] });
+    }
+  }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "format.h"
+#include "Helpers/MappedFile.h"
+#include "Math/basics.h"
+
+#include <string>
+#include <vector>
+
+namespace LavaCake {
+  namespace Geometry {
+
+  /**
+   *\brief Struct MeshFileHeader : header of a binary mesh file, followed by the vertices and the indices at 64 bytes aligned offsets
+   */
+    struct MeshFileHeader {
+      uint32_t  magic;
+      uint32_t  version;
+      uint64_t  sourceHash;         // hash of the file the mesh was built from, see HashFileContent
+      uint64_t  sourceSize;         // size in byte of that file
+      uint32_t  options;            // how the mesh was built from the source, defined by the loader
+      uint32_t  indexed;
+      uint32_t  attributeCount;
+      uint32_t  attributes[12];     // the primitiveFormat of each attribute of a vertex
+      float     boundsMin[3];
+      float     boundsMax[3];
+      uint64_t  vertexCount;        // number of floats
+      uint64_t  indexCount;
+      uint64_t  vertexOffset;       // offset in byte from the start of the file
+      uint64_t  indexOffset;
+    };
+
+    const uint32_t meshFileMagic = 0x534d434c; // "LCMS"
+    const uint32_t meshFileVersion = 1;
+
+  /**
+   *\brief Hash the content of a file to detect that a mesh file is out of date, large files are hashed in parallel by the job system
+   *\param data the content of the file
+   *\param size the size in byte of the content
+   *\return a 64 bits hash, independent of the number of threads
+   */
+    uint64_t HashFileContent(const void* data, size_t size);
+
+  /**
+   *\brief Write a binary mesh file, the file is written next to its final path and renamed so a reader never maps a partial file
+   *\param path the path of the file
+   *\param vertices the interleaved vertices
+   *\param indices the indices, ignored if the mesh is not indexed
+   *\param format the vertex format
+   *\param indexed whether the mesh is indexed
+   *\param sourceHash the hash of the source file
+   *\param sourceSize the size of the source file
+   *\param options the options the mesh was built with
+   *\return true if the file could be written
+   */
+    bool WriteMeshFile(const std::string& path, const std::vector<float>& vertices, const std::vector<uint32_t>& indices, vertexFormat format,
+      bool indexed, uint64_t sourceHash, uint64_t sourceSize, uint32_t options);
+
+  /**
+   *\brief Class MeshFile : a binary mesh file mapped read only, the vertices and indices are read in place
+   * They can be uploaded straight from the mapping with Buffer::allocate(StagingRing&, const void*, ...), or through a VertexBuffer created from the file.
+   */
+    class MeshFile {
+    public :
+
+      MeshFile() {};
+
+      /**
+       *\brief Map a mesh file and check its header
+       *\param path the path of the file
+       *\return true if the file is a valid mesh file
+       */
+      bool open(const std::string& path);
+
+      /**
+       *\brief Return whether the file was built from a given source with given options
+       */
+      bool matches(uint64_t sourceHash, uint64_t sourceSize, uint32_t options) const;
+
+      const float* vertices() const;
+      size_t vertexCount() const;
+      const uint32_t* indices() const;
+      size_t indexCount() const;
+      bool isIndexed() const;
+
+      /**
+       *\brief Return the vertex format of the mesh
+       */
+      vertexFormat getFormat() const;
+
+      /**
+       *\brief Return the bounds of the POS3 or POS2 attribute of the mesh, zero if the format has no position
+       */
+      vec3f getMin() const;
+      vec3f getMax() const;
+
+    private :
+      Helpers::MappedFile   m_file;
+      MeshFileHeader        m_header = {};
+    };
+
+  }
+}
@@ -1,8 +1,13 @@
 #pragma once
 #include "mesh.h"
+#include "objParser.h"
+#include "meshFile.h"
+#include "Helpers/JobSystem.h"
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
 
 namespace LavaCake {
   namespace Geometry {
@@ -74,275 +79,264 @@ namespace LavaCake {
 			}
 		}
     
+		// below this number of vertices the loops run on the calling thread
+		static const size_t loaderGrain = 65536;
+
+		// center the positions of an interleaved vertex array on the origin and scale them to fit in [-1, 1]
+		static void UnifyPositions(std::vector<float>& mesh, size_t stride) {
+			size_t count = mesh.size() / stride;
+			if (count == 0) {
+				return;
+			}
+
+			vec3f minimum = vec3f({ mesh[0], mesh[1], mesh[2] });
+			vec3f maximum = minimum;
+			std::mutex mutex;
+			Helpers::JobSystem::getJobSystem()->parallelFor(0, count, loaderGrain, [&](size_t begin, size_t end) {
+				vec3f localMin = vec3f({ mesh[begin * stride], mesh[begin * stride + 1], mesh[begin * stride + 2] });
+				vec3f localMax = localMin;
+				for (size_t v = begin; v < end; v++) {
+					for (size_t i = 0; i < 3; i++) {
+						localMin[i] = std::min(localMin[i], mesh[v * stride + i]);
+						localMax[i] = std::max(localMax[i], mesh[v * stride + i]);
+					}
+				}
+				std::lock_guard<std::mutex> lock(mutex);
+				for (size_t i = 0; i < 3; i++) {
+					minimum[i] = std::min(minimum[i], localMin[i]);
+					maximum[i] = std::max(maximum[i], localMax[i]);
+				}
+			});
+
+			vec3f offset = 0.5f * (minimum + maximum);
+			float scale = std::max(std::max(maximum[0] - offset[0], maximum[1] - offset[1]), maximum[2] - offset[2]);
+			scale = scale > 0.0f ? 1.0f / scale : 1.0f;
+			Helpers::JobSystem::getJobSystem()->parallelFor(0, count, loaderGrain, [&](size_t begin, size_t end) {
+				for (size_t v = begin; v < end; v++) {
+					for (size_t i = 0; i < 3; i++) {
+						mesh[v * stride + i] = scale * (mesh[v * stride + i] - offset[i]);
+					}
+				}
+			});
+		}
+
+		// flags of the loader options stored in the mesh files
+		enum meshCacheOption {
+			CACHE_NORMAL = 1,
+			CACHE_UV = 2,
+			CACHE_TANGENT = 4,
+			CACHE_UNIFY = 8,
+			CACHE_INDEXED = 16
+		};
+
+		// the mesh file built from an OBJ file with given options, next to it
+		static std::string MeshCachePath(const std::string& filename, uint32_t options) {
+			return filename + "." + std::to_string(options) + ".lcmesh";
+		}
+
+		// map the mesh file of an OBJ file if it is up to date, the hash and size of the OBJ file are returned to write a new one otherwise
+		static bool OpenMeshCache(const std::string& filename, uint32_t options, MeshFile& cache, uint64_t& sourceHash, uint64_t& sourceSize) {
+			Helpers::MappedFile source;
+			if (!source.open(filename)) {
+				return false;
+			}
+			sourceSize = source.size();
+			sourceHash = HashFileContent(source.data(), source.size());
+
+			std::string path = MeshCachePath(filename, options);
+			return std::ifstream(path).good() && cache.open(path) && cache.matches(sourceHash, sourceSize, options);
+		}
+
+		/**
+		 *\brief Load an OBJ file as a triangle list
+		 *\param use_cache if true the mesh file written next to the OBJ file is used when it is up to date, and written otherwise.
+		 * The vertices are still copied out of it, see LoadMeshFileFromObjFile to read them in place
+		 */
 		std::pair < std::vector<float>, vertexFormat  > Load3DModelFromObjFile(std::string filename,
 			bool				 load_normal,
 			bool				 load_uv,
 			bool         generate_tangent_space_vectors,
-			bool         unify)
+			bool         unify,
+			bool         use_cache = false)
 		{
-			// Load model
-			tinyobj::attrib_t                attribs;
-			std::vector<tinyobj::shape_t>    shapes;
-			std::vector<tinyobj::material_t> materials;
-			std::string                      error;
-
-
-
-
-			bool result = tinyobj::LoadObj(&attribs, &shapes, &materials, &error, filename.data());
-			if (!result) {
-				std::cout << "Could not open the '" << filename << "' file.";
-				if (0 < error.size()) {
-					std::cout << " " << error;
+			uint32_t options = (load_normal ? CACHE_NORMAL : 0) | (load_uv ? CACHE_UV : 0) | (generate_tangent_space_vectors ? CACHE_TANGENT : 0) | (unify ? CACHE_UNIFY : 0);
+			uint64_t source_hash = 0;
+			uint64_t source_size = 0;
+			if (use_cache) {
+				MeshFile cache;
+				if (OpenMeshCache(filename, options, cache, source_hash, source_size) && !cache.isIndexed()) {
+					return { std::vector<float>(cache.vertices(), cache.vertices() + cache.vertexCount()), cache.getFormat().description() };
 				}
-				std::cout << std::endl;
+			}
+
+			ObjData obj;
+			if (!ParseObjFile(filename, obj)) {
+				std::cout << "Could not open the '" << filename << "' file." << std::endl;
 				return {};
 			}
 
-			std::vector<primitiveFormat> description = { POS3 };
-			
+			bool has_normal = obj.normals.size() != 0 && load_normal;
+			bool has_uv = obj.texcoords.size() != 0 && load_uv;
+			bool has_tangent = generate_tangent_space_vectors && has_normal && has_uv;
 
-			if (attribs.normals.size() != 0 && load_normal) {
+			std::vector<primitiveFormat> description = { POS3 };
+			if (has_normal) {
 				description.push_back(NORM3);
 			}
-			if (attribs.texcoords.size() != 0 && load_uv) {
+			if (has_uv) {
 				description.push_back(UV);
 			}
-			if (generate_tangent_space_vectors && load_normal && load_uv) {
+			if (has_tangent) {
 				description.push_back(F3);
 				description.push_back(F3);
 			}
-
-
-
-			// Load model data and unify (normalize) its size and position
-			float min_x = attribs.vertices[0];
-			float max_x = attribs.vertices[0];
-			float min_y = attribs.vertices[1];
-			float max_y = attribs.vertices[1];
-			float min_z = attribs.vertices[2];
-			float max_z = attribs.vertices[2];
-
-			std::vector<float> mesh;
-			uint32_t offset = 0;
-			for (auto& shape : shapes) {
-				uint32_t part_offset = offset;
-
-				for (auto& index : shape.mesh.indices) {
-					mesh.emplace_back(attribs.vertices[3 * index.vertex_index + 0]);
-					mesh.emplace_back(attribs.vertices[3 * index.vertex_index + 1]);
-					mesh.emplace_back(attribs.vertices[3 * index.vertex_index + 2]);
-					++offset;
-
-					
-					if (attribs.normals.size() != 0 && load_normal) {
-						mesh.emplace_back(attribs.normals[3 * index.normal_index + 0]);
-						mesh.emplace_back(attribs.normals[3 * index.normal_index + 1]);
-						mesh.emplace_back(attribs.normals[3 * index.normal_index + 2]);
-					}
-
-					if (attribs.texcoords.size() != 0 && load_uv) {
-						mesh.emplace_back(attribs.texcoords[2 * index.texcoord_index + 0]);
-						mesh.emplace_back(attribs.texcoords[2 * index.texcoord_index + 1]);
-					}
-
-					if (generate_tangent_space_vectors && load_normal && load_uv) {
-						// Insert temporary tangent space vectors data
-						for (int i = 0; i < 6; ++i) {
-							mesh.emplace_back(0.0f);
+			size_t stride = vertexFormat(description).size();
+
+			// every face corner becomes a vertex, written in place in the final array, corners without a normal or uv get zeros
+			std::vector<float> mesh(obj.corners.size() * stride, 0.0f);
+			Helpers::JobSystem::getJobSystem()->parallelFor(0, obj.corners.size(), loaderGrain, [&](size_t begin, size_t end) {
+				for (size_t c = begin; c < end; c++) {
+					const ObjCorner& corner = obj.corners[c];
+					float* vertex = &mesh[c * stride];
+					std::copy(&obj.positions[3 * size_t(corner.position)], &obj.positions[3 * size_t(corner.position)] + 3, vertex);
+					vertex += 3;
+					if (has_normal) {
+						if (corner.normal >= 0) {
+							std::copy(&obj.normals[3 * size_t(corner.normal)], &obj.normals[3 * size_t(corner.normal)] + 3, vertex);
 						}
+						vertex += 3;
 					}
-
-					if (unify) {
-						if (attribs.vertices[3 * index.vertex_index + 0] < min_x) {
-							min_x = attribs.vertices[3 * index.vertex_index + 0];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 0] > max_x) {
-							max_x = attribs.vertices[3 * index.vertex_index + 0];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 1] < min_y) {
-							min_y = attribs.vertices[3 * index.vertex_index + 1];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 1] > max_y) {
-							max_y = attribs.vertices[3 * index.vertex_index + 1];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 2] < min_z) {
-							min_z = attribs.vertices[3 * index.vertex_index + 2];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 2] > max_z) {
-							max_z = attribs.vertices[3 * index.vertex_index + 2];
-						}
+					if (has_uv && corner.texcoord >= 0) {
+						std::copy(&obj.texcoords[2 * size_t(corner.texcoord)], &obj.texcoords[2 * size_t(corner.texcoord)] + 2, vertex);
 					}
 				}
-			}
-
-			uint32_t stride = 3 + ((attribs.normals.size() !=0 && load_normal) ? 3 : 0) + ((attribs.texcoords.size() != 0 && load_uv) ? 2 : 0) + (generate_tangent_space_vectors ? 6 : 0);
-			/*if (vertex_stride) {
-				*vertex_stride = stride * sizeof(float);
-			}*/
+			});
 
-			if (generate_tangent_space_vectors) {
+			if (has_tangent) {
 				GenerateTangentSpaceVectors(mesh);
 			}
 
 			if (unify) {
-				float offset_x = 0.5f * (min_x + max_x);
-				float offset_y = 0.5f * (min_y + max_y);
-				float offset_z = 0.5f * (min_z + max_z);
-				float scale_x = abs(min_x - offset_x) > abs(max_x - offset_x) ? abs(min_x - offset_x) : abs(max_x - offset_x);
-				float scale_y = abs(min_y - offset_y) > abs(max_y - offset_y) ? abs(min_y - offset_y) : abs(max_y - offset_y);
-				float scale_z = abs(min_z - offset_z) > abs(max_z - offset_z) ? abs(min_z - offset_z) : abs(max_z - offset_z);
-				float scale = scale_x > scale_y ? scale_x : scale_y;
-				scale = scale_z > scale ? 1.0f / scale_z : 1.0f / scale;
-
-				for (size_t i = 0; i < mesh.size() - 2; i += stride) {
-					mesh[i + 0] = scale * (mesh[i + 0] - offset_x);
-					mesh[i + 1] = scale * (mesh[i + 1] - offset_y);
-					mesh[i + 2] = scale * (mesh[i + 2] - offset_z);
-				}
+				UnifyPositions(mesh, stride);
+			}
+
+			if (use_cache && source_size > 0) {
+				WriteMeshFile(MeshCachePath(filename, options), mesh, {}, vertexFormat(description), false, source_hash, source_size, options);
 			}
 			return { mesh,description };
     }
 		
 
+		/**
+		 *\brief Load an OBJ file as an indexed triangle mesh
+		 *\param use_cache as for the triangle list overload, the vertices and indices are copied out of the mesh file
+		 */
 		std::pair < std::pair <std::vector<float>, std::vector<uint32_t>>, vertexFormat  > Load3DModelFromObjFile(std::string filename,
 			bool				 load_normal,
-			bool         unify)
+			bool         unify,
+			bool         use_cache = false)
 		{
-			// Load model
-			tinyobj::attrib_t                attribs;
-			std::vector<tinyobj::shape_t>    shapes;
-			std::vector<tinyobj::material_t> materials;
-			std::string                      error;
-
-
-
-
-			bool result = tinyobj::LoadObj(&attribs, &shapes, &materials, &error, filename.data());
-			if (!result) {
-				std::cout << "Could not open the '" << filename << "' file.";
-				if (0 < error.size()) {
-					std::cout << " " << error;
+			uint32_t options = CACHE_INDEXED | (load_normal ? CACHE_NORMAL : 0) | (unify ? CACHE_UNIFY : 0);
+			uint64_t source_hash = 0;
+			uint64_t source_size = 0;
+			if (use_cache) {
+				MeshFile cache;
+				if (OpenMeshCache(filename, options, cache, source_hash, source_size) && cache.isIndexed()) {
+					return { { std::vector<float>(cache.vertices(), cache.vertices() + cache.vertexCount()),
+						std::vector<uint32_t>(cache.indices(), cache.indices() + cache.indexCount()) }, cache.getFormat().description() };
 				}
-				std::cout << std::endl;
-				return {};
 			}
 
-			std::vector<primitiveFormat> description = { POS3 };
+			ObjData obj;
+			if (!ParseObjFile(filename, obj)) {
+				std::cout << "Could not open the '" << filename << "' file." << std::endl;
+				return {};
+			}
 
+			bool has_normal = obj.normals.size() != 0 && load_normal;
 
-			if (attribs.normals.size() != 0 && load_normal) {
+			std::vector<primitiveFormat> description = { POS3 };
+			if (has_normal) {
 				description.push_back(NORM3);
 			}
-
-			uint32_t stride = 3 + ((attribs.normals.size() != 0 && load_normal) ? 3 : 0);
-			// Load model data and unify (normalize) its size and position
-			float min_x = attribs.vertices[0];
-			float max_x = attribs.vertices[0];
-			float min_y = attribs.vertices[1];
-			float max_y = attribs.vertices[1];
-			float min_z = attribs.vertices[2];
-			float max_z = attribs.vertices[2];
-
-			//loading the position;
-
-			std::vector<float> mesh;
-
-			for (int i = 0; i < attribs.vertices.size(); i+=3) {
-				mesh.push_back(attribs.vertices[i]);
-				mesh.push_back(attribs.vertices[i+1]);
-				mesh.push_back(attribs.vertices[i+2]);
-				if (load_normal) {
-					mesh.push_back(0);
-					mesh.push_back(0);
-					mesh.push_back(0);
+			size_t stride = vertexFormat(description).size();
+
+			// one vertex per position of the file, the normals of the corners sharing a position are averaged
+			size_t count = obj.positions.size() / 3;
+			std::vector<float> mesh(count * stride, 0.0f);
+			Helpers::JobSystem::getJobSystem()->parallelFor(0, count, loaderGrain, [&](size_t begin, size_t end) {
+				for (size_t v = begin; v < end; v++) {
+					std::copy(&obj.positions[3 * v], &obj.positions[3 * v] + 3, &mesh[v * stride]);
 				}
-				
-			}
-
-
-			std::vector<uint32_t>indices;
-			uint32_t offset = 0;
-			for (auto& shape : shapes) {
-				uint32_t part_offset = offset;
-
-				for (auto& index : shape.mesh.indices) {
-					indices.push_back(index.vertex_index);
-
-					
-					++offset;
-
+			});
 
-					if (attribs.normals.size() != 0 && load_normal) {
-						mesh[stride * index.vertex_index + 3] += attribs.normals[3 * index.normal_index + 0];
-						mesh[stride * index.vertex_index + 4] += attribs.normals[3 * index.normal_index + 1];
-						mesh[stride * index.vertex_index + 5] += attribs.normals[3 * index.normal_index + 2];
-					}
-
-					
+			std::vector<uint32_t> indices(obj.corners.size());
+			Helpers::JobSystem::getJobSystem()->parallelFor(0, obj.corners.size(), loaderGrain, [&](size_t begin, size_t end) {
+				for (size_t c = begin; c < end; c++) {
+					indices[c] = uint32_t(obj.corners[c].position);
+				}
+			});
 
-					if (unify) {
-						if (attribs.vertices[3 * index.vertex_index + 0] < min_x) {
-							min_x = attribs.vertices[3 * index.vertex_index + 0];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 0] > max_x) {
-							max_x = attribs.vertices[3 * index.vertex_index + 0];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 1] < min_y) {
-							min_y = attribs.vertices[3 * index.vertex_index + 1];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 1] > max_y) {
-							max_y = attribs.vertices[3 * index.vertex_index + 1];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 2] < min_z) {
-							min_z = attribs.vertices[3 * index.vertex_index + 2];
-						}
-						if (attribs.vertices[3 * index.vertex_index + 2] > max_z) {
-							max_z = attribs.vertices[3 * index.vertex_index + 2];
+			if (has_normal) {
+				for (const ObjCorner& corner : obj.corners) {
+					if (corner.normal >= 0) {
+						for (size_t i = 0; i < 3; i++) {
+							mesh[stride * size_t(corner.position) + 3 + i] += obj.normals[3 * size_t(corner.normal) + i];
 						}
 					}
 				}
 			}
 
-
-
 			if (unify) {
-				float offset_x = 0.5f * (min_x + max_x);
-				float offset_y = 0.5f * (min_y + max_y);
-				float offset_z = 0.5f * (min_z + max_z);
-				float scale_x = abs(min_x - offset_x) > abs(max_x - offset_x) ? abs(min_x - offset_x) : abs(max_x - offset_x);
-				float scale_y = abs(min_y - offset_y) > abs(max_y - offset_y) ? abs(min_y - offset_y) : abs(max_y - offset_y);
-				float scale_z = abs(min_z - offset_z) > abs(max_z - offset_z) ? abs(min_z - offset_z) : abs(max_z - offset_z);
-				float scale = scale_x > scale_y ? scale_x : scale_y;
-				scale = scale_z > scale ? 1.0f / scale_z : 1.0f / scale;
-
-				for (size_t i = 0; i < mesh.size(); i += stride) {
-					mesh[i + 0] = scale * (mesh[i + 0] - offset_x);
-					mesh[i + 1] = scale * (mesh[i + 1] - offset_y);
-					mesh[i + 2] = scale * (mesh[i + 2] - offset_z);
-				}
+				UnifyPositions(mesh, stride);
 			}
 
-			if (load_normal) {
+			if (has_normal) {
 				//renormalize normals
-				for (size_t i = 0; i < mesh.size(); i += stride) {
-					float nl = (mesh[i + 3] * mesh[i + 3]);
-					nl += (mesh[i + 4] * mesh[i + 4]);
-					nl += (mesh[i + 5] * mesh[i + 5]);
-					nl = sqrt(nl);
-
-					if (nl > 0) {
-						mesh[i + 3] = mesh[i + 3] / nl;
-						mesh[i + 4] = mesh[i + 4] / nl;
-						mesh[i + 5] = mesh[i + 5] / nl;
-					}
-				}
+				transformNormals(Identity(), mesh.data() + 3, count, stride);
 			}
-			
-
 
+			if (use_cache && source_size > 0) {
+				WriteMeshFile(MeshCachePath(filename, options), mesh, indices, vertexFormat(description), true, source_hash, source_size, options);
+			}
 			return { {mesh, indices} ,description };
 		}
+
+		/**
+		 *\brief Load an OBJ file as a mapped mesh file, built and written next to the OBJ file if it is missing or out of date
+		 * This is the only zero-copy path : the vertices are read in place when the file is given to VertexBuffer(std::shared_ptr<MeshFile>)
+		 * and uploaded with allocate(StagingRing&). VertexBuffer::allocate(Queue*, CommandBuffer&) copies them into a staging buffer first.
+		 *\param filename the path of the OBJ file
+		 *\param indexed if true the mesh is loaded as the indexed overload of Load3DModelFromObjFile does, load_uv and generate_tangent_space_vectors are then ignored
+		 *\return the mapped mesh file, nullptr if the OBJ file could not be loaded or the mesh file could not be written
+		 */
+		static std::shared_ptr<MeshFile> LoadMeshFileFromObjFile(std::string filename,
+			bool         indexed,
+			bool				 load_normal,
+			bool				 load_uv,
+			bool         generate_tangent_space_vectors,
+			bool         unify)
+		{
+			uint32_t options = indexed ? CACHE_INDEXED | (load_normal ? CACHE_NORMAL : 0) | (unify ? CACHE_UNIFY : 0) :
+				(load_normal ? CACHE_NORMAL : 0) | (load_uv ? CACHE_UV : 0) | (generate_tangent_space_vectors ? CACHE_TANGENT : 0) | (unify ? CACHE_UNIFY : 0);
+			std::shared_ptr<MeshFile> cache = std::make_shared<MeshFile>();
+			uint64_t source_hash = 0;
+			uint64_t source_size = 0;
+			if (OpenMeshCache(filename, options, *cache, source_hash, source_size)) {
+				return cache;
+			}
+
+			if (indexed) {
+				Load3DModelFromObjFile(filename, load_normal, unify, true);
+			}
+			else {
+				Load3DModelFromObjFile(filename, load_normal, load_uv, generate_tangent_space_vectors, unify, true);
+			}
+			if (!cache->open(MeshCachePath(filename, options)) || !cache->matches(source_hash, source_size, options)) {
+				return nullptr;
+			}
+			return cache;
+		}
 	
   }
 }
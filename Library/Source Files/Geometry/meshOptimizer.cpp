@@ -0,0 +1,490 @@
+#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace LavaCake {
+  namespace Geometry {
+
+    namespace {
+
+      const uint32_t noVertex = UINT32_MAX;
+
+      uint64_t mix(uint64_t hash, uint64_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        return hash;
+      }
+
+      uint64_t hashVertex(const float* vertex, size_t stride) {
+        uint64_t hash = 0;
+        for (size_t i = 0; i < stride; i++) {
+          // +0.0f turns -0.0f into 0.0f so both hash the same
+          float value = vertex[i] + 0.0f;
+          uint32_t bits;
+          std::memcpy(&bits, &value, sizeof(uint32_t));
+          hash = mix(hash, bits);
+        }
+        return hash;
+      }
+
+      uint64_t hashCell(const int64_t* cell, size_t dimension) {
+        uint64_t hash = 0;
+        for (size_t i = 0; i < dimension; i++) {
+          hash = mix(hash, uint64_t(cell[i]));
+        }
+        return hash;
+      }
+
+      int64_t cellCoordinate(double value, double cellSize) {
+        double c = std::floor(value / cellSize);
+        const double limit = 4611686018427387904.0; // 2^62
+        return int64_t(c < -limit ? -limit : (c > limit ? limit : c));
+      }
+
+      bool sameVertex(const float* a, const float* b, size_t stride, float epsilon) {
+        for (size_t i = 0; i < stride; i++) {
+          if (!(std::fabs(a[i] - b[i]) <= epsilon)) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      // the floats of the vertex used to place it in the grid, the position if the format has one
+      void gridAttribute(vertexFormat& format, size_t& offset, size_t& dimension) {
+        offset = 0;
+        dimension = format.size() < 3 ? format.size() : 3;
+        size_t o = 0;
+        for (primitiveFormat f : format.description()) {
+          if (f == POS3 || f == POS2) {
+            offset = o;
+            dimension = toSize(f);
+            return;
+          }
+          o += toSize(f);
+        }
+      }
+
+      // FIFO cache simulated with time stamps, a vertex is in the cache if less than cacheSize misses happened since it was loaded
+      class CacheSimulation {
+      public :
+        CacheSimulation(size_t vertexCount, size_t cacheSize) : m_stamps(vertexCount, 0), m_cacheSize(cacheSize), m_time(cacheSize + 1) {}
+
+        size_t access(uint32_t v) {
+          if (m_time - m_stamps[v] > m_cacheSize) {
+            m_stamps[v] = m_time++;
+            return 1;
+          }
+          return 0;
+        }
+
+        size_t triangle(const uint32_t* t) {
+          return access(t[0]) + access(t[1]) + access(t[2]);
+        }
+
+        void flush() {
+          m_time += m_cacheSize + 1;
+        }
+
+      private :
+        std::vector<size_t> m_stamps;
+        size_t              m_cacheSize;
+        size_t              m_time;
+      };
+
+      size_t vertexCountOf(TriangleIndexedMesh* mesh) {
+        size_t stride = mesh->vertexSize();
+        return stride > 0 ? mesh->vertices().size() / stride : 0;
+      }
+
+      bool checkIndices(TriangleIndexedMesh* mesh) {
+        size_t vertexCount = vertexCountOf(mesh);
+        for (uint32_t index : mesh->indices()) {
+          if (index >= vertexCount) {
+            std::cout << "Could not optimize the mesh, an index references a missing vertex" << std::endl;
+            return false;
+          }
+        }
+        return true;
+      }
+
+      // triangles around each vertex, in compressed rows
+      void buildAdjacency(const std::vector<uint32_t>& indices, size_t triangleCount, size_t vertexCount, std::vector<uint32_t>& offsets, std::vector<uint32_t>& triangles) {
+        offsets.assign(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+          offsets[indices[i] + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+          offsets[v + 1] += offsets[v];
+        }
+        triangles.resize(triangleCount * 3);
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+          triangles[fill[indices[i]]++] = uint32_t(i / 3);
+        }
+      }
+    }
+
+    TriangleIndexedMesh* weldVertices(Mesh_t* mesh, float epsilon) {
+      if (mesh->getTopology() != TRIANGLE) {
+        std::cout << "Could not weld the vertices of the mesh, it is not a triangle mesh" << std::endl;
+        return nullptr;
+      }
+      vertexFormat format = mesh->getFormat();
+      size_t stride = mesh->vertexSize();
+      std::vector<float>& vertices = mesh->vertices();
+      size_t vertexCount = stride > 0 ? vertices.size() / stride : 0;
+      size_t cornerCount = mesh->isIndexed() ? mesh->indices().size() : vertexCount;
+      if (epsilon < 0.0f || !std::isfinite(epsilon)) {
+        epsilon = 0.0f;
+      }
+
+      std::vector<float> weldedVertices;
+      std::vector<uint32_t> weldedIndices;
+      weldedIndices.reserve(cornerCount);
+
+      // chained hash table, the heads are indexed by the hash of a vertex and the chains link the unique vertices
+      size_t bucketCount = 1;
+      while (bucketCount < cornerCount * 2) {
+        bucketCount *= 2;
+      }
+      std::vector<uint32_t> heads(bucketCount, noVertex);
+      std::vector<uint32_t> next;
+
+      // an index of the input is welded once, its later uses reuse the result
+      std::vector<uint32_t> remap(vertexCount, noVertex);
+
+      size_t gridOffset, gridDimension;
+      gridAttribute(format, gridOffset, gridDimension);
+      double cellSize = 2.0 * double(epsilon);
+
+      for (size_t c = 0; c < cornerCount; c++) {
+        uint32_t source = mesh->isIndexed() ? mesh->indices()[c] : uint32_t(c);
+        if (source >= vertexCount) {
+          std::cout << "Could not weld the vertices of the mesh, an index references a missing vertex" << std::endl;
+          return nullptr;
+        }
+        if (remap[source] != noVertex) {
+          weldedIndices.push_back(remap[source]);
+          continue;
+        }
+
+        const float* vertex = vertices.data() + size_t(source) * stride;
+        uint32_t found = noVertex;
+        uint64_t hash;
+
+        if (epsilon == 0.0f) {
+          hash = hashVertex(vertex, stride);
+          for (uint32_t v = heads[hash & (bucketCount - 1)]; v != noVertex && found == noVertex; v = next[v]) {
+            if (sameVertex(vertex, weldedVertices.data() + size_t(v) * stride, stride, 0.0f)) {
+              found = v;
+            }
+          }
+        }
+        else {
+          // with cells of 2 epsilon, the vertices within epsilon are in at most 2 cells on each axis
+          int64_t cell[3], low[3], high[3];
+          for (size_t i = 0; i < gridDimension; i++) {
+            double p = vertex[gridOffset + i];
+            cell[i] = cellCoordinate(p, cellSize);
+            low[i] = cellCoordinate(p - epsilon, cellSize);
+            high[i] = cellCoordinate(p + epsilon, cellSize);
+          }
+          hash = hashCell(cell, gridDimension);
+
+          size_t neighbourCount = size_t(1) << gridDimension;
+          for (size_t n = 0; n < neighbourCount && found == noVertex; n++) {
+            int64_t neighbour[3];
+            bool inRange = true;
+            for (size_t i = 0; i < gridDimension; i++) {
+              neighbour[i] = (n >> i) & 1 ? high[i] : low[i];
+              inRange = inRange && (((n >> i) & 1) == 0 || high[i] != low[i]);
+            }
+            if (!inRange) {
+              continue;
+            }
+            uint64_t neighbourHash = hashCell(neighbour, gridDimension);
+            for (uint32_t v = heads[neighbourHash & (bucketCount - 1)]; v != noVertex && found == noVertex; v = next[v]) {
+              if (sameVertex(vertex, weldedVertices.data() + size_t(v) * stride, stride, epsilon)) {
+                found = v;
+              }
+            }
+          }
+        }
+
+        if (found == noVertex) {
+          found = uint32_t(next.size());
+          weldedVertices.insert(weldedVertices.end(), vertex, vertex + stride);
+          next.push_back(heads[hash & (bucketCount - 1)]);
+          heads[hash & (bucketCount - 1)] = found;
+        }
+        remap[source] = found;
+        weldedIndices.push_back(found);
+      }
+
+      return new TriangleIndexedMesh(weldedVertices, weldedIndices, format);
+    }
+
+    VertexCacheStatistics analyzeVertexCache(TriangleIndexedMesh* mesh, size_t cacheSize) {
+      VertexCacheStatistics statistics = { 0.0f, 0.0f };
+      std::vector<uint32_t>& indices = mesh->indices();
+      size_t vertexCount = vertexCountOf(mesh);
+      if (indices.size() < 3 || !checkIndices(mesh)) {
+        return statistics;
+      }
+
+      CacheSimulation cache(vertexCount, cacheSize);
+      std::vector<bool> referenced(vertexCount, false);
+      size_t misses = 0;
+      size_t referencedCount = 0;
+      for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        misses += cache.triangle(&indices[t]);
+        for (size_t i = t; i < t + 3; i++) {
+          referencedCount += referenced[indices[i]] ? 0 : 1;
+          referenced[indices[i]] = true;
+        }
+      }
+      statistics.acmr = float(misses) / float(indices.size() / 3);
+      statistics.atvr = float(misses) / float(referencedCount);
+      return statistics;
+    }
+
+    OptimizationReport optimizeVertexCache(TriangleIndexedMesh* mesh, size_t cacheSize) {
+      OptimizationReport report;
+      report.before = analyzeVertexCache(mesh, cacheSize);
+      std::vector<uint32_t>& indices = mesh->indices();
+      if (indices.size() < 3 || !checkIndices(mesh)) {
+        report.after = report.before;
+        return report;
+      }
+      size_t vertexCount = vertexCountOf(mesh);
+      size_t triangleCount = indices.size() / 3;
+
+      std::vector<uint32_t> offsets, adjacency;
+      buildAdjacency(indices, triangleCount, vertexCount, offsets, adjacency);
+
+      std::vector<uint32_t> live(vertexCount);
+      for (size_t v = 0; v < vertexCount; v++) {
+        live[v] = offsets[v + 1] - offsets[v];
+      }
+      std::vector<size_t> stamps(vertexCount, 0);
+      std::vector<bool> emitted(triangleCount, false);
+      std::vector<uint32_t> deadEnd;
+      std::vector<uint32_t> candidates;
+      std::vector<uint32_t> result;
+      result.reserve(triangleCount * 3);
+
+      size_t time = cacheSize + 1;
+      size_t cursor = 0;
+      int64_t fanning = 0;
+      while (fanning >= 0) {
+        // emit all the remaining triangles around the fanning vertex
+        candidates.clear();
+        for (uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+          uint32_t t = adjacency[a];
+          if (emitted[t]) {
+            continue;
+          }
+          for (size_t i = 0; i < 3; i++) {
+            uint32_t v = indices[3 * t + i];
+            result.push_back(v);
+            deadEnd.push_back(v);
+            candidates.push_back(v);
+            live[v]--;
+            if (time - stamps[v] > cacheSize) {
+              stamps[v] = time++;
+            }
+          }
+          emitted[t] = true;
+        }
+
+        // the next fanning vertex is the oldest candidate that stays in the cache while its triangles are emitted
+        fanning = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates) {
+          if (live[v] == 0) {
+            continue;
+          }
+          int64_t priority = 0;
+          if (time - stamps[v] + 2 * size_t(live[v]) <= cacheSize) {
+            priority = int64_t(time - stamps[v]);
+          }
+          if (priority > bestPriority) {
+            bestPriority = priority;
+            fanning = v;
+          }
+        }
+
+        // dead end, the most recent vertex still alive, or the next one in input order
+        while (fanning < 0 && !deadEnd.empty()) {
+          uint32_t v = deadEnd.back();
+          deadEnd.pop_back();
+          if (live[v] > 0) {
+            fanning = v;
+          }
+        }
+        while (fanning < 0 && cursor < vertexCount) {
+          if (live[cursor] > 0) {
+            fanning = int64_t(cursor);
+          }
+          cursor++;
+        }
+      }
+
+      result.insert(result.end(), indices.begin() + 3 * triangleCount, indices.end());
+      indices = result;
+      report.after = analyzeVertexCache(mesh, cacheSize);
+      return report;
+    }
+
+    OptimizationReport optimizeOverdraw(TriangleIndexedMesh* mesh, size_t cacheSize, float threshold) {
+      OptimizationReport report;
+      report.before = analyzeVertexCache(mesh, cacheSize);
+      report.after = report.before;
+      std::vector<uint32_t>& indices = mesh->indices();
+      if (indices.size() < 3 || !checkIndices(mesh)) {
+        return report;
+      }
+
+      vertexFormat format = mesh->getFormat();
+      size_t position = 0;
+      bool hasPosition = false;
+      for (primitiveFormat f : format.description()) {
+        if (f == POS3) {
+          hasPosition = true;
+          break;
+        }
+        position += toSize(f);
+      }
+      if (!hasPosition) {
+        std::cout << "Could not optimize the overdraw of the mesh, it has no 3D position" << std::endl;
+        return report;
+      }
+
+      size_t vertexCount = vertexCountOf(mesh);
+      size_t triangleCount = indices.size() / 3;
+      size_t stride = mesh->vertexSize();
+      const float* vertices = mesh->vertices().data();
+
+      // hard boundaries, at the first triangle and where the three vertices of a triangle miss the cache
+      std::vector<size_t> hard;
+      CacheSimulation cache(vertexCount, cacheSize);
+      for (size_t t = 0; t < triangleCount; t++) {
+        if (cache.triangle(&indices[3 * t]) == 3 || t == 0) {
+          hard.push_back(t);
+        }
+      }
+      hard.push_back(triangleCount);
+
+      // soft boundaries, a hard cluster is cut when the triangles since the last cut do not miss the cache more than the cluster with the threshold
+      std::vector<size_t> clusters;
+      for (size_t h = 0; h + 1 < hard.size(); h++) {
+        size_t start = hard[h];
+        size_t end = hard[h + 1];
+        cache.flush();
+        size_t clusterMisses = 0;
+        for (size_t t = start; t < end; t++) {
+          clusterMisses += cache.triangle(&indices[3 * t]);
+        }
+        float limit = threshold * float(clusterMisses) / float(end - start);
+
+        clusters.push_back(start);
+        cache.flush();
+        size_t misses = 0;
+        size_t count = 0;
+        for (size_t t = start; t < end; t++) {
+          misses += cache.triangle(&indices[3 * t]);
+          count++;
+          if (t + 1 < end && float(misses) <= limit * float(count)) {
+            clusters.push_back(t + 1);
+            cache.flush();
+            misses = 0;
+            count = 0;
+          }
+        }
+      }
+      clusters.push_back(triangleCount);
+
+      // area weighted centroid and normal of each cluster
+      size_t clusterCount = clusters.size() - 1;
+      std::vector<vec3f> centroids(clusterCount, vec3f({ 0.0f, 0.0f, 0.0f }));
+      std::vector<vec3f> normals(clusterCount, vec3f({ 0.0f, 0.0f, 0.0f }));
+      vec3f meshCentroid = vec3f({ 0.0f, 0.0f, 0.0f });
+      float meshArea = 0.0f;
+      for (size_t c = 0; c < clusterCount; c++) {
+        float area = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+          const float* p0 = vertices + size_t(indices[3 * t]) * stride + position;
+          const float* p1 = vertices + size_t(indices[3 * t + 1]) * stride + position;
+          const float* p2 = vertices + size_t(indices[3 * t + 2]) * stride + position;
+          vec3f a = vec3f({ p0[0], p0[1], p0[2] });
+          vec3f b = vec3f({ p1[0], p1[1], p1[2] });
+          vec3f d = vec3f({ p2[0], p2[1], p2[2] });
+          vec3f n = Cross(b - a, d - a);
+          float triangleArea = std::sqrt(Dot(n, n));
+          centroids[c] = centroids[c] + (a + b + d) * (triangleArea / 3.0f);
+          normals[c] = normals[c] + n;
+          area += triangleArea;
+        }
+        meshCentroid = meshCentroid + centroids[c];
+        meshArea += area;
+        centroids[c] = area > 0.0f ? centroids[c] * (1.0f / area) : centroids[c];
+      }
+      meshCentroid = meshArea > 0.0f ? meshCentroid * (1.0f / meshArea) : meshCentroid;
+
+      // the clusters facing away from the center of the mesh are drawn first
+      std::vector<float> sortKeys(clusterCount);
+      std::vector<size_t> order(clusterCount);
+      for (size_t c = 0; c < clusterCount; c++) {
+        float length = std::sqrt(Dot(normals[c], normals[c]));
+        sortKeys[c] = length > 0.0f ? Dot(centroids[c] - meshCentroid, normals[c]) / length : 0.0f;
+        order[c] = c;
+      }
+      std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return sortKeys[a] > sortKeys[b];
+      });
+
+      std::vector<uint32_t> result;
+      result.reserve(indices.size());
+      for (size_t c : order) {
+        result.insert(result.end(), indices.begin() + 3 * clusters[c], indices.begin() + 3 * clusters[c + 1]);
+      }
+      result.insert(result.end(), indices.begin() + 3 * triangleCount, indices.end());
+      indices = result;
+
+      report.after = analyzeVertexCache(mesh, cacheSize);
+      return report;
+    }
+
+    OptimizationReport optimizeVertexFetch(TriangleIndexedMesh* mesh) {
+      OptimizationReport report;
+      report.before = analyzeVertexCache(mesh);
+      report.after = report.before;
+      if (!checkIndices(mesh)) {
+        return report;
+      }
+
+      size_t stride = mesh->vertexSize();
+      std::vector<float>& vertices = mesh->vertices();
+      std::vector<uint32_t>& indices = mesh->indices();
+      std::vector<uint32_t> remap(vertexCountOf(mesh), noVertex);
+      std::vector<float> result;
+      result.reserve(vertices.size());
+      uint32_t next = 0;
+      for (uint32_t& index : indices) {
+        if (remap[index] == noVertex) {
+          remap[index] = next++;
+          result.insert(result.end(), vertices.begin() + size_t(index) * stride, vertices.begin() + size_t(index + 1) * stride);
+        }
+        index = remap[index];
+      }
+      vertices = result;
+
+      report.after = analyzeVertexCache(mesh);
+      return report;
+    }
+
+  }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "mesh.h"
+
+namespace LavaCake {
+  namespace Geometry {
+
+  /**
+   *\brief Merge the vertices of a triangle mesh that are equal within a tolerance, and index the mesh on the unique vertices
+   * Every attribute of the vertex format is compared, so two corners sharing a position but not a normal or a uv are kept apart.
+   * The unique vertices are kept in order of first use.
+   *\param mesh the mesh to weld, indexed or not, its topology must be TRIANGLE
+   *\param epsilon the largest difference allowed on each float of two merged vertices, 0 merges only identical vertices
+   *\return a new indexed mesh with the vertex format of the input mesh, nullptr if the mesh is not a triangle mesh
+   */
+    TriangleIndexedMesh* weldVertices(Mesh_t* mesh, float epsilon = 0.0f);
+
+  /**
+   *\brief Struct VertexCacheStatistics : efficiency of an index buffer on a simulated FIFO post-transform cache
+   */
+    struct VertexCacheStatistics {
+      float acmr;   // average cache miss ratio, vertex shader invocations per triangle, 0.5 at best and 3 at worst
+      float atvr;   // average transformed vertex ratio, vertex shader invocations per referenced vertex, 1 at best
+    };
+
+  /**
+   *\brief Struct OptimizationReport : statistics of a mesh before and after an optimization pass
+   */
+    struct OptimizationReport {
+      VertexCacheStatistics before;
+      VertexCacheStatistics after;
+    };
+
+  /**
+   *\brief Simulate the post-transform cache of the GPU on the index buffer of a mesh
+   *\param mesh the mesh to analyze
+   *\param cacheSize the number of vertices held by the simulated FIFO cache
+   *\return the cache statistics of the mesh
+   */
+    VertexCacheStatistics analyzeVertexCache(TriangleIndexedMesh* mesh, size_t cacheSize = 16);
+
+  /**
+   *\brief Reorder the triangles of a mesh to reuse the vertices in the post-transform cache, with the Tipsify algorithm
+   * Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007.
+   *\param mesh the mesh to reorder in place, the vertices are left unchanged
+   *\param cacheSize the number of vertices held by the targeted cache
+   *\return the cache statistics before and after the pass
+   */
+    OptimizationReport optimizeVertexCache(TriangleIndexedMesh* mesh, size_t cacheSize = 16);
+
+  /**
+   *\brief Reorder the clusters of triangles of a mesh so that the triangles facing outward are drawn first and hide the ones behind them
+   * The clusters are cut where the order of optimizeVertexCache already misses the cache, so the pass should follow it.
+   * The cache misses increase by at most threshold.
+   *\param mesh the mesh to reorder in place, its format must have a POS3 attribute
+   *\param cacheSize the number of vertices held by the targeted cache
+   *\param threshold the largest increase of the cache miss ratio allowed in a cluster, 1 keeps only the clusters separated by a cache flush
+   *\return the cache statistics before and after the pass
+   */
+    OptimizationReport optimizeOverdraw(TriangleIndexedMesh* mesh, size_t cacheSize = 16, float threshold = 1.05f);
+
+  /**
+   *\brief Reorder the vertices of a mesh in order of first use by the index buffer, the vertices never used are removed
+   * The vertex fetches then read memory almost sequentially, the pass should be run last.
+   *\param mesh the mesh to reorder in place
+   *\return the cache statistics before and after the pass, they are not changed by this pass
+   */
+    OptimizationReport optimizeVertexFetch(TriangleIndexedMesh* mesh);
+
+  }
+}
@@ -0,0 +1,322 @@
+#include "objParser.h"
+#include "Helpers/JobSystem.h"
+#include "Helpers/MappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+
+namespace LavaCake {
+  namespace Geometry {
+
+    namespace {
+
+      // the part of the file parsed by one job, relative indices are resolved against the counts of the chunk
+      struct ObjChunk {
+        const char*             begin;
+        const char*             end;
+        std::vector<float>      positions;
+        std::vector<float>      normals;
+        std::vector<float>      texcoords;
+        std::vector<ObjCorner>  corners;
+        std::vector<size_t>     relative;   // 3 * corner + attribute of the indices to offset by the counts of the previous chunks
+      };
+
+      const int32_t invalidIndex = INT32_MAX;
+
+      bool isSpace(char c) {
+        return c == ' ' || c == '\t';
+      }
+
+      bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+      }
+
+      const char* skipSpaces(const char* p, const char* end) {
+        while (p < end && isSpace(*p)) {
+          p++;
+        }
+        return p;
+      }
+
+      const char* nextLine(const char* p, const char* end) {
+        while (p < end && *p != '\n') {
+          p++;
+        }
+        return p < end ? p + 1 : end;
+      }
+
+      // locale independent, and a lot faster than strtof on the short numbers of OBJ files
+      const char* parseFloat(const char* p, const char* end, float& value) {
+        static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        p = skipSpaces(p, end);
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+          negative = *p == '-';
+          p++;
+        }
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        while (p < end && isDigit(*p)) {
+          if (digits < 19) {
+            mantissa = mantissa * 10 + uint64_t(*p - '0');
+            digits += mantissa > 0 ? 1 : 0;
+          }
+          else {
+            exponent++;
+          }
+          p++;
+        }
+        if (p < end && *p == '.') {
+          p++;
+          while (p < end && isDigit(*p)) {
+            if (digits < 19) {
+              mantissa = mantissa * 10 + uint64_t(*p - '0');
+              digits += mantissa > 0 ? 1 : 0;
+              exponent--;
+            }
+            p++;
+          }
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+          p++;
+          bool negativeExponent = false;
+          if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            p++;
+          }
+          int e = 0;
+          while (p < end && isDigit(*p)) {
+            e = e < 10000 ? e * 10 + (*p - '0') : e;
+            p++;
+          }
+          exponent += negativeExponent ? -e : e;
+        }
+
+        double result = double(mantissa);
+        if (exponent < 0) {
+          result = -exponent <= 22 ? result / powers[-exponent] : result * std::pow(10.0, exponent);
+        }
+        else if (exponent > 0) {
+          result = exponent <= 22 ? result * powers[exponent] : result * std::pow(10.0, exponent);
+        }
+        value = float(negative ? -result : result);
+        return p;
+      }
+
+      // an OBJ index starting at 1, negative indices count back from the last element read
+      const char* parseIndex(const char* p, const char* end, int64_t& index) {
+        bool negative = false;
+        if (p < end && *p == '-') {
+          negative = true;
+          p++;
+        }
+        index = 0;
+        while (p < end && isDigit(*p)) {
+          index = index < INT32_MAX ? index * 10 + (*p - '0') : index;
+          p++;
+        }
+        index = negative ? -index : index;
+        return p;
+      }
+
+      // negative indices are resolved against the counts of the chunk and flagged to be offset when the chunks are merged
+      int32_t resolveIndex(int64_t index, size_t count, bool& relative) {
+        relative = false;
+        if (index > 0 && index <= INT32_MAX) {
+          return int32_t(index - 1);
+        }
+        if (index < 0 && -index <= INT32_MAX) {
+          relative = true;
+          return int32_t(int64_t(count) + index);
+        }
+        return invalidIndex;
+      }
+
+      struct PolygonCorner {
+        ObjCorner corner;
+        bool      relative[3];
+      };
+
+      void parseFace(const char* p, const char* end, ObjChunk& chunk, std::vector<PolygonCorner>& polygon) {
+        polygon.clear();
+        while (true) {
+          p = skipSpaces(p, end);
+          if (p == end || !(isDigit(*p) || *p == '-')) {
+            break;
+          }
+          PolygonCorner c = { { -1, -1, -1 }, { false, false, false } };
+          int64_t index;
+          p = parseIndex(p, end, index);
+          c.corner.position = resolveIndex(index, chunk.positions.size() / 3, c.relative[0]);
+          if (p < end && *p == '/') {
+            p++;
+            if (p < end && *p != '/' && !isSpace(*p)) {
+              p = parseIndex(p, end, index);
+              c.corner.texcoord = resolveIndex(index, chunk.texcoords.size() / 2, c.relative[1]);
+            }
+            if (p < end && *p == '/') {
+              p++;
+              p = parseIndex(p, end, index);
+              c.corner.normal = resolveIndex(index, chunk.normals.size() / 3, c.relative[2]);
+            }
+          }
+          polygon.push_back(c);
+        }
+
+        for (size_t t = 1; t + 1 < polygon.size(); t++) {
+          for (size_t v : { size_t(0), t, t + 1 }) {
+            for (size_t attribute = 0; attribute < 3; attribute++) {
+              if (polygon[v].relative[attribute]) {
+                chunk.relative.push_back(3 * chunk.corners.size() + attribute);
+              }
+            }
+            chunk.corners.push_back(polygon[v].corner);
+          }
+        }
+      }
+
+      void parseChunk(ObjChunk& chunk) {
+        std::vector<PolygonCorner> polygon;
+        const char* p = chunk.begin;
+        const char* end = chunk.end;
+        while (p < end) {
+          const char* line = skipSpaces(p, end);
+          const char* lineEnd = nextLine(line, end);
+          if (line + 1 < lineEnd && line[0] == 'v') {
+            float value[3] = { 0.0f, 0.0f, 0.0f };
+            if (isSpace(line[1])) {
+              const char* q = line + 1;
+              for (int i = 0; i < 3; i++) {
+                q = parseFloat(q, lineEnd, value[i]);
+              }
+              chunk.positions.insert(chunk.positions.end(), value, value + 3);
+            }
+            else if (line[1] == 'n' && line + 2 < lineEnd && isSpace(line[2])) {
+              const char* q = line + 2;
+              for (int i = 0; i < 3; i++) {
+                q = parseFloat(q, lineEnd, value[i]);
+              }
+              chunk.normals.insert(chunk.normals.end(), value, value + 3);
+            }
+            else if (line[1] == 't' && line + 2 < lineEnd && isSpace(line[2])) {
+              const char* q = line + 2;
+              for (int i = 0; i < 2; i++) {
+                q = parseFloat(q, lineEnd, value[i]);
+              }
+              chunk.texcoords.insert(chunk.texcoords.end(), value, value + 2);
+            }
+          }
+          else if (line + 1 < lineEnd && line[0] == 'f' && isSpace(line[1])) {
+            parseFace(line + 1, lineEnd, chunk, polygon);
+          }
+          p = lineEnd;
+        }
+      }
+
+      bool checkIndex(int32_t index, size_t count) {
+        return index == -1 || (index >= 0 && size_t(index) < count);
+      }
+    }
+
+    bool ParseObjFile(const std::string& filename, ObjData& data) {
+      Helpers::MappedFile file;
+      if (!file.open(filename)) {
+        return false;
+      }
+      const char* text = static_cast<const char*>(file.data());
+      size_t size = file.size();
+
+      // chunks of at least 1MB, a few per thread so a chunk full of faces does not hold the others back
+      Helpers::JobSystem* jobSystem = Helpers::JobSystem::getJobSystem();
+      size_t chunkCount = size / (1 << 20) + 1;
+      if (chunkCount > size_t(jobSystem->getThreadCount()) * 4) {
+        chunkCount = size_t(jobSystem->getThreadCount()) * 4;
+      }
+      std::vector<ObjChunk> chunks(chunkCount);
+      const char* begin = text;
+      for (size_t c = 0; c < chunkCount; c++) {
+        const char* end = c + 1 == chunkCount ? text + size : nextLine(text + (c + 1) * size / chunkCount, text + size);
+        if (end < begin) {
+          end = begin;
+        }
+        chunks[c].begin = begin;
+        chunks[c].end = end;
+        begin = end;
+      }
+
+      jobSystem->parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; c++) {
+          parseChunk(chunks[c]);
+        }
+      });
+
+      // offsets of each chunk in the merged arrays
+      std::vector<size_t> positions(chunkCount + 1, 0);
+      std::vector<size_t> normals(chunkCount + 1, 0);
+      std::vector<size_t> texcoords(chunkCount + 1, 0);
+      std::vector<size_t> corners(chunkCount + 1, 0);
+      for (size_t c = 0; c < chunkCount; c++) {
+        positions[c + 1] = positions[c] + chunks[c].positions.size();
+        normals[c + 1] = normals[c] + chunks[c].normals.size();
+        texcoords[c + 1] = texcoords[c] + chunks[c].texcoords.size();
+        corners[c + 1] = corners[c] + chunks[c].corners.size();
+      }
+      if (positions[chunkCount] / 3 > size_t(INT32_MAX)) {
+        std::cout << "Could not load " << filename << ", it has too many vertices" << std::endl;
+        return false;
+      }
+      data.positions.resize(positions[chunkCount]);
+      data.normals.resize(normals[chunkCount]);
+      data.texcoords.resize(texcoords[chunkCount]);
+      data.corners.resize(corners[chunkCount]);
+
+      std::atomic<bool> valid(true);
+      jobSystem->parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; c++) {
+          ObjChunk& chunk = chunks[c];
+          // each array of the chunk is released once copied, so the file is not held twice in memory
+          std::copy(chunk.positions.begin(), chunk.positions.end(), data.positions.begin() + positions[c]);
+          std::vector<float>().swap(chunk.positions);
+          std::copy(chunk.normals.begin(), chunk.normals.end(), data.normals.begin() + normals[c]);
+          std::vector<float>().swap(chunk.normals);
+          std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), data.texcoords.begin() + texcoords[c]);
+          std::vector<float>().swap(chunk.texcoords);
+
+          const int32_t offsets[3] = { int32_t(positions[c] / 3), int32_t(texcoords[c] / 2), int32_t(normals[c] / 3) };
+          for (size_t r : chunk.relative) {
+            ObjCorner& corner = chunk.corners[r / 3];
+            int32_t* fields[3] = { &corner.position, &corner.texcoord, &corner.normal };
+            int32_t* index = fields[r % 3];
+            *index += offsets[r % 3];
+            if (*index < 0) {
+              *index = invalidIndex;
+            }
+          }
+
+          bool chunkValid = true;
+          for (const ObjCorner& corner : chunk.corners) {
+            chunkValid = chunkValid && corner.position != -1 && checkIndex(corner.position, data.positions.size() / 3) &&
+              checkIndex(corner.texcoord, data.texcoords.size() / 2) && checkIndex(corner.normal, data.normals.size() / 3);
+          }
+          if (!chunkValid) {
+            valid = false;
+          }
+          std::copy(chunk.corners.begin(), chunk.corners.end(), data.corners.begin() + corners[c]);
+          std::vector<ObjCorner>().swap(chunk.corners);
+          std::vector<size_t>().swap(chunk.relative);
+        }
+      });
+
+      if (!valid) {
+        std::cout << "Could not load " << filename << ", a face references a missing vertex" << std::endl;
+        return false;
+      }
+      return true;
+    }
+  }
+}
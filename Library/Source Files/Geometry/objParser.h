@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace LavaCake {
+  namespace Geometry {
+
+  /**
+   *\brief Struct ObjCorner : the attributes of a face corner, as indices in the arrays of an ObjData, -1 when the corner does not reference the attribute
+   */
+    struct ObjCorner {
+      int32_t position;
+      int32_t texcoord;
+      int32_t normal;
+    };
+
+  /**
+   *\brief Struct ObjData : the content of an OBJ file, shapes, groups and materials are merged
+   */
+    struct ObjData {
+      std::vector<float>      positions;  // 3 floats per position
+      std::vector<float>      normals;    // 3 floats per normal
+      std::vector<float>      texcoords;  // 2 floats per texture coordinate
+      std::vector<ObjCorner>  corners;    // 3 corners per triangle, polygons are split in triangle fans
+    };
+
+  /**
+   *\brief Parse an OBJ file, the file is mapped and cut in chunks on line boundaries that are parsed in parallel by the job system
+   *\param filename the path of the file
+   *\param data the parsed content, every index is checked against the size of the arrays
+   *\return true if the file could be read and all its indices are valid
+   */
+    bool ParseObjFile(const std::string& filename, ObjData& data);
+
+  }
+}
@@ -2,6 +2,11 @@
 #include "helpers.h"
 #include "ABBox.h"
 #include "Math/basics.h"
+#include "JobSystem.h"
+
+#include <cstring>
+#include <memory>
+#include <unordered_map>
 
 namespace LavaCake {
   namespace Helpers {
@@ -20,11 +25,117 @@ namespace LavaCake {
      \return the value of the field at the position pos
      */
     virtual T sample(vec2f pos) = 0;
+    
+    virtual ~Field2D(){};
+    
+    /**
+     \brief sample the field on a regular grid of positions, one sample after the other since sample may not be thread safe, the grid fields override it with a parallel version
+     \param origin the position of the first sample
+     \param step the offset between two consecutive samples along each axis
+     \param resolution the number of samples along each axis
+     \param result the samples ordered along x then y, resized to hold them
+     */
+    virtual void sampleMany(vec2f origin, vec2f step, vec2u resolution, std::vector<T>& result){
+      result.resize(size_t(resolution[0]) * resolution[1]);
+      for(uint32_t j = 0; j < resolution[1]; j++){
+        for(uint32_t i = 0; i < resolution[0]; i++){
+          result[i + size_t(j) * resolution[0]] = sample(vec2f({origin[0] + float(i) * step[0], origin[1] + float(j) * step[1]}));
+        }
+      }
+    }
+  };
+  
+  /**
+   \brief find the grid cell and the interpolation weight of a coordinate along one axis, as the sample functions of the grid fields
+   \param x the coordinate in grid units
+   \param size the number of values of the grid along the axis
+   \param u the index of the first value of the cell
+   \param r the weight of the second value of the cell
+   */
+  inline void gridCoordinate(float x, uint32_t size, uint32_t& u, float& r){
+    x = fmax(0.0f, x);
+    u = uint32_t(x);
+    r = x - float(u);
+    if(u >= size-1){
+      u = size-2;
+      r = 1.0f;
+    }
+  }
+
+  /**
+   \brief bilinear interpolation of the four values of a cell, the two interpolations along x are independent so they map to a single SIMD operation
+   \param c the values of the cell ordered along x then y
+   \param r the weight along x
+   \param s the weight along y
+   */
+  template <typename T>
+  inline T bilinear(const T* c, float r, float s){
+    T x[2];
+    for(int i = 0; i < 2; i++){
+      x[i] = c[2 * i + 1] * r + c[2 * i] * (1.0f - r);
+    }
+    return x[1] * s + x[0] * (1.0f - s);
+  }
+  
+  /**
+   \brief trilinear interpolation of the eight values of a cell, the four interpolations along x then the two along y are independent so they map to SIMD operations
+   \param c the values of the cell ordered along x then y then z
+   \param r the weight along x
+   \param s the weight along y
+   \param t the weight along z
+   */
+  template <typename T>
+  inline T trilinear(const T* c, float r, float s, float t){
+    T x[4];
+    for(int i = 0; i < 4; i++){
+      x[i] = c[2 * i + 1] * r + c[2 * i] * (1.0f - r);
+    }
+    T y[2];
+    for(int i = 0; i < 2; i++){
+      y[i] = x[2 * i + 1] * s + x[2 * i] * (1.0f - s);
+    }
+    return y[1] * t + y[0] * (1.0f - t);
+  }
+  
+  /**
+   \brief interpolation of the eight values of a cell with an interpolation function
+   \param c the values of the cell ordered along x then y then z
+   \param r the weight along x
+   \param s the weight along y
+   \param t the weight along z
+   \param interpolate a callable T(T&, T&, float) interpolating two values
+   */
+  template <typename T, typename Interpolate>
+  inline T interpolateCell(T* c, float r, float s, float t, Interpolate interpolate){
+    T AB = interpolate(c[0], c[1], r);
+    T CD = interpolate(c[2], c[3], r);
+    T ABCD = interpolate(AB, CD, s);
+    
+    T EF = interpolate(c[4], c[5], r);
+    T GH = interpolate(c[6], c[7], r);
+    T EFGH = interpolate(EF, GH, s);
+    return interpolate(ABCD, EFGH, t);
+  }
+
+  /**
+   *Class FieldView :
+   *\brief A non owning view on the values of a grid field
+   *\tparam T  the type the Field holds
+   */
+  template <typename T>
+  struct FieldView {
+    const T*  data = nullptr;
+    size_t    size = 0;
+    
+    const T* begin() const {return data;}
+    const T* end() const {return data + size;}
+    const T& operator[](size_t i) const {return data[i];}
   };
 
   /**
    *Class  Field2DGrid :
    *\brief A class that represent a 2D field sampled on a regular grid
+   * sample is final : it is not a virtual call through a Field2DGrid, and sampleLinear or sampleWith inline the interpolation.
    *\tparam T  the type the Field will hold
    */
   template <typename T>
@@ -32,7 +143,7 @@ namespace LavaCake {
     public:
     
     /**
-     *\brief Create a 2D field
+     *\brief Create a 2D field, the data is copied
      *\param data a std::vector of data
      *\param width the width of the grid
      *\param height the height of the grid
@@ -47,10 +158,48 @@ namespace LavaCake {
     ): Field2D<T>(){
       
       m_fields = data;
-      m_width = width;
-      m_height = height;
-      m_boundingbox = boundingbox;
-      m_interpolate = interpolate;
+      setup(width, height, boundingbox, interpolate);
+    }
+    
+    /**
+     *\brief Create a 2D field taking ownership of the data, the vector is left empty
+     *\param data a std::vector of data
+     *\param width the width of the grid
+     *\param height the height of the grid
+     *\param boundingbox the bounding box of the field in the domain
+     *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     */
+    Field2DGrid(std::vector<T>&& data,
+                uint32_t width,
+                uint32_t height,
+                ABBox<2> boundingbox,
+                T (*interpolate)(T&, T&, float) = nullptr
+    ): Field2D<T>(){
+      
+      m_fields = std::move(data);
+      setup(width, height, boundingbox, interpolate);
+    }
+    
+    /**
+     *\brief Create a 2D field on values it does not own, such as a memory mapped file
+     *\param data a pointer to width * height values ordered along x then y
+     *\param width the width of the grid
+     *\param height the height of the grid
+     *\param boundingbox the bounding box of the field in the domain
+     *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     *\param owner [optional] kept alive as long as the field, it must keep the values valid, otherwise the caller does
+     */
+    Field2DGrid(const T* data,
+                uint32_t width,
+                uint32_t height,
+                ABBox<2> boundingbox,
+                T (*interpolate)(T&, T&, float) = nullptr,
+                std::shared_ptr<const void> owner = nullptr
+    ): Field2D<T>(){
+      
+      m_external = data;
+      m_owner = owner;
+      setup(width, height, boundingbox, interpolate);
     }
     
     /**
@@ -58,43 +207,91 @@ namespace LavaCake {
      \param pos a vec2f representing the sample position
      \return the value of the field at the position pos
      */
-    T sample(vec2f pos) override{
-      vec2f X = (pos - m_boundingbox.A()) / (m_boundingbox.diag());
-      X = X * vec2f({float(m_width-1), float(m_height-1)});
-      X = vec2f({fmax(0.0f, X[0]), fmax(0.0f, X[1])});
-      
-      vec2u U = vec2u({uint32_t(X[0]),uint32_t(X[1])});
-      vec2f R = X - vec2f({float(U[0]),float(U[1])});
-      
-      
-      if(U[0] >= m_width-1){
-        U[0] = m_width-2;
-        R[0] = 1.0f;
-      }
-      if(U[1] >= m_height-1){
-        U[1] = m_height-2;
-        R[1] = 1.0f;
-      }
-      T A,B,C,D;
-      A = m_fields[U[0]     +  U[1]    *m_width];
-      B = m_fields[U[0]+1   +  U[1]    *m_width];
-      C = m_fields[U[0]     + (U[1]+1) *m_width];
-      D = m_fields[U[0]+1   + (U[1]+1) *m_width];
-      
-
+    T sample(vec2f pos) override final{
       if (m_interpolate == nullptr) {
-        T AB = B * R[0] + A * (1.0f - R[0]);
-        T CD = D * R[0] + C * (1.0f - R[0]);
-        return CD * R[1] + AB * (1.0f - R[1]);
+        return sampleLinear(pos);
+      }
+      return sampleWith(pos, m_interpolate);
+    }
+    
+    /**
+     \brief sample the field at a postion with a bilinear interpolation
+     \param pos a vec2f representing the sample position
+     \return the value of the field at the position pos
+     */
+    T sampleLinear(vec2f pos) const{
+      vec2u U;
+      vec2f R;
+      cellCoordinate(pos, U, R);
+      T c[4];
+      fetchCell(U, c);
+      return bilinear(c, R[0], R[1]);
+    }
+    
+    /**
+     \brief sample the field at a postion with an interpolation function, a lambda or a functor is inlined where a function pointer is not
+     \param pos a vec2f representing the sample position
+     \param interpolate a callable T(T&, T&, float) interpolating two values
+     \return the value of the field at the position pos
+     */
+    template <typename Interpolate>
+    T sampleWith(vec2f pos, Interpolate interpolate) const{
+      vec2u U;
+      vec2f R;
+      cellCoordinate(pos, U, R);
+      T c[4];
+      fetchCell(U, c);
+      T AB = interpolate(c[0], c[1], R[0]);
+      T CD = interpolate(c[2], c[3], R[0]);
+      return interpolate(AB, CD, R[1]);
+    }
+    
+    /**
+     \brief sample the field on a regular grid of positions, the cells and weights of the columns are computed once and those of each row once per row, the rows are sampled in parallel by the job system
+     \param origin the position of the first sample
+     \param step the offset between two consecutive samples along each axis
+     \param resolution the number of samples along each axis
+     \param result the samples ordered along x then y, resized to hold them
+     */
+    void sampleMany(vec2f origin, vec2f step, vec2u resolution, std::vector<T>& result) override{
+      result.resize(size_t(resolution[0]) * resolution[1]);
+      std::vector<uint32_t> columns(resolution[0]);
+      std::vector<float> columnWeights(resolution[0]);
+      for(uint32_t i = 0; i < resolution[0]; i++){
+        gridCoordinate((origin[0] + float(i) * step[0] - m_gridMin[0]) * m_scale[0], m_width, columns[i], columnWeights[i]);
       }
-      T AB = m_interpolate(A, B, R[0]);
-      T CD = m_interpolate(C, D, R[0]);
-      return m_interpolate(AB, CD, R[1]);
       
+      JobSystem::getJobSystem()->parallelFor(0, resolution[1], 1, [&](size_t begin, size_t end){
+        for(size_t j = begin; j < end; j++){
+          vec2u U;
+          float rowWeight;
+          gridCoordinate((origin[1] + float(j) * step[1] - m_gridMin[1]) * m_scale[1], m_height, U[1], rowWeight);
+          T* out = &result[j * resolution[0]];
+          
+          for(uint32_t i = 0; i < resolution[0]; i++){
+            U[0] = columns[i];
+            T c[4];
+            fetchCell(U, c);
+            if (m_interpolate == nullptr) {
+              out[i] = bilinear(c, columnWeights[i], rowWeight);
+            }
+            else {
+              T AB = m_interpolate(c[0], c[1], columnWeights[i]);
+              T CD = m_interpolate(c[2], c[3], columnWeights[i]);
+              out[i] = m_interpolate(AB, CD, rowWeight);
+            }
+          }
+        }
+      });
     }
     
+    std::vector<T> getRawField(){return std::vector<T>(values(), values() + size_t(m_width) * m_height);}
     
-    std::vector<T> getRawField(){return m_fields;}
+    /**
+     \brief get a view on the values of the field, without copy
+     \return a view valid as long as the field, ordered along x then y
+     */
+    FieldView<T> getRawFieldView() const{return {values(), size_t(m_width) * m_height};}
     vec2u getDimension(){return{m_width,m_height};}
     
     /**
@@ -104,10 +301,41 @@ namespace LavaCake {
     ABBox<2> getABBox(){return m_boundingbox;}
     
     private :
+    
+    void setup(uint32_t width, uint32_t height, ABBox<2> boundingbox, T (*interpolate)(T&, T&, float)){
+      m_width = width;
+      m_height = height;
+      m_boundingbox = boundingbox;
+      m_interpolate = interpolate;
+      m_gridMin = boundingbox.A();
+      m_scale = vec2f({float(width-1), float(height-1)}) / boundingbox.diag();
+    }
+    
+    const T* values() const{
+      return m_external != nullptr ? m_external : m_fields.data();
+    }
+    
+    void cellCoordinate(vec2f pos, vec2u& U, vec2f& R) const{
+      gridCoordinate((pos[0] - m_gridMin[0]) * m_scale[0], m_width, U[0], R[0]);
+      gridCoordinate((pos[1] - m_gridMin[1]) * m_scale[1], m_height, U[1], R[1]);
+    }
+    
+    void fetchCell(vec2u U, T* c) const{
+      const T* line = values() + U[0] + U[1] * m_width;
+      c[0] = line[0];
+      c[1] = line[1];
+      c[2] = line[m_width];
+      c[3] = line[m_width + 1];
+    }
+    
     uint32_t        m_width;
     uint32_t        m_height;
     std::vector<T>  m_fields;
+    const T*        m_external = nullptr;           // values not owned by the field, used instead of m_fields when set
+    std::shared_ptr<const void> m_owner;
     ABBox<2>        m_boundingbox;
+    vec2f           m_gridMin;
+    vec2f           m_scale;        // grid units per unit of the domain
 
     T (*m_interpolate)(T&, T&, float);
   };
@@ -127,12 +355,42 @@ namespace LavaCake {
      \return the value of the field at the position pos
      */
     virtual T sample(vec3f pos) = 0;
+    
+    virtual ~Field3D(){};
+    
+    /**
+     \brief sample the field on a regular grid of positions, one sample after the other since sample may not be thread safe, the grid fields override it with a parallel version
+     \param origin the position of the first sample
+     \param step the offset between two consecutive samples along each axis
+     \param resolution the number of samples along each axis
+     \param result the samples ordered along x then y then z, resized to hold them
+     */
+    virtual void sampleMany(vec3f origin, vec3f step, vec3u resolution, std::vector<T>& result){
+      result.resize(size_t(resolution[0]) * resolution[1] * resolution[2]);
+      for(uint32_t k = 0; k < resolution[2]; k++){
+        for(uint32_t j = 0; j < resolution[1]; j++){
+          size_t row = j + size_t(k) * resolution[1];
+          for(uint32_t i = 0; i < resolution[0]; i++){
+            result[i + row * resolution[0]] = sample(vec3f({origin[0] + float(i) * step[0], origin[1] + float(j) * step[1], origin[2] + float(k) * step[2]}));
+          }
+        }
+      }
+    }
   };
   
   
+  /**
+   \brief Enum : storage order of the values of a grid field
+   */
+  enum fieldLayout {
+    ROW_MAJOR,  /*!< values ordered along x then y then z */
+    BRICK       /*!< values grouped in bricks of 4x4x4 stored contiguously, the neighbours along y and z are a few cache lines away instead of a row or a slice, the eight values of a cell are in one brick for 27 cells out of 64 and in up to eight bricks otherwise */
+  };
+  
   /**
    *Class  Field3DGrid :
    *\brief A class that represent a 3D field sampled on a regular grid
+   * sample is final : it is not a virtual call through a Field3DGrid, and sampleLinear or sampleWith inline the interpolation.
    *\tparam T  the type the Field will hold
    */
   template <typename T>
@@ -140,21 +398,364 @@ namespace LavaCake {
   public:
     
     /**
-     *\brief Create a 3D field
-     *\param data a std::vector of data
+     *\brief Create a 3D field, the data is copied
+     *\param data a std::vector of data, ordered along x then y then z
      *\param width the width of the grid
      *\param height the height of the grid
      *\param dpeth  the depth of the grid
      *\param boundingbox the bounding box of the field in the domain
      *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     *\param layout [optional] the storage order of the values, BRICK keeps the neighbours along y and z closer in memory
      */
-    Field3DGrid(std::vector<T>& data, uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T (*interpolate)(T&, T&, float) = nullptr){
-      m_fields = data;
+    Field3DGrid(std::vector<T>& data, uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T (*interpolate)(T&, T&, float) = nullptr, fieldLayout layout = ROW_MAJOR){
+      setup(width, height, depth, boundingbox, interpolate, layout);
+      if (m_layout == ROW_MAJOR) {
+        m_fields = data;
+        return;
+      }
+      toBricks(data);
+    }
+    
+    /**
+     *\brief Create a 3D field taking ownership of the data, the vector is left empty
+     *\param data a std::vector of data, ordered along x then y then z
+     *\param width the width of the grid
+     *\param height the height of the grid
+     *\param dpeth  the depth of the grid
+     *\param boundingbox the bounding box of the field in the domain
+     *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     *\param layout [optional] the storage order of the values, with BRICK the data is reordered and then released
+     */
+    Field3DGrid(std::vector<T>&& data, uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T (*interpolate)(T&, T&, float) = nullptr, fieldLayout layout = ROW_MAJOR){
+      setup(width, height, depth, boundingbox, interpolate, layout);
+      if (m_layout == ROW_MAJOR) {
+        m_fields = std::move(data);
+        return;
+      }
+      toBricks(data);
+      std::vector<T>().swap(data);
+    }
+    
+    /**
+     *\brief Create a 3D field on values it does not own, such as a memory mapped file
+     *\param data a pointer to the values, already stored in the given layout as returned by getRawFieldView
+     *\param width the width of the grid
+     *\param height the height of the grid
+     *\param dpeth  the depth of the grid
+     *\param boundingbox the bounding box of the field in the domain
+     *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     *\param layout [optional] the storage order of the values
+     *\param owner [optional] kept alive as long as the field, it must keep the values valid, otherwise the caller does
+     */
+    Field3DGrid(const T* data, uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T (*interpolate)(T&, T&, float) = nullptr, fieldLayout layout = ROW_MAJOR, std::shared_ptr<const void> owner = nullptr){
+      setup(width, height, depth, boundingbox, interpolate, layout);
+      m_external = data;
+      m_owner = owner;
+    }
+    
+    /**
+     \brief sample the field at a postion
+     \param pos a vec3f representing the sample position
+     \return the value of the field at the position pos
+     */
+    T sample(vec3f pos) override final{
+      if (m_interpolate == nullptr) {
+        return sampleLinear(pos);
+      }
+      return sampleWith(pos, m_interpolate);
+    }
+    
+    /**
+     \brief sample the field at a postion with a trilinear interpolation
+     \param pos a vec3f representing the sample position
+     \return the value of the field at the position pos
+     */
+    T sampleLinear(vec3f pos) const{
+      vec3u U;
+      vec3f R;
+      cellCoordinate(pos, U, R);
+      T c[8];
+      fetchCell(U, c);
+      return trilinear(c, R[0], R[1], R[2]);
+    }
+    
+    /**
+     \brief sample the field at a postion with an interpolation function, a lambda or a functor is inlined where a function pointer is not
+     \param pos a vec3f representing the sample position
+     \param interpolate a callable T(T&, T&, float) interpolating two values
+     \return the value of the field at the position pos
+     */
+    template <typename Interpolate>
+    T sampleWith(vec3f pos, Interpolate interpolate) const{
+      vec3u U;
+      vec3f R;
+      cellCoordinate(pos, U, R);
+      T c[8];
+      fetchCell(U, c);
+      return interpolateCell(c, R[0], R[1], R[2], interpolate);
+    }
+    
+    /**
+     \brief sample the field on a regular grid of positions, the cells and weights of the columns are computed once and those of each row once per row, the rows are sampled in parallel by the job system
+     \param origin the position of the first sample
+     \param step the offset between two consecutive samples along each axis
+     \param resolution the number of samples along each axis
+     \param result the samples ordered along x then y then z, resized to hold them
+     */
+    void sampleMany(vec3f origin, vec3f step, vec3u resolution, std::vector<T>& result) override{
+      result.resize(size_t(resolution[0]) * resolution[1] * resolution[2]);
+      std::vector<uint32_t> columns(resolution[0]);
+      std::vector<float> columnWeights(resolution[0]);
+      for(uint32_t i = 0; i < resolution[0]; i++){
+        gridCoordinate((origin[0] + float(i) * step[0] - m_gridMin[0]) * m_scale[0], m_width, columns[i], columnWeights[i]);
+      }
+      
+      JobSystem::getJobSystem()->parallelFor(0, size_t(resolution[1]) * resolution[2], 1, [&](size_t begin, size_t end){
+        for(size_t row = begin; row < end; row++){
+          size_t j = row % resolution[1];
+          size_t k = row / resolution[1];
+          vec3u U;
+          float s, t;
+          gridCoordinate((origin[1] + float(j) * step[1] - m_gridMin[1]) * m_scale[1], m_height, U[1], s);
+          gridCoordinate((origin[2] + float(k) * step[2] - m_gridMin[2]) * m_scale[2], m_depth, U[2], t);
+          T* out = &result[row * resolution[0]];
+          
+          for(uint32_t i = 0; i < resolution[0]; i++){
+            U[0] = columns[i];
+            T c[8];
+            fetchCell(U, c);
+            if (m_interpolate == nullptr) {
+              out[i] = trilinear(c, columnWeights[i], s, t);
+            }
+            else {
+              out[i] = interpolateCell(c, columnWeights[i], s, t, m_interpolate);
+            }
+          }
+        }
+      });
+    }
+    
+    /**
+     \brief get the values of the field
+     \return the values ordered along x then y then z, whatever the layout
+     */
+    std::vector<T> getRawField(){
+      if (m_layout == ROW_MAJOR) {
+        return std::vector<T>(values(), values() + size_t(m_sliceSize) * m_depth);
+      }
+      std::vector<T> data(size_t(m_sliceSize) * m_depth);
+      const T* stored = values();
+      for (uint32_t k = 0; k < m_depth; k++) {
+        for (uint32_t j = 0; j < m_height; j++) {
+          for (uint32_t i = 0; i < m_width; i++) {
+            data[i + j * m_width + k * m_sliceSize] = stored[index(i, j, k)];
+          }
+        }
+      }
+      return data;
+    };
+    
+    /**
+     \brief get a view on the values of the field as they are stored, without copy
+     \return a view valid as long as the field, ordered along x then y then z for ROW_MAJOR and brick by brick for BRICK
+     */
+    FieldView<T> getRawFieldView() const{return {values(), storedSize()};};
+    vec3u getDimension(){return{m_width,m_height,m_depth};};
+    fieldLayout getLayout(){return m_layout;};
+    
+    /**
+     \brief get the bounding box of the field
+     \return a bounding box 3D
+     */
+    ABBox<3> getABBox(){return m_boundingbox;};
+    
+    private :
+    
+    void setup(uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T (*interpolate)(T&, T&, float), fieldLayout layout){
       m_width = width;
       m_height = height;
       m_depth = depth;
+      m_sliceSize = width * height;
       m_boundingbox = boundingbox;
       m_interpolate = interpolate;
+      m_layout = layout;
+      m_gridMin = boundingbox.A();
+      m_scale = vec3f({float(width-1), float(height-1), float(depth-1)}) / (boundingbox.B() - boundingbox.A());
+      m_bricks = vec3u({ (width + 3) / 4, (height + 3) / 4, (depth + 3) / 4 });
+    }
+    
+    void toBricks(const std::vector<T>& data){
+      m_fields.resize(storedSize());
+      for (uint32_t k = 0; k < m_depth; k++) {
+        for (uint32_t j = 0; j < m_height; j++) {
+          for (uint32_t i = 0; i < m_width; i++) {
+            m_fields[index(i, j, k)] = data[i + j * m_width + k * m_sliceSize];
+          }
+        }
+      }
+    }
+    
+    size_t storedSize() const{
+      if (m_layout == ROW_MAJOR) {
+        return size_t(m_sliceSize) * m_depth;
+      }
+      return size_t(m_bricks[0]) * m_bricks[1] * m_bricks[2] * 64;
+    }
+    
+    const T* values() const{
+      return m_external != nullptr ? m_external : m_fields.data();
+    }
+    
+    size_t index(uint32_t x, uint32_t y, uint32_t z) const{
+      if (m_layout == ROW_MAJOR) {
+        return x + y * m_width + size_t(z) * m_sliceSize;
+      }
+      size_t brick = (size_t(z >> 2) * m_bricks[1] + (y >> 2)) * m_bricks[0] + (x >> 2);
+      return brick * 64 + ((z & 3) << 4 | (y & 3) << 2 | (x & 3));
+    }
+    
+    void cellCoordinate(vec3f pos, vec3u& U, vec3f& R) const{
+      gridCoordinate((pos[0] - m_gridMin[0]) * m_scale[0], m_width, U[0], R[0]);
+      gridCoordinate((pos[1] - m_gridMin[1]) * m_scale[1], m_height, U[1], R[1]);
+      gridCoordinate((pos[2] - m_gridMin[2]) * m_scale[2], m_depth, U[2], R[2]);
+    }
+    
+    void fetchCell(vec3u U, T* c) const{
+      if (m_layout == ROW_MAJOR) {
+        const T* line = values() + index(U[0], U[1], U[2]);
+        c[0] = line[0];
+        c[1] = line[1];
+        c[2] = line[m_width];
+        c[3] = line[m_width + 1];
+        line += m_sliceSize;
+        c[4] = line[0];
+        c[5] = line[1];
+        c[6] = line[m_width];
+        c[7] = line[m_width + 1];
+        return;
+      }
+      // the brick index splits in one term per axis, computed once for the two coordinates of the cell on each axis
+      size_t x[2], y[2], z[2];
+      for (uint32_t i = 0; i < 2; i++) {
+        x[i] = size_t((U[0] + i) >> 2) * 64 + ((U[0] + i) & 3);
+        y[i] = size_t((U[1] + i) >> 2) * m_bricks[0] * 64 + ((U[1] + i) & 3) * 4;
+        z[i] = size_t((U[2] + i) >> 2) * m_bricks[0] * m_bricks[1] * 64 + ((U[2] + i) & 3) * 16;
+      }
+      const T* stored = values();
+      for (uint32_t n = 0; n < 8; n++) {
+        c[n] = stored[x[n & 1] + y[(n >> 1) & 1] + z[n >> 2]];
+      }
+    }
+    
+    uint32_t        m_width;
+    uint32_t        m_height;
+    uint32_t        m_depth;
+    uint32_t        m_sliceSize;
+    vec3u           m_bricks;
+    fieldLayout     m_layout;
+    std::vector<T>  m_fields;
+    const T*        m_external = nullptr;           // values not owned by the field, used instead of m_fields when set
+    std::shared_ptr<const void> m_owner;
+    ABBox<3>        m_boundingbox;
+    vec3f           m_gridMin;
+    vec3f           m_scale;        // grid units per unit of the domain
+
+    T (*m_interpolate)(T&, T&, float);
+  };
+  
+  
+  /**
+   *Class  Field3DSparse :
+   *\brief A class that represent a 3D field sampled on a regular grid where most of the values are equal to a background value
+   * The grid is split in bricks of 8x8x8 values and only the bricks holding a value different from the background are stored, in a hash map from the brick coordinates.
+   * Sampling a cell looks its brick up in the hash map, a missing brick then reads from a single brick filled with the background.
+   * The last brick found is cached, so consecutive samples in the same brick skip the lookup, and a cell on the border of a brick is read value by value.
+   * When most bricks end up stored, toGrid gives the equivalent dense field.
+   *\tparam T  the type the Field will hold
+   */
+  template <typename T>
+  class Field3DSparse : public Field3D<T>{
+  public:
+    
+    /**
+     *\brief Create a 3D field where every value is the background, values are then set with setValue
+     *\param width the width of the grid
+     *\param height the height of the grid
+     *\param dpeth  the depth of the grid
+     *\param boundingbox the bounding box of the field in the domain
+     *\param background the value of the field where no value is stored
+     *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     */
+    Field3DSparse(uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T background, T (*interpolate)(T&, T&, float) = nullptr){
+      setup(width, height, depth, boundingbox, background, interpolate);
+    }
+    
+    /**
+     *\brief Create a 3D field from dense values, only the bricks holding a value different from the background are kept
+     *\param data a std::vector of data, ordered along x then y then z
+     *\param width the width of the grid
+     *\param height the height of the grid
+     *\param dpeth  the depth of the grid
+     *\param boundingbox the bounding box of the field in the domain
+     *\param background the value of the field where no value is stored, values are compared bitwise
+     *\param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+     */
+    Field3DSparse(const std::vector<T>& data, uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T background, T (*interpolate)(T&, T&, float) = nullptr){
+      setup(width, height, depth, boundingbox, background, interpolate);
+      for (uint32_t bz = 0; bz < m_bricks[2]; bz++) {
+        for (uint32_t by = 0; by < m_bricks[1]; by++) {
+          for (uint32_t bx = 0; bx < m_bricks[0]; bx++) {
+            T* brick = nullptr;
+            for (uint32_t n = 0; n < brickSize; n++) {
+              uint32_t x = bx * 8 + (n & 7);
+              uint32_t y = by * 8 + ((n >> 3) & 7);
+              uint32_t z = bz * 8 + (n >> 6);
+              if (x >= m_width || y >= m_height || z >= m_depth) {
+                continue;
+              }
+              const T& value = data[x + y * m_width + size_t(z) * m_width * m_height];
+              if (brick == nullptr && !isBackground(value)) {
+                brick = allocateBrick(brickKey(bx, by, bz));
+              }
+              if (brick != nullptr) {
+                brick[n] = value;
+              }
+            }
+          }
+        }
+      }
+    }
+    
+    /**
+     \brief set a value of the grid, the brick holding it is allocated if needed
+     Not thread safe, and not to be called while the field is sampled.
+     \param x the column of the value
+     \param y the row of the value
+     \param z the slice of the value
+     \param value the value
+     */
+    void setValue(uint32_t x, uint32_t y, uint32_t z, T value){
+      size_t key = brickKey(x >> 3, y >> 3, z >> 3);
+      auto found = m_brickSlots.find(key);
+      if (found == m_brickSlots.end()) {
+        if (isBackground(value)) {
+          return;
+        }
+        allocateBrick(key)[localIndex(x, y, z)] = value;
+        return;
+      }
+      m_values[found->second * brickSize + localIndex(x, y, z)] = value;
+    }
+    
+    /**
+     \brief get a value of the grid
+     \param x the column of the value
+     \param y the row of the value
+     \param z the slice of the value
+     \return the stored value, the background if its brick is not stored
+     */
+    T getValue(uint32_t x, uint32_t y, uint32_t z) const{
+      return brick(brickKey(x >> 3, y >> 3, z >> 3))[localIndex(x, y, z)];
     }
     
     /**
@@ -162,65 +763,121 @@ namespace LavaCake {
      \param pos a vec3f representing the sample position
      \return the value of the field at the position pos
      */
-    T sample(vec3f pos) override{
-      vec3f X = (pos - m_boundingbox.A()) / (m_boundingbox.B() - m_boundingbox.A());
-      X = X * vec3f({float(m_width-1), float(m_height-1), float(m_depth-1)});
-      
-      X = vec3f({fmax(0.0f, X[0]), fmax(0.0f, X[1]), fmax(0.0f, X[2])});
-      
-      vec3u U = vec3u({uint32_t(X[0]),uint32_t(X[1]), uint32_t(X[2])});
-      vec3f R = X - vec3f({float(U[0]),float(U[1]),float(U[2])});
-      
-      
-      if(U[0] >= m_width-1){
-        U[0] = m_width-2;
-        R[0] = 1.0f;
-      }
-      if(U[1] >= m_height-1){
-        U[1] = m_height-2;
-        R[1] = 1.0f;
+    T sample(vec3f pos) override final{
+      if (m_interpolate == nullptr) {
+        return sampleLinear(pos);
       }
-      if(U[2] >= m_depth-1){
-        U[2] = m_depth-2;
-        R[2] = 1.0f;
+      return sampleWith(pos, m_interpolate);
+    }
+    
+    /**
+     \brief sample the field at a postion with a trilinear interpolation
+     \param pos a vec3f representing the sample position
+     \return the value of the field at the position pos
+     */
+    T sampleLinear(vec3f pos) const{
+      vec3u U;
+      vec3f R;
+      cellCoordinate(pos, U, R);
+      T c[8];
+      BrickCache cache;
+      fetchCell(U, c, cache);
+      return trilinear(c, R[0], R[1], R[2]);
+    }
+    
+    /**
+     \brief sample the field at a postion with an interpolation function, a lambda or a functor is inlined where a function pointer is not
+     \param pos a vec3f representing the sample position
+     \param interpolate a callable T(T&, T&, float) interpolating two values
+     \return the value of the field at the position pos
+     */
+    template <typename Interpolate>
+    T sampleWith(vec3f pos, Interpolate interpolate) const{
+      vec3u U;
+      vec3f R;
+      cellCoordinate(pos, U, R);
+      T c[8];
+      BrickCache cache;
+      fetchCell(U, c, cache);
+      return interpolateCell(c, R[0], R[1], R[2], interpolate);
+    }
+    
+    /**
+     \brief sample the field on a regular grid of positions, consecutive samples of a row reuse the brick lookup of the previous one, the rows are sampled in parallel by the job system
+     \param origin the position of the first sample
+     \param step the offset between two consecutive samples along each axis
+     \param resolution the number of samples along each axis
+     \param result the samples ordered along x then y then z, resized to hold them
+     */
+    void sampleMany(vec3f origin, vec3f step, vec3u resolution, std::vector<T>& result) override{
+      result.resize(size_t(resolution[0]) * resolution[1] * resolution[2]);
+      std::vector<uint32_t> columns(resolution[0]);
+      std::vector<float> columnWeights(resolution[0]);
+      for(uint32_t i = 0; i < resolution[0]; i++){
+        gridCoordinate((origin[0] + float(i) * step[0] - m_gridMin[0]) * m_scale[0], m_width, columns[i], columnWeights[i]);
       }
       
-      T A,B,C,D,E,F,G,H;
-      A = m_fields[U[0]   +  U[1]    *m_width + U[2]    *m_width*m_height];
-      B = m_fields[U[0]+1 +  U[1]    *m_width + U[2]    *m_width*m_height];
-      C = m_fields[U[0]   + (U[1]+1) *m_width + U[2]    *m_width*m_height];
-      D = m_fields[U[0]+1 + (U[1]+1) *m_width + U[2]    *m_width*m_height];
-      E = m_fields[U[0]   +  U[1]    *m_width + (U[2]+1)*m_width*m_height];
-      F = m_fields[U[0]+1 +  U[1]    *m_width + (U[2]+1)*m_width*m_height];
-      G = m_fields[U[0]   + (U[1]+1) *m_width + (U[2]+1)*m_width*m_height];
-      H = m_fields[U[0]+1 + (U[1]+1) *m_width + (U[2]+1)*m_width*m_height];
-
-      if (m_interpolate == nullptr) {
-        T AB = B * R[0] + A * (1.0f - R[0]);
-        T CD = D * R[0] + C * (1.0f - R[0]);
-
-        T ABCD = CD * R[1] + AB * (1.0f - R[1]);
-
-        T EF = F * R[0] + E * (1.0f - R[0]);
-        T GH = H * R[0] + G * (1.0f - R[0]);
-
-        T EFGH = GH * R[1] + EF * (1.0f - R[1]);
-
-        return EFGH * R[2] + ABCD * (1.0f - R[2]);
+      JobSystem::getJobSystem()->parallelFor(0, size_t(resolution[1]) * resolution[2], 1, [&](size_t begin, size_t end){
+        for(size_t row = begin; row < end; row++){
+          size_t j = row % resolution[1];
+          size_t k = row / resolution[1];
+          vec3u U;
+          float s, t;
+          gridCoordinate((origin[1] + float(j) * step[1] - m_gridMin[1]) * m_scale[1], m_height, U[1], s);
+          gridCoordinate((origin[2] + float(k) * step[2] - m_gridMin[2]) * m_scale[2], m_depth, U[2], t);
+          T* out = &result[row * resolution[0]];
+          BrickCache cache;
+          
+          for(uint32_t i = 0; i < resolution[0]; i++){
+            U[0] = columns[i];
+            T c[8];
+            fetchCell(U, c, cache);
+            if (m_interpolate == nullptr) {
+              out[i] = trilinear(c, columnWeights[i], s, t);
+            }
+            else {
+              out[i] = interpolateCell(c, columnWeights[i], s, t, m_interpolate);
+            }
+          }
+        }
+      });
+    }
+    
+    /**
+     \brief get the values of the field
+     \return the values ordered along x then y then z, the background included
+     */
+    std::vector<T> getRawField() const{
+      std::vector<T> data(size_t(m_width) * m_height * m_depth);
+      for (uint32_t k = 0; k < m_depth; k++) {
+        for (uint32_t j = 0; j < m_height; j++) {
+          for (uint32_t i = 0; i < m_width; i++) {
+            data[i + j * m_width + size_t(k) * m_width * m_height] = getValue(i, j, k);
+          }
+        }
       }
-
-      T AB = m_interpolate(A, B, R[0]);
-      T CD = m_interpolate(A, B, R[0]);
-      T ABCD = m_interpolate(AB, CD, R[1]);
-
-      T EF = m_interpolate(E, F, R[0]);
-      T GH = m_interpolate(G, H, R[0]);
-      T EFGH = m_interpolate(EF, GH, R[1]);
-      return m_interpolate(ABCD, EFGH, R[2]);
-
+      return data;
+    }
+    
+    /**
+     \brief create the dense field holding the same values, for fields where most bricks are stored
+     \param layout [optional] the storage order of the values of the dense field
+     \return a new field the caller owns
+     */
+    Field3DGrid<T>* toGrid(fieldLayout layout = ROW_MAJOR) const{
+      return new Field3DGrid<T>(getRawField(), m_width, m_height, m_depth, m_boundingbox, m_interpolate, layout);
+    }
+    
+    /**
+     \brief get the fraction of the bricks that are stored
+     \return the number of stored bricks divided by the number of bricks of the grid
+     */
+    float getFillRatio() const{
+      return float(m_brickSlots.size()) / float(size_t(m_bricks[0]) * m_bricks[1] * m_bricks[2]);
     }
     
-    std::vector<T> getRawField(){return m_fields;};
+    uint32_t getBrickCount() const{return uint32_t(m_brickSlots.size());};
+    T getBackground() const{return m_background;};
     vec3u getDimension(){return{m_width,m_height,m_depth};};
     
     /**
@@ -230,11 +887,96 @@ namespace LavaCake {
     ABBox<3> getABBox(){return m_boundingbox;};
     
     private :
+    
+    static const uint32_t brickSize = 512;
+    
+    // last brick read while sampling, consecutive samples mostly fall in the same brick
+    struct BrickCache {
+      size_t    key = ~size_t(0);
+      const T*  brick = nullptr;
+    };
+    
+    void setup(uint32_t width, uint32_t height, uint32_t depth, ABBox<3> boundingbox, T background, T (*interpolate)(T&, T&, float)){
+      m_width = width;
+      m_height = height;
+      m_depth = depth;
+      m_boundingbox = boundingbox;
+      m_background = background;
+      m_interpolate = interpolate;
+      m_gridMin = boundingbox.A();
+      m_scale = vec3f({float(width-1), float(height-1), float(depth-1)}) / (boundingbox.B() - boundingbox.A());
+      m_bricks = vec3u({ (width + 7) / 8, (height + 7) / 8, (depth + 7) / 8 });
+      m_backgroundBrick.assign(brickSize, background);
+    }
+    
+    bool isBackground(const T& value) const{
+      return std::memcmp(&value, &m_background, sizeof(T)) == 0;
+    }
+    
+    size_t brickKey(uint32_t bx, uint32_t by, uint32_t bz) const{
+      return (size_t(bz) * m_bricks[1] + by) * m_bricks[0] + bx;
+    }
+    
+    static uint32_t localIndex(uint32_t x, uint32_t y, uint32_t z){
+      return (z & 7) << 6 | (y & 7) << 3 | (x & 7);
+    }
+    
+    T* allocateBrick(size_t key){
+      uint32_t slot = uint32_t(m_brickSlots.size());
+      m_brickSlots[key] = slot;
+      m_values.resize(size_t(slot + 1) * brickSize, m_background);
+      return &m_values[size_t(slot) * brickSize];
+    }
+    
+    const T* brick(size_t key) const{
+      auto found = m_brickSlots.find(key);
+      if (found == m_brickSlots.end()) {
+        return m_backgroundBrick.data();
+      }
+      return &m_values[size_t(found->second) * brickSize];
+    }
+    
+    void cellCoordinate(vec3f pos, vec3u& U, vec3f& R) const{
+      gridCoordinate((pos[0] - m_gridMin[0]) * m_scale[0], m_width, U[0], R[0]);
+      gridCoordinate((pos[1] - m_gridMin[1]) * m_scale[1], m_height, U[1], R[1]);
+      gridCoordinate((pos[2] - m_gridMin[2]) * m_scale[2], m_depth, U[2], R[2]);
+    }
+    
+    void fetchCell(vec3u U, T* c, BrickCache& cache) const{
+      // the cell lies in a single brick unless it touches the last layer of values of the brick
+      if ((U[0] & 7) != 7 && (U[1] & 7) != 7 && (U[2] & 7) != 7) {
+        size_t key = brickKey(U[0] >> 3, U[1] >> 3, U[2] >> 3);
+        if (key != cache.key) {
+          cache.key = key;
+          cache.brick = brick(key);
+        }
+        const T* line = cache.brick + localIndex(U[0], U[1], U[2]);
+        c[0] = line[0];
+        c[1] = line[1];
+        c[2] = line[8];
+        c[3] = line[9];
+        c[4] = line[64];
+        c[5] = line[65];
+        c[6] = line[72];
+        c[7] = line[73];
+        return;
+      }
+      for (uint32_t n = 0; n < 8; n++) {
+        c[n] = getValue(U[0] + (n & 1), U[1] + ((n >> 1) & 1), U[2] + (n >> 2));
+      }
+    }
+    
     uint32_t        m_width;
     uint32_t        m_height;
     uint32_t        m_depth;
-    std::vector<T>  m_fields;
+    vec3u           m_bricks;
+    T               m_background;
+    std::unordered_map<size_t, uint32_t> m_brickSlots;    // brick coordinates to the index of the brick in m_values
+    std::vector<T>  m_values;
+    std::vector<T>  m_backgroundBrick;
     ABBox<3>        m_boundingbox;
+    vec3f           m_gridMin;
+    vec3f           m_scale;        // grid units per unit of the domain
 
     T (*m_interpolate)(T&, T&, float);
   };
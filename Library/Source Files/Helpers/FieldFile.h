@@ -0,0 +1,138 @@
+#pragma once
+#include "Field.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace LavaCake {
+  namespace Helpers {
+
+  /**
+   * Binary volume file : a FieldFileHeader followed, at dataOffset, by the values of the grid in its storage layout.
+   * The data starts on a page boundary so the values can be read in place from a mapping of the file.
+   */
+  struct FieldFileHeader {
+    uint32_t  magic;
+    uint32_t  version;
+    uint32_t  elementType;      // see fieldElementType, 0 for types only checked by size
+    uint32_t  elementSize;      // size in byte of a value
+    uint32_t  width;
+    uint32_t  height;
+    uint32_t  depth;
+    uint32_t  layout;           // a fieldLayout
+    float     boundingBoxMin[3];
+    float     boundingBoxMax[3];
+    uint64_t  dataOffset;       // offset in byte of the first value from the start of the file
+  };
+
+  const uint32_t fieldFileMagic = 0x4656434c; // "LCVF"
+  const uint32_t fieldFileVersion = 1;
+  const uint64_t fieldFileAlignment = 4096;
+
+  /**
+   \brief identify the type of the values stored in a volume file
+   */
+  template <typename T> struct fieldElementType { static const uint32_t value = 0; };
+  template <> struct fieldElementType<float> { static const uint32_t value = 1; };
+  template <> struct fieldElementType<vec2f> { static const uint32_t value = 2; };
+  template <> struct fieldElementType<vec3f> { static const uint32_t value = 3; };
+  template <> struct fieldElementType<vec4f> { static const uint32_t value = 4; };
+
+  /**
+   \brief write a 3D grid field to a binary volume file, the values are written in the layout of the field
+   \param path the path of the file
+   \param field the field to write
+   \return true if the file could be written
+   */
+  template <typename T>
+  bool writeField3DGrid(const std::string& path, Field3DGrid<T>& field){
+    vec3u dim = field.getDimension();
+    ABBox<3> boundingbox = field.getABBox();
+    FieldView<T> values = field.getRawFieldView();
+
+    FieldFileHeader header = {};
+    header.magic = fieldFileMagic;
+    header.version = fieldFileVersion;
+    header.elementType = fieldElementType<T>::value;
+    header.elementSize = uint32_t(sizeof(T));
+    header.width = dim[0];
+    header.height = dim[1];
+    header.depth = dim[2];
+    header.layout = uint32_t(field.getLayout());
+    for (int i = 0; i < 3; i++) {
+      header.boundingBoxMin[i] = boundingbox.A()[i];
+      header.boundingBoxMax[i] = boundingbox.B()[i];
+    }
+    header.dataOffset = fieldFileAlignment;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    std::vector<char> padding(size_t(header.dataOffset - sizeof(FieldFileHeader)), 0);
+    if (!file.write(reinterpret_cast<const char*>(&header), sizeof(FieldFileHeader)) ||
+        !file.write(padding.data(), padding.size()) ||
+        !file.write(reinterpret_cast<const char*>(values.data), std::streamsize(values.size * sizeof(T)))) {
+      std::cout << "Could not write the volume file " << path << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   \brief open a binary volume file as a read only 3D grid field, the file is mapped and the values are read in place
+   Only the pages that are sampled are loaded, and they are shared with the other processes mapping the same file.
+   \param path the path of the file
+   \param interpolate [optional]  a funtion pointer to an interpolation function for the type T
+   \return a new field owning the mapping, nullptr if the file could not be opened or does not hold values of type T
+   */
+  template <typename T>
+  Field3DGrid<T>* loadField3DGrid(const std::string& path, T (*interpolate)(T&, T&, float) = nullptr){
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->open(path)) {
+      return nullptr;
+    }
+
+    FieldFileHeader header;
+    if (file->size() < sizeof(FieldFileHeader)) {
+      std::cout << "Invalid volume file " << path << std::endl;
+      return nullptr;
+    }
+    std::memcpy(&header, file->data(), sizeof(FieldFileHeader));
+    if (header.magic != fieldFileMagic || header.version != fieldFileVersion || header.layout > BRICK ||
+        header.width < 2 || header.height < 2 || header.depth < 2) {
+      std::cout << "Invalid volume file " << path << std::endl;
+      return nullptr;
+    }
+    if (header.elementSize != sizeof(T) || header.elementType != fieldElementType<T>::value) {
+      std::cout << "The volume file " << path << " does not hold values of the requested type" << std::endl;
+      return nullptr;
+    }
+
+    // every bound is checked by division, so that a forged header can not overflow it
+    if (header.dataOffset % alignof(T) != 0 || header.dataOffset > file->size()) {
+      std::cout << "Invalid volume file " << path << std::endl;
+      return nullptr;
+    }
+    uint64_t maxCount = (file->size() - header.dataOffset) / sizeof(T);
+    uint64_t sliceCount = uint64_t(header.width) * header.height;
+    if (sliceCount > maxCount || header.depth > maxCount / sliceCount) {
+      std::cout << "Invalid volume file " << path << std::endl;
+      return nullptr;
+    }
+    uint64_t count = sliceCount * header.depth;
+    if (header.layout == BRICK) {
+      count = ((uint64_t(header.width) + 3) / 4) * ((uint64_t(header.height) + 3) / 4) * ((uint64_t(header.depth) + 3) / 4) * 64;
+    }
+    if (count > maxCount) {
+      std::cout << "Invalid volume file " << path << std::endl;
+      return nullptr;
+    }
+
+    const T* values = reinterpret_cast<const T*>(static_cast<const char*>(file->data()) + header.dataOffset);
+    ABBox<3> boundingbox(vec3f({ header.boundingBoxMin[0], header.boundingBoxMin[1], header.boundingBoxMin[2] }),
+                         vec3f({ header.boundingBoxMax[0], header.boundingBoxMax[1], header.boundingBoxMax[2] }));
+    return new Field3DGrid<T>(values, header.width, header.height, header.depth, boundingbox, interpolate, fieldLayout(header.layout), file);
+  }
+
+  }
+}
@@ -0,0 +1,185 @@
+#include "JobSystem.h"
+
+namespace LavaCake {
+  namespace Helpers {
+    JobSystem* JobSystem::m_jobSystem;
+
+    static thread_local uint32_t t_threadIndex = 0;
+
+    // the queue of a thread that is not a worker, given back when the thread exits
+    struct ExternalQueue {
+      uint32_t                                            index = 0;
+      std::atomic<bool>*                                  inUse = nullptr;
+
+      ~ExternalQueue() {
+        if (inUse != nullptr) {
+          *inUse = false;
+        }
+      }
+    };
+    static thread_local ExternalQueue t_externalQueue;
+
+    JobSystem::JobSystem(uint32_t nbWorkers) {
+      m_queued = 0;
+      m_stop = false;
+      // the shared queue, one queue per worker, then the queues of the other threads
+      for (uint32_t i = 0; i <= nbWorkers + s_externalQueues; i++) {
+        m_queues.push_back(new WorkQueue());
+        m_queues.back()->inUse = i <= nbWorkers;
+      }
+      for (uint32_t i = 1; i <= nbWorkers; i++) {
+        m_workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+      }
+    }
+
+    uint32_t JobSystem::getThreadCount() {
+      return uint32_t(m_workers.size()) + 1;
+    }
+
+    uint32_t JobSystem::getThreadIndex() {
+      return t_threadIndex;
+    }
+
+    uint32_t JobSystem::getQueueIndex() {
+      if (t_threadIndex != 0) {
+        return t_threadIndex;
+      }
+      if (t_externalQueue.inUse == nullptr) {
+        for (size_t i = m_workers.size() + 1; i < m_queues.size(); i++) {
+          bool free = false;
+          if (m_queues[i]->inUse.compare_exchange_strong(free, true)) {
+            t_externalQueue.index = uint32_t(i);
+            t_externalQueue.inUse = &m_queues[i]->inUse;
+            break;
+          }
+        }
+      }
+      return t_externalQueue.index;
+    }
+
+    void JobSystem::run(const std::vector<std::function<void()>>& jobs) {
+      std::atomic<size_t> pending(jobs.size());
+      for (const std::function<void()>& job : jobs) {
+        push({ job, &pending });
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+      }
+      m_wake.notify_all();
+
+      wait(pending);
+    }
+
+    void JobSystem::parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& job) {
+      if (end <= begin) {
+        return;
+      }
+
+      size_t count = end - begin;
+      grain = grain > 0 ? grain : 1;
+      size_t nbChunks = std::min((count + grain - 1) / grain, size_t(getThreadCount()) * 4);
+      if (nbChunks <= 1) {
+        job(begin, end);
+        return;
+      }
+
+      size_t chunkSize = (count + nbChunks - 1) / nbChunks;
+      std::vector<std::function<void()>> jobs;
+      for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize) {
+        size_t chunkEnd = std::min(chunkBegin + chunkSize, end);
+        jobs.push_back([&job, chunkBegin, chunkEnd]() { job(chunkBegin, chunkEnd); });
+      }
+      run(jobs);
+    }
+
+    void JobSystem::push(Job job) {
+      WorkQueue* queue = m_queues[getQueueIndex()];
+      {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->jobs.push_back(job);
+      }
+      m_queued++;
+    }
+
+    bool JobSystem::execute(uint32_t queueIndex, bool steal) {
+      Job job;
+      bool found = false;
+
+      // newest job of our own queue first, then the oldest job of the others
+      {
+        WorkQueue* queue = m_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->jobs.size() > 0) {
+          job = queue->jobs.back();
+          queue->jobs.pop_back();
+          found = true;
+        }
+      }
+
+      for (size_t i = 1; i < m_queues.size() && steal && !found; i++) {
+        WorkQueue* queue = m_queues[(queueIndex + i) % m_queues.size()];
+        if (!queue->inUse) {
+          continue;
+        }
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->jobs.size() > 0) {
+          job = queue->jobs.front();
+          queue->jobs.pop_front();
+          found = true;
+        }
+      }
+
+      if (!found) {
+        return false;
+      }
+
+      m_queued--;
+      job.function();
+      // the waiting thread may be asleep, it is woken by the last job of its list
+      if (job.pending->fetch_sub(1) == 1) {
+        {
+          std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wake.notify_all();
+      }
+      return true;
+    }
+
+    void JobSystem::wait(const std::atomic<size_t>& pending) {
+      // a thread with its own queue that is not a worker does not steal, it must not be held up by the jobs of another thread
+      uint32_t queueIndex = getQueueIndex();
+      bool steal = t_threadIndex != 0 || queueIndex == 0;
+      while (pending > 0) {
+        if (!execute(queueIndex, steal)) {
+          std::unique_lock<std::mutex> lock(m_sleepMutex);
+          m_wake.wait(lock, [&]() { return pending == 0 || (steal && m_queued > 0); });
+        }
+      }
+    }
+
+    void JobSystem::workerLoop(uint32_t threadIndex) {
+      t_threadIndex = threadIndex;
+      while (!m_stop) {
+        if (!execute(threadIndex, true)) {
+          std::unique_lock<std::mutex> lock(m_sleepMutex);
+          m_wake.wait(lock, [this]() { return m_queued > 0 || m_stop; });
+        }
+      }
+    }
+
+    JobSystem::~JobSystem() {
+      m_stop = true;
+      {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+      }
+      m_wake.notify_all();
+      for (std::thread& worker : m_workers) {
+        worker.join();
+      }
+      for (WorkQueue* queue : m_queues) {
+        delete queue;
+      }
+      t_externalQueue.inUse = nullptr;
+    }
+  }
+}
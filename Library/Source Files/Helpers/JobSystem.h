@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LavaCake {
+  namespace Helpers {
+
+  /**
+   Class JobSystem :
+   \brief A pool of worker threads executing jobs with work stealing
+   Every thread owns a queue, jobs are pushed to the queue of the submitting thread and idle workers steal from the others.
+   Threads that are not workers get their own queue on their first submission, when all of them are taken they share one.
+   Threads waiting for their jobs execute the pending jobs of their queue, workers also steal, so jobs can themselves submit and wait for jobs.
+   When there is nothing left to execute they sleep until their jobs are completed or new jobs are submitted.
+   This class is a singleton
+   */
+    class JobSystem {
+      static JobSystem* m_jobSystem;
+      JobSystem(uint32_t nbWorkers);
+
+    public:
+
+      /**
+       \brief Return the job system, created with one worker per hardware thread minus one on first call
+       \return a static reference to the job system
+       */
+      static JobSystem* getJobSystem() {
+        if (!m_jobSystem) {
+          uint32_t hardware = std::thread::hardware_concurrency();
+          m_jobSystem = new JobSystem(hardware > 1 ? hardware - 1 : 0);
+        }
+        return m_jobSystem;
+      }
+
+      /**
+       \brief Return the number of threads that can execute jobs, the workers plus the calling thread
+       \return the number of threads
+       */
+      uint32_t getThreadCount();
+
+      /**
+       \brief Return the index of the calling thread, 0 for threads that are not workers and 1 to getThreadCount() - 1 for workers
+       \return the index of the thread
+       */
+      static uint32_t getThreadIndex();
+
+      /**
+       \brief Execute a list of jobs and wait for all of them to be completed
+       \param jobs : the jobs to execute
+       */
+      void run(const std::vector<std::function<void()>>& jobs);
+
+      /**
+       \brief Split a range in chunks executed in parallel and wait for all of them to be completed
+       \param begin : the first index of the range
+       \param end : the index past the last element of the range
+       \param grain : the minimum number of elements of a chunk
+       \param job : the function called on each chunk [chunkBegin, chunkEnd)
+       */
+      void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& job);
+
+      ~JobSystem();
+
+    private :
+
+      struct Job {
+        std::function<void()>                             function;
+        std::atomic<size_t>*                              pending;
+      };
+
+      struct WorkQueue {
+        std::mutex                                        mutex;
+        std::deque<Job>                                   jobs;
+        std::atomic<bool>                                 inUse;
+      };
+
+      // the number of queues for the threads that are not workers, the ones that come after share the queue 0
+      static const uint32_t                               s_externalQueues = 16;
+
+      uint32_t getQueueIndex();
+      void push(Job job);
+      bool execute(uint32_t queueIndex, bool steal);
+      void wait(const std::atomic<size_t>& pending);
+      void workerLoop(uint32_t threadIndex);
+
+      std::vector<std::thread>                            m_workers;
+      std::vector<WorkQueue*>                             m_queues;
+      std::atomic<size_t>                                 m_queued;
+      std::atomic<bool>                                   m_stop;
+      std::mutex                                          m_sleepMutex;
+      std::condition_variable                             m_wake;
+    };
+  }
+}
@@ -0,0 +1,97 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LavaCake {
+  namespace Helpers {
+
+    bool MappedFile::open(const std::string& path) {
+      close();
+
+#ifdef _WIN32
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (file == INVALID_HANDLE_VALUE) {
+        std::cout << "Could not open " << path << std::endl;
+        return false;
+      }
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        std::cout << "Could not map " << path << std::endl;
+        CloseHandle(file);
+        return false;
+      }
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      // the view keeps the mapping and the file alive, the handles are not needed anymore
+      CloseHandle(file);
+      if (mapping == nullptr) {
+        std::cout << "Could not map " << path << std::endl;
+        return false;
+      }
+      m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+      if (m_data == nullptr) {
+        std::cout << "Could not map " << path << std::endl;
+        return false;
+      }
+      m_size = size_t(size.QuadPart);
+#else
+      int descriptor = ::open(path.c_str(), O_RDONLY);
+      if (descriptor < 0) {
+        std::cout << "Could not open " << path << std::endl;
+        return false;
+      }
+      struct stat status;
+      if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        std::cout << "Could not map " << path << std::endl;
+        ::close(descriptor);
+        return false;
+      }
+      void* data = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+      // the mapping keeps the file alive, the descriptor is not needed anymore
+      ::close(descriptor);
+      if (data == MAP_FAILED) {
+        std::cout << "Could not map " << path << std::endl;
+        return false;
+      }
+      m_data = data;
+      m_size = size_t(status.st_size);
+#endif
+      return true;
+    }
+
+    void MappedFile::close() {
+      if (m_data == nullptr) {
+        return;
+      }
+#ifdef _WIN32
+      UnmapViewOfFile(m_data);
+#else
+      munmap(m_data, m_size);
+#endif
+      m_data = nullptr;
+      m_size = 0;
+    }
+
+    const void* MappedFile::data() const {
+      return m_data;
+    }
+
+    size_t MappedFile::size() const {
+      return m_size;
+    }
+
+    MappedFile::~MappedFile() {
+      close();
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace LavaCake {
+  namespace Helpers {
+
+  /**
+   Class MappedFile :
+   \brief A file mapped read only in memory, pages are only loaded when they are read and are shared with the other processes mapping the same file
+   */
+    class MappedFile {
+    public:
+
+      MappedFile() {};
+
+      /**
+       \brief Map a file, a file already mapped by this object is unmapped first
+       \param path : the path of the file
+       \return true if the file could be mapped
+       */
+      bool open(const std::string& path);
+
+      /**
+       \brief Unmap the file, the pointers returned by data become invalid
+       */
+      void close();
+
+      /**
+       \brief Return the content of the file
+       \return a pointer to the first byte of the file, nullptr if no file is mapped
+       */
+      const void* data() const;
+
+      /**
+       \brief Return the size of the file
+       \return the size in byte
+       */
+      size_t size() const;
+
+      ~MappedFile();
+
+    private :
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      void*                                               m_data = nullptr;
+      size_t                                              m_size = 0;
+    };
+  }
+}
@@ -1,55 +1,126 @@
 #include "basics.h"
+#include "simd.h"
+#include "Helpers/JobSystem.h"
 
 namespace LavaCake {
 
-float Deg2Rad(float value) {
-  return value * 0.01745329251994329576923690768489f;
-}
+#if defined(MATH_SSE)
 
-float Dot(vec3f const& left,
-          vec3f const& right) {
-  return dot(left,right);
+mat4 operator* (mat4 const& left,
+                mat4 const& right) {
+  // each column of the result is a combination of the columns of left weighted by a column of right
+  __m128 c0 = _mm_loadu_ps(&left[0]);
+  __m128 c1 = _mm_loadu_ps(&left[4]);
+  __m128 c2 = _mm_loadu_ps(&left[8]);
+  __m128 c3 = _mm_loadu_ps(&left[12]);
+  
+  mat4 result;
+  for (int j = 0; j < 4; j++) {
+    __m128 weights = _mm_loadu_ps(&right[4 * j]);
+    __m128 column = _mm_mul_ps(c0, _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(0, 0, 0, 0)));
+    column = _mm_add_ps(column, _mm_mul_ps(c1, _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(1, 1, 1, 1))));
+    column = _mm_add_ps(_mm_mul_ps(c2, _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(2, 2, 2, 2))), column);
+    column = _mm_add_ps(column, _mm_mul_ps(c3, _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(3, 3, 3, 3))));
+    _mm_storeu_ps(&result[4 * j], column);
+  }
+  return result;
 }
 
-vec3f cross(vec3f const& left,
-            vec3f const& right) {
-  return  vec3f({
-    left[1] * right[2] - left[2] * right[1],
-    left[2] * right[0] - left[0] * right[2],
-    left[0] * right[1] - left[1] * right[0]
-  });
-}
-vec3f Cross(vec3f const& left,
-            vec3f const& right) {
-  return  cross(left, right);
+// products of 2x2 matrices stored in a register as (m00, m01, m10, m11)
+static inline __m128 Mat2Mul(__m128 a, __m128 b) {
+  return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+                    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
 }
 
-vec3f Normalize(vec3f const& vector) {
-  return normalize(vector);
+// adjugate(a) * b
+static inline __m128 Mat2AdjMul(__m128 a, __m128 b) {
+  return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
 }
 
-
-vec3f operator* (vec3f const& left,
-                 mat4 const& right) {
-  return vec3f({
-    left[0] * right[0] + left[1] * right[1] + left[2] * right[2],
-    left[0] * right[4] + left[1] * right[5] + left[2] * right[6],
-    left[0] * right[8] + left[1] * right[9] + left[2] * right[10]
-  });
+// a * adjugate(b)
+static inline __m128 Mat2MulAdj(__m128 a, __m128 b) {
+  return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+                    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
 }
 
-bool operator== (vec3f const& left,
-                 vec3f const& right) {
-  if ((std::abs(left[0] - right[0]) > 0.00001f) ||
-      (std::abs(left[1] - right[1]) > 0.00001f) ||
-      (std::abs(left[2] - right[2]) > 0.00001f)) {
-    return false;
+mat4 inverse(const mat4& m) {
+  // block inversion on the 2x2 sub matrices A B / C D, the inverse of the transpose is the transpose of the inverse
+  // so the columns can be used as rows
+  __m128 c0 = _mm_loadu_ps(&m[0]);
+  __m128 c1 = _mm_loadu_ps(&m[4]);
+  __m128 c2 = _mm_loadu_ps(&m[8]);
+  __m128 c3 = _mm_loadu_ps(&m[12]);
+  
+  __m128 A = _mm_movelh_ps(c0, c1);
+  __m128 B = _mm_movehl_ps(c1, c0);
+  __m128 C = _mm_movelh_ps(c2, c3);
+  __m128 D = _mm_movehl_ps(c3, c2);
+  
+  // determinants of A, B, C and D
+  __m128 detSub = _mm_sub_ps(
+    _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+    _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0)))
+  );
+  __m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+  __m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+  __m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+  __m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+  
+  __m128 D_C = Mat2AdjMul(D, C);
+  __m128 A_B = Mat2AdjMul(A, B);
+  // adjugates of the blocks of the inverse
+  __m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, D_C));
+  __m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, A_B));
+  __m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, A_B));
+  __m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, D_C));
+  
+  // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+  __m128 tr = _mm_mul_ps(A_B, _mm_shuffle_ps(D_C, D_C, _MM_SHUFFLE(3, 1, 2, 0)));
+  tr = _mm_add_ps(tr, _mm_movehl_ps(tr, tr));
+  tr = _mm_add_ss(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 1, 1, 1)));
+  __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(0, 0, 0, 0)));
+  
+  if (_mm_cvtss_f32(detM) == 0.0f) {
+    return mat4();
   }
-  else {
-    return true;
+  __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+  X_ = _mm_mul_ps(X_, rDetM);
+  Y_ = _mm_mul_ps(Y_, rDetM);
+  Z_ = _mm_mul_ps(Z_, rDetM);
+  W_ = _mm_mul_ps(W_, rDetM);
+  
+  mat4 invM;
+  _mm_storeu_ps(&invM[0], _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(1, 3, 1, 3)));
+  _mm_storeu_ps(&invM[4], _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(0, 2, 0, 2)));
+  _mm_storeu_ps(&invM[8], _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(1, 3, 1, 3)));
+  _mm_storeu_ps(&invM[12], _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(0, 2, 0, 2)));
+  return invM;
+}
+
+#elif defined(MATH_NEON)
+
+mat4 operator* (mat4 const& left,
+                mat4 const& right) {
+  // each column of the result is a combination of the columns of left weighted by a column of right
+  float32x4_t c0 = vld1q_f32(&left[0]);
+  float32x4_t c1 = vld1q_f32(&left[4]);
+  float32x4_t c2 = vld1q_f32(&left[8]);
+  float32x4_t c3 = vld1q_f32(&left[12]);
+  
+  mat4 result;
+  for (int j = 0; j < 4; j++) {
+    float32x4_t column = vmulq_n_f32(c0, right[4 * j]);
+    column = vmlaq_n_f32(column, c1, right[4 * j + 1]);
+    column = vmlaq_n_f32(column, c2, right[4 * j + 2]);
+    column = vmlaq_n_f32(column, c3, right[4 * j + 3]);
+    vst1q_f32(&result[4 * j], column);
   }
+  return result;
 }
 
+#else
+
 mat4 operator* (mat4 const& left,
                 mat4 const& right) {
   return mat4({
@@ -75,144 +146,15 @@ mat4 operator* (mat4 const& left,
   });
 }
 
+#endif
 
-mat4 inverse(mat4& m) {
-  float inv[16], det;
-  int i;
-  
-  mat4 invM;
-  
-  inv[0] = m[5] * m[10] * m[15] -
-  m[5] * m[11] * m[14] -
-  m[9] * m[6] * m[15] +
-  m[9] * m[7] * m[14] +
-  m[13] * m[6] * m[11] -
-  m[13] * m[7] * m[10];
-  
-  inv[4] = -m[4] * m[10] * m[15] +
-  m[4] * m[11] * m[14] +
-  m[8] * m[6] * m[15] -
-  m[8] * m[7] * m[14] -
-  m[12] * m[6] * m[11] +
-  m[12] * m[7] * m[10];
-  
-  inv[8] = m[4] * m[9] * m[15] -
-  m[4] * m[11] * m[13] -
-  m[8] * m[5] * m[15] +
-  m[8] * m[7] * m[13] +
-  m[12] * m[5] * m[11] -
-  m[12] * m[7] * m[9];
-  
-  inv[12] = -m[4] * m[9] * m[14] +
-  m[4] * m[10] * m[13] +
-  m[8] * m[5] * m[14] -
-  m[8] * m[6] * m[13] -
-  m[12] * m[5] * m[10] +
-  m[12] * m[6] * m[9];
-  
-  inv[1] = -m[1] * m[10] * m[15] +
-  m[1] * m[11] * m[14] +
-  m[9] * m[2] * m[15] -
-  m[9] * m[3] * m[14] -
-  m[13] * m[2] * m[11] +
-  m[13] * m[3] * m[10];
-  
-  inv[5] = m[0] * m[10] * m[15] -
-  m[0] * m[11] * m[14] -
-  m[8] * m[2] * m[15] +
-  m[8] * m[3] * m[14] +
-  m[12] * m[2] * m[11] -
-  m[12] * m[3] * m[10];
-  
-  inv[9] = -m[0] * m[9] * m[15] +
-  m[0] * m[11] * m[13] +
-  m[8] * m[1] * m[15] -
-  m[8] * m[3] * m[13] -
-  m[12] * m[1] * m[11] +
-  m[12] * m[3] * m[9];
-  
-  inv[13] = m[0] * m[9] * m[14] -
-  m[0] * m[10] * m[13] -
-  m[8] * m[1] * m[14] +
-  m[8] * m[2] * m[13] +
-  m[12] * m[1] * m[10] -
-  m[12] * m[2] * m[9];
-  
-  inv[2] = m[1] * m[6] * m[15] -
-  m[1] * m[7] * m[14] -
-  m[5] * m[2] * m[15] +
-  m[5] * m[3] * m[14] +
-  m[13] * m[2] * m[7] -
-  m[13] * m[3] * m[6];
-  
-  inv[6] = -m[0] * m[6] * m[15] +
-  m[0] * m[7] * m[14] +
-  m[4] * m[2] * m[15] -
-  m[4] * m[3] * m[14] -
-  m[12] * m[2] * m[7] +
-  m[12] * m[3] * m[6];
-  
-  inv[10] = m[0] * m[5] * m[15] -
-  m[0] * m[7] * m[13] -
-  m[4] * m[1] * m[15] +
-  m[4] * m[3] * m[13] +
-  m[12] * m[1] * m[7] -
-  m[12] * m[3] * m[5];
-  
-  inv[14] = -m[0] * m[5] * m[14] +
-  m[0] * m[6] * m[13] +
-  m[4] * m[1] * m[14] -
-  m[4] * m[2] * m[13] -
-  m[12] * m[1] * m[6] +
-  m[12] * m[2] * m[5];
-  
-  inv[3] = -m[1] * m[6] * m[11] +
-  m[1] * m[7] * m[10] +
-  m[5] * m[2] * m[11] -
-  m[5] * m[3] * m[10] -
-  m[9] * m[2] * m[7] +
-  m[9] * m[3] * m[6];
-  
-  inv[7] = m[0] * m[6] * m[11] -
-  m[0] * m[7] * m[10] -
-  m[4] * m[2] * m[11] +
-  m[4] * m[3] * m[10] +
-  m[8] * m[2] * m[7] -
-  m[8] * m[3] * m[6];
-  
-  inv[11] = -m[0] * m[5] * m[11] +
-  m[0] * m[7] * m[9] +
-  m[4] * m[1] * m[11] -
-  m[4] * m[3] * m[9] -
-  m[8] * m[1] * m[7] +
-  m[8] * m[3] * m[5];
-  
-  inv[15] = m[0] * m[5] * m[10] -
-  m[0] * m[6] * m[9] -
-  m[4] * m[1] * m[10] +
-  m[4] * m[2] * m[9] +
-  m[8] * m[1] * m[6] -
-  m[8] * m[2] * m[5];
-  
-  det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
-  
-  if (det == 0)
-    return invM;
-  
-  det = 1.0 / det;
-  
-  for (i = 0; i < 16; i++)
-    invM[i] = inv[i] * det;
-  
-  return invM;
-  
-}
+#if !defined(MATH_SSE)
 
 mat4 inverse(const mat4& m) {
   float inv[16], det;
   int i;
   
-  mat4 invM;
+  mat4 invM = mat4();
   
   inv[0] = m[5] * m[10] * m[15] -
   m[5] * m[11] * m[14] -
@@ -340,145 +282,167 @@ mat4 inverse(const mat4& m) {
   
 }
 
+#endif
 
-mat4 Identity() {
-  mat4 I = mat4({
-    1,0,0,0,
-    0,1,0,0,
-    0,0,1,0,
-    0,0,0,1
+mat4 inverse(mat4& m) {
+  return inverse(static_cast<const mat4&>(m));
+}
+
+#if defined(MATH_SSE)
+
+vec3f transformPoint(mat4 const& matrix,
+                     vec3f const& point) {
+  __m128 r = _mm_add_ps(_mm_loadu_ps(&matrix[12]), _mm_mul_ps(_mm_loadu_ps(&matrix[0]), _mm_set1_ps(point[0])));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&matrix[4]), _mm_set1_ps(point[1])));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&matrix[8]), _mm_set1_ps(point[2])));
+  float result[4];
+  _mm_storeu_ps(result, r);
+  return vec3f({ result[0], result[1], result[2] });
+}
+
+std::array<float, 12> affineRows(mat4 const& matrix) {
+  __m128 c0 = _mm_loadu_ps(&matrix[0]);
+  __m128 c1 = _mm_loadu_ps(&matrix[4]);
+  __m128 c2 = _mm_loadu_ps(&matrix[8]);
+  __m128 c3 = _mm_loadu_ps(&matrix[12]);
+  _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+  std::array<float, 12> rows;
+  _mm_storeu_ps(&rows[0], c0);
+  _mm_storeu_ps(&rows[4], c1);
+  _mm_storeu_ps(&rows[8], c2);
+  return rows;
+}
+
+#else
+
+vec3f transformPoint(mat4 const& matrix,
+                     vec3f const& point) {
+  return vec3f({
+    matrix[0] * point[0] + matrix[4] * point[1] + matrix[8] * point[2] + matrix[12],
+    matrix[1] * point[0] + matrix[5] * point[1] + matrix[9] * point[2] + matrix[13],
+    matrix[2] * point[0] + matrix[6] * point[1] + matrix[10] * point[2] + matrix[14]
   });
-  return I;
 }
 
-mat4 PrepareTranslationMatrix(float x,
-                              float y,
-                              float z) {
-  mat4 translation_matrix = mat4({
-    1.0f, 0.0f, 0.0f, 0.0f,
-    0.0f, 1.0f, 0.0f, 0.0f,
-    0.0f, 0.0f, 1.0f, 0.0f,
-    x,    y,    z, 1.0f
+std::array<float, 12> affineRows(mat4 const& matrix) {
+  std::array<float, 12> rows;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 4; j++) {
+      rows[4 * i + j] = matrix[4 * j + i];
+    }
+  }
+  return rows;
+}
+
+#endif
+
+mat4 normalMatrix(mat4 const& matrix) {
+  // the inverse transpose is the cofactor matrix divided by the determinant, the scale does not matter for normals but its sign does
+  vec3f c0 = vec3f({ matrix[0], matrix[1], matrix[2] });
+  vec3f c1 = vec3f({ matrix[4], matrix[5], matrix[6] });
+  vec3f c2 = vec3f({ matrix[8], matrix[9], matrix[10] });
+  vec3f n0 = cross(c1, c2);
+  vec3f n1 = cross(c2, c0);
+  vec3f n2 = cross(c0, c1);
+  float sign = dot(c0, n0) < 0.0f ? -1.0f : 1.0f;
+  return mat4({
+    sign * n0[0], sign * n0[1], sign * n0[2], 0.0f,
+    sign * n1[0], sign * n1[1], sign * n1[2], 0.0f,
+    sign * n2[0], sign * n2[1], sign * n2[2], 0.0f,
+    0.0f,         0.0f,         0.0f,         1.0f
   });
-  return translation_matrix;
 }
 
-mat4 PrepareRotationMatrix(float           angle,
-                           vec3f const & axis,
-                           float           normalize_axis) {
-  float x;
-  float y;
-  float z;
-  
-  if (normalize_axis) {
-    vec3f normalized = Normalize(axis);
-    x = normalized[0];
-    y = normalized[1];
-    z = normalized[2];
+// below this number of vertices a batch is transformed on the calling thread
+static const size_t batchGrain = 16384;
+
+template<bool translate, bool normalized>
+static void transformRange(mat4 const& matrix,
+                           float* data,
+                           size_t begin,
+                           size_t end,
+                           size_t stride) {
+#if defined(MATH_SSE)
+  __m128 c0 = _mm_loadu_ps(&matrix[0]);
+  __m128 c1 = _mm_loadu_ps(&matrix[4]);
+  __m128 c2 = _mm_loadu_ps(&matrix[8]);
+  __m128 c3 = translate ? _mm_loadu_ps(&matrix[12]) : _mm_setzero_ps();
+  for (size_t i = begin; i < end; i++) {
+    float* v = data + i * stride;
+    __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(v[0])), _mm_mul_ps(c1, _mm_set1_ps(v[1]))),
+                          _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(v[2])), c3));
+    float result[4];
+    _mm_storeu_ps(result, r);
+    float scale = 1.0f;
+    if (normalized) {
+      float length = result[0] * result[0] + result[1] * result[1] + result[2] * result[2];
+      scale = length > 0.0f ? 1.0f / sqrtf(length) : 1.0f;
+    }
+    v[0] = result[0] * scale;
+    v[1] = result[1] * scale;
+    v[2] = result[2] * scale;
   }
-  else {
-    x = axis[0];
-    y = axis[1];
-    z = axis[2];
+#else
+  const float* m = matrix.data();
+  for (size_t i = begin; i < end; i++) {
+    float* v = data + i * stride;
+    float x = m[0] * v[0] + m[4] * v[1] + m[8] * v[2];
+    float y = m[1] * v[0] + m[5] * v[1] + m[9] * v[2];
+    float z = m[2] * v[0] + m[6] * v[1] + m[10] * v[2];
+    if (translate) {
+      x += m[12];
+      y += m[13];
+      z += m[14];
+    }
+    float scale = 1.0f;
+    if (normalized) {
+      float length = x * x + y * y + z * z;
+      scale = length > 0.0f ? 1.0f / sqrtf(length) : 1.0f;
+    }
+    v[0] = x * scale;
+    v[1] = y * scale;
+    v[2] = z * scale;
   }
-  
-  const float c = cos(Deg2Rad(angle));
-  const float _1_c = 1.0f - c;
-  const float s = sin(Deg2Rad(angle));
-  
-  mat4 rotation_matrix = mat4({
-    x * x * _1_c + c,
-    y * x * _1_c - z * s,
-    z * x * _1_c + y * s,
-    0.0f,
-    
-    x * y * _1_c + z * s,
-    y * y * _1_c + c,
-    z * y * _1_c - x * s,
-    0.0f,
-    
-    x * z * _1_c - y * s,
-    y * z * _1_c + x * s,
-    z * z * _1_c + c,
-    0.0f,
-    
-    0.0f,
-    0.0f,
-    0.0f,
-    1.0f
-  });
-  return rotation_matrix;
+#endif
 }
 
-mat4 PrepareScalingMatrix(float x,
-                          float y,
-                          float z) {
-  mat4 scaling_matrix = mat4({
-    x, 0.0f, 0.0f, 0.0f,
-    0.0f,    y, 0.0f, 0.0f,
-    0.0f, 0.0f,    z, 0.0f,
-    0.0f, 0.0f, 0.0f, 1.0f
+template<bool translate, bool normalized>
+static void transformBatch(mat4 const& matrix,
+                           float* data,
+                           size_t count,
+                           size_t stride) {
+  if (count <= batchGrain) {
+    transformRange<translate, normalized>(matrix, data, 0, count, stride);
+    return;
+  }
+  Helpers::JobSystem::getJobSystem()->parallelFor(0, count, batchGrain, [&](size_t begin, size_t end) {
+    transformRange<translate, normalized>(matrix, data, begin, end, stride);
   });
-  return scaling_matrix;
 }
 
-mat4 PreparePerspectiveProjectionMatrix(float aspect_ratio,
-                                        float field_of_view,
-                                        float near_plane,
-                                        float far_plane) {
-  float f = 1.0f / tan(Deg2Rad(0.5f * field_of_view));
-  
-  mat4 perspective_projection_matrix = mat4({
-    f / aspect_ratio,
-    0.0f,
-    0.0f,
-    0.0f,
-    
-    0.0f,
-    -f,
-    0.0f,
-    0.0f,
-    
-    0.0f,
-    0.0f,
-    far_plane / (near_plane - far_plane),
-    -1.0f,
-    
-    0.0f,
-    0.0f,
-    (near_plane * far_plane) / (near_plane - far_plane),
-    0.0f
-  });
-  return perspective_projection_matrix;
+void transformPositions(mat4 const& matrix,
+                        float* positions,
+                        size_t count,
+                        size_t stride) {
+  transformBatch<true, false>(matrix, positions, count, stride);
 }
 
-mat4 PrepareOrthographicProjectionMatrix(float left_plane,
-                                         float right_plane,
-                                         float bottom_plane,
-                                         float top_plane,
-                                         float near_plane,
-                                         float far_plane) {
-  mat4 orthographic_projection_matrix = mat4({
-    2.0f / (right_plane - left_plane),
-    0.0f,
-    0.0f,
-    0.0f,
-    
-    0.0f,
-    2.0f / (bottom_plane - top_plane),
-    0.0f,
-    0.0f,
-    
-    0.0f,
-    0.0f,
-    1.0f / (near_plane - far_plane),
-    0.0f,
-    
-    -(right_plane + left_plane) / (right_plane - left_plane),
-    -(bottom_plane + top_plane) / (bottom_plane - top_plane),
-    near_plane / (near_plane - far_plane),
-    1.0f
-  });
-  return orthographic_projection_matrix;
+void transformNormals(mat4 const& matrix,
+                      float* normals,
+                      size_t count,
+                      size_t stride) {
+  transformBatch<false, true>(normalMatrix(matrix), normals, count, stride);
 }
+
+// the header math is checked at compile time
+static_assert(Deg2Rad(180.0f) > 3.14159f && Deg2Rad(180.0f) < 3.14160f, "Deg2Rad");
+static_assert(dot(vec3f({ 1.0f, 2.0f, 3.0f }), vec3f({ 4.0f, -5.0f, 6.0f })) == 12.0f, "dot");
+static_assert(cross(vec3f({ 1.0f, 0.0f, 0.0f }), vec3f({ 0.0f, 1.0f, 0.0f })) == vec3f({ 0.0f, 0.0f, 1.0f }), "cross");
+static_assert(vec3f({ 1.0f, 2.0f, 3.0f }) + vec3f({ 1.0f, 1.0f, 1.0f }) == vec3f({ 2.0f, 3.0f, 4.0f }), "operator+");
+static_assert(vec3f({ 1.0f, 2.0f, 3.0f }) * 2.0f == vec3f({ 2.0f, 4.0f, 6.0f }), "operator*");
+static_assert(Identity()[0] == 1.0f && Identity()[1] == 0.0f && Identity()[15] == 1.0f, "Identity");
+static_assert(PrepareTranslationMatrix(1.0f, 2.0f, 3.0f)[13] == 2.0f, "PrepareTranslationMatrix");
+static_assert(vec3f({ 1.0f, 1.0f, 1.0f }) * PrepareScalingMatrix(2.0f, 3.0f, 4.0f) == vec3f({ 2.0f, 3.0f, 4.0f }), "PrepareScalingMatrix");
+static_assert(PrepareOrthographicProjectionMatrix(-1.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f)[10] == -1.0f, "PrepareOrthographicProjectionMatrix");
+
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 #include <array>
 #include <tuple>
 
@@ -29,81 +30,81 @@ namespace LavaCake {
   using mat4 = std::array<float, 16>;
 
 
-  template<typename T, unsigned long N>
-  std::array<T, N> operator*(const std::array<T, N>& b, const T a) {
-    std::array<T, N> d = std::array<T, N>();
-    for (unsigned char i = 0; i < N; i++) {
+  template<typename T, size_t N>
+  constexpr std::array<T, N> operator*(const std::array<T, N>& b, const T a) {
+    std::array<T, N> d = {};
+    for (size_t i = 0; i < N; i++) {
       d[i] = b[i] * a;
     }
-    return std::array<T, N>(d);
+    return d;
   }
 
-  template<typename T, unsigned long N>
-  std::array<T, N> operator*(const T a, const std::array<T, N>& b) {
-    std::array<T, N> d = std::array<T, N>();
-    for (unsigned char i = 0; i < N; i++) {
+  template<typename T, size_t N>
+  constexpr std::array<T, N> operator*(const T a, const std::array<T, N>& b) {
+    std::array<T, N> d = {};
+    for (size_t i = 0; i < N; i++) {
       d[i] = b[i] * a;
     }
-    return std::array<T, N>(d);
+    return d;
   }
 
-  template<typename T, unsigned long N>
-  std::array<T, N> operator*(const std::array<T, N>& a, const std::array<T, N>& b) {
-    std::array<T, N> d = std::array<T, N>();
-    for (unsigned char i = 0; i < N; i++) {
+  template<typename T, size_t N>
+  constexpr std::array<T, N> operator*(const std::array<T, N>& a, const std::array<T, N>& b) {
+    std::array<T, N> d = {};
+    for (size_t i = 0; i < N; i++) {
       d[i] = b[i] * a[i];
     }
-    return std::array<T, N>(d);
+    return d;
   }
 
-  template<typename T, unsigned long N>
-  std::array<T, N> operator/(const std::array<T, N>& a, const std::array<T, N>& b) {
-    std::array<T, N> d = std::array<T, N>();
-    for (unsigned char i = 0; i < N; i++) {
+  template<typename T, size_t N>
+  constexpr std::array<T, N> operator/(const std::array<T, N>& a, const std::array<T, N>& b) {
+    std::array<T, N> d = {};
+    for (size_t i = 0; i < N; i++) {
       d[i] = a[i] / b[i];
     }
-    return std::array<T, N>(d);
+    return d;
   }
 
-  template<typename T, unsigned long N>
-  std::array<T, N> operator/(const std::array<T, N>& b, const T a) {
-    std::array<T, N> d = std::array<T, N>();
-    for (unsigned char i = 0; i < N; i++) {
+  template<typename T, size_t N>
+  constexpr std::array<T, N> operator/(const std::array<T, N>& b, const T a) {
+    std::array<T, N> d = {};
+    for (size_t i = 0; i < N; i++) {
       d[i] = b[i] / a;
     }
-    return std::array<T, N>(d);
+    return d;
   }
 
 
-  template<typename T, unsigned long N>
-  std::array<T, N> operator-(const std::array<T, N> a, const std::array<T, N> b) {
-    std::array<T, N> d = std::array<T, N>();
-    for (unsigned char i = 0; i < N; i++) {
+  template<typename T, size_t N>
+  constexpr std::array<T, N> operator-(const std::array<T, N>& a, const std::array<T, N>& b) {
+    std::array<T, N> d = {};
+    for (size_t i = 0; i < N; i++) {
       d[i] = a[i] - b[i];
     }
-    return std::array<T, N>(d);
+    return d;
   }
 
-  template<typename T, unsigned long N>
-  std::array<T, N> operator+(const std::array<T, N> a, const std::array<T, N> b) {
-    std::array<T, N> d = std::array<T, N>();
-    for (unsigned char i = 0; i < N; i++) {
+  template<typename T, size_t N>
+  constexpr std::array<T, N> operator+(const std::array<T, N>& a, const std::array<T, N>& b) {
+    std::array<T, N> d = {};
+    for (size_t i = 0; i < N; i++) {
       d[i] = a[i] + b[i];
     }
-    return std::array<T, N>(d);
+    return d;
   }
 
-  template<typename T, unsigned long N>
-  T dot(std::array<T, N> const & left,
-        std::array<T, N> const & right ){
+  template<typename T, size_t N>
+  constexpr T dot(std::array<T, N> const & left,
+                  std::array<T, N> const & right ){
     T sum = static_cast<T>(0);
-    for(unsigned long u = 0; u< N ; u++){
+    for(size_t u = 0; u< N ; u++){
       sum +=  left[u] * right[u];
     }
     return sum;
   };
 
-  template<typename T, unsigned long N>
+  template<typename T, size_t N>
   std::array<T, N> normalize(std::array<T, N> const vector) {
     float length = dot(vector,vector);
     if (length >0)
@@ -111,25 +112,53 @@ namespace LavaCake {
     return vector;
   }
 
-  float Deg2Rad(float value);
+  constexpr float Deg2Rad(float value) {
+    return value * 0.01745329251994329576923690768489f;
+  }
 
-  float Dot(vec3f const& left,
-            vec3f const& right) ;
+  constexpr float Dot(vec3f const& left,
+                      vec3f const& right) {
+    return dot(left, right);
+  }
 
-  vec3f cross(vec3f const& left,
-              vec3f const& right) ;
+  constexpr vec3f cross(vec3f const& left,
+                        vec3f const& right) {
+    return vec3f({
+      left[1] * right[2] - left[2] * right[1],
+      left[2] * right[0] - left[0] * right[2],
+      left[0] * right[1] - left[1] * right[0]
+    });
+  }
 
-  vec3f Cross(vec3f const& left,
-              vec3f const& right) ;
+  constexpr vec3f Cross(vec3f const& left,
+                        vec3f const& right) {
+    return cross(left, right);
+  }
 
-  vec3f Normalize(vec3f const& vector) ;
+  inline vec3f Normalize(vec3f const& vector) {
+    return normalize(vector);
+  }
 
 
-  vec3f operator* (vec3f const& left,
-                   mat4 const& right) ;
+  constexpr vec3f operator* (vec3f const& left,
+                             mat4 const& right) {
+    return vec3f({
+      left[0] * right[0] + left[1] * right[1] + left[2] * right[2],
+      left[0] * right[4] + left[1] * right[5] + left[2] * right[6],
+      left[0] * right[8] + left[1] * right[9] + left[2] * right[10]
+    });
+  }
 
-  bool operator== (vec3f const& left,
-                   vec3f const& right) ;
+  constexpr bool operator== (vec3f const& left,
+                             vec3f const& right) {
+    for (size_t i = 0; i < 3; i++) {
+      float difference = left[i] - right[i];
+      if (difference > 0.00001f || difference < -0.00001f) {
+        return false;
+      }
+    }
+    return true;
+  }
 
   mat4 operator* (mat4 const& left,
                   mat4 const& right) ;
@@ -138,29 +167,151 @@ namespace LavaCake {
 
   mat4 inverse(const mat4& m) ;
 
-  mat4 Identity() ;
-
-  mat4 PrepareTranslationMatrix(float x,
-                                float y,
-                                float z) ;
-  mat4 PrepareRotationMatrix(float           angle,
-                             vec3f const & axis,
-                             float           normalize_axis) ;
-
-  mat4 PrepareScalingMatrix(float x,
-                            float y,
-                            float z) ;
-
-  mat4 PreparePerspectiveProjectionMatrix(float aspect_ratio,
-                                          float field_of_view,
-                                          float near_plane,
-                                          float far_plane) ;
-
-  mat4 PrepareOrthographicProjectionMatrix(float left_plane,
-                                           float right_plane,
-                                           float bottom_plane,
-                                           float top_plane,
-                                           float near_plane,
-                                           float far_plane) ;
+  // matrix * (point, 1) for an affine matrix, the translation is applied
+  vec3f transformPoint(mat4 const& matrix,
+                       vec3f const& point) ;
+
+  // the three first rows of an affine matrix, laid out as a VkTransformMatrixKHR
+  std::array<float, 12> affineRows(mat4 const& matrix) ;
+
+  // the matrix transforming the normals of a mesh transformed by matrix, up to a positive scale : the cofactors of the 3x3 part
+  mat4 normalMatrix(mat4 const& matrix) ;
+
+  // transform in place count positions stored every stride floats, as in an interleaved vertex buffer,
+  // large arrays are split between the threads of the job system
+  void transformPositions(mat4 const& matrix,
+                          float* positions,
+                          size_t count,
+                          size_t stride) ;
+
+  // transform in place count normals stored every stride floats with the normal matrix of matrix, the results are normalized
+  void transformNormals(mat4 const& matrix,
+                        float* normals,
+                        size_t count,
+                        size_t stride) ;
+
+  constexpr mat4 Identity() {
+    return mat4({
+      1,0,0,0,
+      0,1,0,0,
+      0,0,1,0,
+      0,0,0,1
+    });
+  }
+
+  constexpr mat4 PrepareTranslationMatrix(float x,
+                                          float y,
+                                          float z) {
+    return mat4({
+      1.0f, 0.0f, 0.0f, 0.0f,
+      0.0f, 1.0f, 0.0f, 0.0f,
+      0.0f, 0.0f, 1.0f, 0.0f,
+      x,    y,    z, 1.0f
+    });
+  }
+
+  inline mat4 PrepareRotationMatrix(float           angle,
+                                    vec3f const & axis,
+                                    float           normalize_axis) {
+    vec3f normalized = normalize_axis ? Normalize(axis) : axis;
+    float x = normalized[0];
+    float y = normalized[1];
+    float z = normalized[2];
+
+    const float c = cos(Deg2Rad(angle));
+    const float _1_c = 1.0f - c;
+    const float s = sin(Deg2Rad(angle));
+
+    return mat4({
+      x * x * _1_c + c,
+      y * x * _1_c - z * s,
+      z * x * _1_c + y * s,
+      0.0f,
+
+      x * y * _1_c + z * s,
+      y * y * _1_c + c,
+      z * y * _1_c - x * s,
+      0.0f,
+
+      x * z * _1_c - y * s,
+      y * z * _1_c + x * s,
+      z * z * _1_c + c,
+      0.0f,
+
+      0.0f,
+      0.0f,
+      0.0f,
+      1.0f
+    });
+  }
+
+  constexpr mat4 PrepareScalingMatrix(float x,
+                                      float y,
+                                      float z) {
+    return mat4({
+      x, 0.0f, 0.0f, 0.0f,
+      0.0f,    y, 0.0f, 0.0f,
+      0.0f, 0.0f,    z, 0.0f,
+      0.0f, 0.0f, 0.0f, 1.0f
+    });
+  }
+
+  inline mat4 PreparePerspectiveProjectionMatrix(float aspect_ratio,
+                                                 float field_of_view,
+                                                 float near_plane,
+                                                 float far_plane) {
+    float f = 1.0f / tan(Deg2Rad(0.5f * field_of_view));
+
+    return mat4({
+      f / aspect_ratio,
+      0.0f,
+      0.0f,
+      0.0f,
+
+      0.0f,
+      -f,
+      0.0f,
+      0.0f,
+
+      0.0f,
+      0.0f,
+      far_plane / (near_plane - far_plane),
+      -1.0f,
+
+      0.0f,
+      0.0f,
+      (near_plane * far_plane) / (near_plane - far_plane),
+      0.0f
+    });
+  }
+
+  constexpr mat4 PrepareOrthographicProjectionMatrix(float left_plane,
+                                                     float right_plane,
+                                                     float bottom_plane,
+                                                     float top_plane,
+                                                     float near_plane,
+                                                     float far_plane) {
+    return mat4({
+      2.0f / (right_plane - left_plane),
+      0.0f,
+      0.0f,
+      0.0f,
+
+      0.0f,
+      2.0f / (bottom_plane - top_plane),
+      0.0f,
+      0.0f,
+
+      0.0f,
+      0.0f,
+      1.0f / (near_plane - far_plane),
+      0.0f,
+
+      -(right_plane + left_plane) / (right_plane - left_plane),
+      -(bottom_plane + top_plane) / (bottom_plane - top_plane),
+      near_plane / (near_plane - far_plane),
+      1.0f
+    });
+  }
 
 }
@@ -0,0 +1,132 @@
+#pragma once
+
+// SSE2 is part of every x86-64 target and NEON of every arm64 one, MATH_SCALAR forces the portable code
+#if !defined(MATH_SCALAR)
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MATH_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace LavaCake {
+#if defined(MATH_SSE) || defined(MATH_NEON)
+  namespace Simd {
+
+    // four floats in a register, with the few operations the vectorised functions below are built on
+#if defined(MATH_SSE)
+    typedef __m128 float4;
+
+    inline float4 load(const float* p) { return _mm_loadu_ps(p); }
+    inline float4 set(float v) { return _mm_set1_ps(v); }
+    inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+    inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+    inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+    inline float4 max(float4 a, float4 b) { return _mm_max_ps(a, b); }
+    inline float4 min(float4 a, float4 b) { return _mm_min_ps(a, b); }
+    inline float4 bitAnd(float4 a, float4 b) { return _mm_and_ps(a, b); }
+    inline float4 bitAndNot(float4 mask, float4 a) { return _mm_andnot_ps(mask, a); }
+    inline float4 bitXor(float4 a, float4 b) { return _mm_xor_ps(a, b); }
+    inline float4 greater(float4 a, float4 b) { return _mm_cmpgt_ps(a, b); }
+    inline float4 select(float4 mask, float4 a, float4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    inline float4 truncate(float4 a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); }
+    // 2^n for an integral n in [-126, 127]
+    inline float4 pow2(float4 n) { return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23)); }
+    inline void store(float* p, float4 a) { _mm_storeu_ps(p, a); }
+#else
+    typedef float32x4_t float4;
+
+    inline float4 load(const float* p) { return vld1q_f32(p); }
+    inline float4 set(float v) { return vdupq_n_f32(v); }
+    inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+    inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+    inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+    inline float4 max(float4 a, float4 b) { return vmaxq_f32(a, b); }
+    inline float4 min(float4 a, float4 b) { return vminq_f32(a, b); }
+    inline float4 bitAnd(float4 a, float4 b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+    inline float4 bitAndNot(float4 mask, float4 a) { return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(mask))); }
+    inline float4 bitXor(float4 a, float4 b) { return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+    inline float4 greater(float4 a, float4 b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+    inline float4 select(float4 mask, float4 a, float4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+    inline float4 truncate(float4 a) { return vcvtq_f32_s32(vcvtq_s32_f32(a)); }
+    // 2^n for an integral n in [-126, 127]
+    inline float4 pow2(float4 n) { return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23)); }
+    inline void store(float* p, float4 a) { vst1q_f32(p, a); }
+#endif
+
+    inline float horizontalSum(float4 a) {
+      float lanes[4];
+      store(lanes, a);
+      return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    /**
+     *\brief sine and cosine of four values, with the range reduction and polynomials of the Cephes library
+     * The error is a few ulp for |x| < 8192, larger arguments lose precision in the range reduction.
+     */
+    inline void sincos(float4 x, float4& s, float4& c) {
+      const float4 signBit = set(-0.0f);
+      float4 sinSign = bitAnd(x, signBit);
+      x = bitAndNot(signBit, x);
+
+      // octant j of |x|, rounded up to an even value, and its bits 2 and 4 as masks
+      float4 j = truncate(mul(x, set(1.27323954473516f)));
+      float4 half = truncate(mul(j, set(0.5f)));
+      j = add(j, sub(j, add(half, half)));
+      float4 octant = sub(j, mul(truncate(mul(j, set(0.125f))), set(8.0f)));
+      float4 quadrant = sub(octant, mul(truncate(mul(octant, set(0.25f))), set(4.0f)));
+      float4 swap = greater(quadrant, set(1.0f));
+      float4 sinNegate = greater(octant, set(3.0f));
+      float4 cosNegate = bitAnd(greater(octant, set(1.0f)), greater(set(5.0f), octant));
+
+      // x - j * pi / 4 in three steps to keep the precision
+      x = sub(x, mul(j, set(0.78515625f)));
+      x = sub(x, mul(j, set(2.4187564849853515625e-4f)));
+      x = sub(x, mul(j, set(3.77489497744594108e-8f)));
+      float4 z = mul(x, x);
+
+      float4 cosPoly = set(2.443315711809948e-5f);
+      cosPoly = add(mul(cosPoly, z), set(-1.388731625493765e-3f));
+      cosPoly = add(mul(cosPoly, z), set(4.166664568298827e-2f));
+      cosPoly = mul(mul(cosPoly, z), z);
+      cosPoly = add(sub(cosPoly, mul(z, set(0.5f))), set(1.0f));
+
+      float4 sinPoly = set(-1.9515295891e-4f);
+      sinPoly = add(mul(sinPoly, z), set(8.3321608736e-3f));
+      sinPoly = add(mul(sinPoly, z), set(-1.6666654611e-1f));
+      sinPoly = add(mul(mul(sinPoly, z), x), x);
+
+      s = bitXor(select(swap, cosPoly, sinPoly), bitXor(sinSign, bitAnd(sinNegate, signBit)));
+      c = bitXor(select(swap, sinPoly, cosPoly), bitAnd(cosNegate, signBit));
+    }
+
+    /**
+     *\brief exponential of four values, with the range reduction and polynomial of the Cephes library
+     * The arguments are clamped to [-87.3, 88.3], the range of normal floats.
+     */
+    inline float4 exp(float4 x) {
+      x = max(min(x, set(88.3762626647949f)), set(-87.3365447505531f));
+
+      // n = floor(x / ln 2 + 0.5)
+      float4 fx = add(mul(x, set(1.44269504088896341f)), set(0.5f));
+      float4 n = truncate(fx);
+      n = sub(n, bitAnd(greater(n, fx), set(1.0f)));
+
+      x = sub(x, mul(n, set(0.693359375f)));
+      x = sub(x, mul(n, set(-2.12194440e-4f)));
+      float4 z = mul(x, x);
+
+      float4 y = set(1.9875691500e-4f);
+      y = add(mul(y, x), set(1.3981999507e-3f));
+      y = add(mul(y, x), set(8.3334519073e-3f));
+      y = add(mul(y, x), set(4.1665795894e-2f));
+      y = add(mul(y, x), set(1.6666665459e-1f));
+      y = add(mul(y, x), set(5.0000001201e-1f));
+      y = add(add(mul(y, z), x), set(1.0f));
+      return mul(y, pow2(n));
+    }
+  }
+#endif
+}
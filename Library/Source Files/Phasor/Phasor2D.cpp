@@ -114,15 +114,24 @@ namespace LavaCake {
 
   
   void Phasor2D::phaseOptimisation(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff,uint32_t nbOptimisation){
-    for (int i = 0; i < nbOptimisation; i++) {
-      cmdBuff.resetFence();
-      cmdBuff.beginRecord();
+    if(nbOptimisation == 0){
+      return;
+    }
+    cmdBuff.resetFence();
+    cmdBuff.beginRecord();
+    // the grid size never changes, the uniform buffer only needs to be uploaded once
+    if(!m_optimisationBufferUploaded){
       m_optimisationBuffer->update(cmdBuff);
+      m_optimisationBufferUploaded = true;
+    }
+    for (uint32_t i = 0; i < nbOptimisation; i++) {
+      // each step reads the phases written by the previous one
+      m_kernelBuffer->setAccess(cmdBuff, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VkAccessFlagBits(VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT));
       m_optimisationPipeline->compute(cmdBuff, m_cellsDim[0] * m_cellsDim[1], 1, 1);
-      cmdBuff.endRecord();
-      cmdBuff.submit(queue, {}, {});
-      cmdBuff.wait(UINT32_MAX);
     }
+    cmdBuff.endRecord();
+    cmdBuff.submit(queue, {}, {});
+    cmdBuff.wait(UINT32_MAX);
   }
   
   
@@ -131,27 +140,17 @@ namespace LavaCake {
     if(m_samplingBuffer != nullptr){
       delete m_samplingBuffer;
     }
-    if(m_samplingPipeline != nullptr){
-      delete m_samplingPipeline;
-    }
     
     m_samplingBuffer = new Framework::Buffer();
     m_samplingBuffer->allocate(sampleResolution[0] * sampleResolution[1] * sizeof(float), VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT);
     
-    std::vector<float> f(sampleResolution[0] * sampleResolution[1]);
-    std::vector<vec2f> dir(sampleResolution[0] * sampleResolution[1]);
-    std::vector<float> div(sampleResolution[0] * sampleResolution[1]);
+    std::vector<float> f;
+    std::vector<vec2f> dir;
+    std::vector<float> div(sampleResolution[0] * sampleResolution[1], 0.0f);
     
-    for(int i = 0; i< sampleResolution[0]; i++){
-      for(int j = 0; j< sampleResolution[1]; j++){
-        vec2f pos =sampleBoundingBox.A() + vec2f({float(i)/float(sampleResolution[0]),float(j)/float(sampleResolution[1])}) * sampleBoundingBox.diag();
-        
-        f[i + j * sampleResolution[0]] = m_F->sample(pos);
-        auto d = m_D->sample(pos);
-        dir[i + j * sampleResolution[0]] = d;
-        div[i + j * sampleResolution[0]] = 0;
-      }
-    }
+    vec2f step = sampleBoundingBox.diag() / vec2f({float(sampleResolution[0]), float(sampleResolution[1])});
+    m_F->sampleMany(sampleBoundingBox.A(), step, sampleResolution, f);
+    m_D->sampleMany(sampleBoundingBox.A(), step, sampleResolution, dir);
     
     Framework::Buffer* dirBuffer = new Framework::Buffer();
     dirBuffer->allocate(queue, cmdBuff, dir, VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT,VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,VK_PIPELINE_STAGE_TRANSFER_BIT, VK_FORMAT_R32G32_SFLOAT);
@@ -166,17 +165,26 @@ namespace LavaCake {
     m_samplingUniformBuffer->setVariable("sampleMin", sampleBoundingBox.A());
     m_samplingUniformBuffer->setVariable("sampleMax", sampleBoundingBox.B());
     
-    m_samplingPipeline = new Framework::ComputePipeline();
-    
-    m_samplingPipeline->setComputeModule(m_samplingModule);
-    
-    m_samplingPipeline->addTexelBuffer(m_kernelBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 1);
-    m_samplingPipeline->addUniformBuffer(m_samplingUniformBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 2);
-    m_samplingPipeline->addTexelBuffer(fBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 3);
-    m_samplingPipeline->addTexelBuffer(dirBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 4);
-    m_samplingPipeline->addTexelBuffer(divBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 5);
-    m_samplingPipeline->addTexelBuffer(m_samplingBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 6);
-    m_samplingPipeline->compile();
+    // the pipeline is compiled once, later calls only rebind the buffers that changed
+    if(m_samplingPipeline == nullptr){
+      m_samplingPipeline = new Framework::ComputePipeline();
+
+      m_samplingPipeline->setComputeModule(m_samplingModule);
+
+      m_samplingPipeline->addTexelBuffer(m_kernelBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 1);
+      m_samplingPipeline->addUniformBuffer(m_samplingUniformBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 2);
+      m_samplingPipeline->addTexelBuffer(fBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 3);
+      m_samplingPipeline->addTexelBuffer(dirBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 4);
+      m_samplingPipeline->addTexelBuffer(divBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 5);
+      m_samplingPipeline->addTexelBuffer(m_samplingBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 6);
+      m_samplingPipeline->compile();
+    }else{
+      m_samplingPipeline->setTexelBuffer(fBuffer, 3);
+      m_samplingPipeline->setTexelBuffer(dirBuffer, 4);
+      m_samplingPipeline->setTexelBuffer(divBuffer, 5);
+      m_samplingPipeline->setTexelBuffer(m_samplingBuffer, 6);
+      m_samplingPipeline->updateDescriptorSet();
+    }
 
     cmdBuff.resetFence();
     cmdBuff.beginRecord();
@@ -196,5 +204,48 @@ namespace LavaCake {
   
   
   
+  void Phasor2D::phaseOptimisation(uint32_t nbOptimisation){
+    if(!m_cpuKernelsReady){
+      m_cpuKernels.set(m_cells, m_cellsDim);
+      m_cpuKernelsReady = true;
+    }
+    for (uint32_t i = 0; i < nbOptimisation; i++) {
+      m_cpuKernels.optimise();
+    }
+    for(size_t c = 0; c < m_cells.size(); c++){
+      for(size_t k = 0; k < phasorKernelsPerCell; k++){
+        m_cells[c].kernels[k].phase = m_cpuKernels.phase[c * phasorKernelsPerCell + k];
+      }
+    }
+  }
+  
+  
+  std::vector<float> Phasor2D::sample(Helpers::ABBox<2> sampleBoundingBox, vec2u sampleResolution){
+    if(!m_cpuKernelsReady){
+      m_cpuKernels.set(m_cells, m_cellsDim);
+      m_cpuKernelsReady = true;
+    }
+    
+    std::vector<float> result(sampleResolution[0] * sampleResolution[1]);
+    vec2f sampleMin = sampleBoundingBox.A();
+    vec2f sampleSize = sampleBoundingBox.diag();
+    vec2f gridMin = m_kernelBoundingBox.A();
+    
+    JobSystem::getJobSystem()->parallelFor(0, sampleResolution[1], 1, [&](size_t begin, size_t end){
+      for(size_t j = begin; j < end; j++){
+        for(uint32_t i = 0; i < sampleResolution[0]; i++){
+          // same sample positions as the sampling shader, in cell units
+          std::array<float, 2> at;
+          at[0] = (float(i) / float(sampleResolution[0]) * sampleSize[0] + sampleMin[0] - gridMin[0]) / m_cellsize;
+          at[1] = (float(j) / float(sampleResolution[1]) * sampleSize[1] + sampleMin[1] - gridMin[1]) / m_cellsize;
+          result[i + j * sampleResolution[0]] = m_cpuKernels.evaluate(at);
+        }
+      }
+    });
+    return result;
+  }
+  
+  
+  
   }
 }
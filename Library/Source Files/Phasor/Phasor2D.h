@@ -2,6 +2,7 @@
 #include "AllHeaders.h"
 #include "../Helpers/Field.h"
 #include "../Framework/Framework.h"
+#include "PhasorCPU.h"
 
 namespace LavaCake {
   namespace Phasor {
@@ -37,7 +38,7 @@ namespace LavaCake {
     void init(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff);
     
     /**
-     *\brief execute a predefined number of optimisation step
+     *\brief execute a predefined number of optimisation step, all the steps are recorded in a single command buffer and submitted once
      *\param nBoptimisation the number of optimisation step
      */
     void phaseOptimisation(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff,uint32_t nbOptimisation);
@@ -46,6 +47,21 @@ namespace LavaCake {
     
     Framework::Buffer*  getSampleBuffer(){return m_samplingBuffer;}
     
+    /**
+     *\brief execute a predefined number of optimisation step on the CPU, the cells are processed in parallel by the job system
+     * The optimised phases are written back to the kernels uploaded by init, call it before init to use them on the GPU.
+     *\param nBoptimisation the number of optimisation step
+     */
+    void phaseOptimisation(uint32_t nbOptimisation);
+    
+    /**
+     *\brief sample the noise on the CPU, the rows of samples are computed in parallel by the job system
+     *\param sampleBoundingBox the sampled domain in mm
+     *\param sampleResolution the number of samples in each dimension
+     *\return the samples, ordered as in the buffer returned by getSampleBuffer after a GPU sampling
+     */
+    std::vector<float> sample(Helpers::ABBox<2> sampleBoundingBox, vec2u sampleResolution);
+    
     private :
     vec2u                             m_cellsDim;
     std::vector<phasor2DCell>         m_cells;
@@ -61,12 +77,16 @@ namespace LavaCake {
     Framework::ComputeShaderModule*   m_optimisationModule;
     Framework::ComputePipeline*       m_optimisationPipeline;
     Framework::UniformBuffer*         m_optimisationBuffer;
+    bool                              m_optimisationBufferUploaded = false;
     
     
     Framework::Buffer*                m_samplingBuffer = nullptr;
     Framework::ComputeShaderModule*   m_samplingModule;
     Framework::ComputePipeline*       m_samplingPipeline = nullptr;
     Framework::UniformBuffer*         m_samplingUniformBuffer;
+    
+    PhasorKernelArrays<2>             m_cpuKernels;
+    bool                              m_cpuKernelsReady = false;
   };
   
   }
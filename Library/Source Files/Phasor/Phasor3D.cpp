@@ -1,5 +1,6 @@
 #include "Phasor3D.h"
 #include <stdlib.h>     /* srand, rand */
+#include <fstream>
 
 #ifdef __APPLE__
 std::string phasorModulePath = "../LavaCakeShaders";
@@ -114,6 +115,19 @@ namespace LavaCake {
       m_samplingUniformBuffer->addVariable("singleCellSize_mm", vec4f({m_cellsize,0.0f,0.0f,0.0f}));
       m_samplingUniformBuffer->end();
 
+      // one uniform buffer per slab in flight for the tiled sampling
+      for (uint32_t slot = 0; slot < 2; slot++) {
+        m_tileUniformBuffers[slot] = new Framework::UniformBuffer();
+        m_tileUniformBuffers[slot]->addVariable("cellSize", vec4u({ m_cellsDim[0],m_cellsDim[1],m_cellsDim[2],0 }));
+        m_tileUniformBuffers[slot]->addVariable("resultSize", vec4u({ 0,0,0,0 }));
+        m_tileUniformBuffers[slot]->addVariable("sampleMin", vec4f({ 0,0,0,0 }));
+        m_tileUniformBuffers[slot]->addVariable("sampleMax", vec4f({ 0,0,0,0 }));
+        m_tileUniformBuffers[slot]->addVariable("gridMin", vec4f({ m_kernelBoundingBox.A()[0],m_kernelBoundingBox.A()[1],m_kernelBoundingBox.A()[2], 0 }));
+        m_tileUniformBuffers[slot]->addVariable("gridMax", vec4f({ m_kernelBoundingBox.B()[0],m_kernelBoundingBox.B()[1],m_kernelBoundingBox.B()[2], 0 }));
+        m_tileUniformBuffers[slot]->addVariable("singleCellSize_mm", vec4f({ m_cellsize,0.0f,0.0f,0.0f }));
+        m_tileUniformBuffers[slot]->end();
+      }
+
 
       m_samplingModule = new Framework::ComputeShaderModule(phasorModulePath + "/Phasor/samplingModule3D.comp.spv");
 
@@ -121,51 +135,58 @@ namespace LavaCake {
 
 
     void Phasor3D::phaseOptimisation(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff, uint32_t nbOptimisation) {
-      for (int i = 0; i < nbOptimisation; i++) {
-        cmdBuff.resetFence();
-        cmdBuff.beginRecord();
+      if (nbOptimisation == 0) {
+        return;
+      }
+      cmdBuff.resetFence();
+      cmdBuff.beginRecord();
+      // the grid size never changes, the uniform buffer only needs to be uploaded once
+      if (!m_optimisationBufferUploaded) {
         m_optimisationBuffer->update(cmdBuff);
-        m_optimisationPipeline->compute(cmdBuff, m_cellsDim[0] * m_cellsDim[1]* m_cellsDim[2], 1, 1);
-        cmdBuff.endRecord();
-        cmdBuff.submit(queue, {}, {});
-        cmdBuff.wait(UINT32_MAX);
+        m_optimisationBufferUploaded = true;
       }
+      for (uint32_t i = 0; i < nbOptimisation; i++) {
+        // each step reads the phases written by the previous one
+        m_kernelBuffer->setAccess(cmdBuff, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VkAccessFlagBits(VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT));
+        m_optimisationPipeline->compute(cmdBuff, m_cellsDim[0] * m_cellsDim[1] * m_cellsDim[2], 1, 1);
+      }
+      cmdBuff.endRecord();
+      cmdBuff.submit(queue, {}, {});
+      cmdBuff.wait(UINT32_MAX);
       cmdBuff.resetFence();
     }
 
 
+    void Phasor3D::sampleDirections(vec3f origin, vec3f step, vec3u resolution, std::vector<vec4f>& dir) {
+      std::vector<vec3f> d;
+      m_D->sampleMany(origin, step, resolution, d);
+
+      // the direction texel buffer is RGBA, there is no 3 component 32 bit format for texel buffers
+      dir.resize(d.size());
+      JobSystem::getJobSystem()->parallelFor(0, d.size(), 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          dir[i] = vec4f({ d[i][0], d[i][1], d[i][2], 0.0f });
+        }
+      });
+    }
+
+
     void Phasor3D::sample(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff, Helpers::ABBox<3> sampleBoundingBox, vec3u sampleResolution) {
 
       if (m_samplingBuffer != nullptr) {
         delete m_samplingBuffer;
       }
-      if (m_samplingPipeline != nullptr) {
-        delete m_samplingPipeline;
-      }
 
       m_samplingBuffer = new Framework::Buffer();
       m_samplingBuffer->allocate(sampleResolution[0] * sampleResolution[1] * sampleResolution[2] * sizeof(float), VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT);
 
-      std::vector<float> f(sampleResolution[0] * sampleResolution[1] * sampleResolution[2]);
-      std::vector<vec4f> dir(sampleResolution[0] * sampleResolution[1] * sampleResolution[2]);
-      std::vector<float> div(sampleResolution[0] * sampleResolution[1] * sampleResolution[2]);
-
-      for (int i = 0; i < sampleResolution[0]; i++) {
-        for (int j = 0; j < sampleResolution[1]; j++) {
-          for (int k = 0; k < sampleResolution[2]; k++) {
-            vec3f pos = sampleBoundingBox.A() + vec3f({ float(i) / float(sampleResolution[0]),float(j) / float(sampleResolution[1]),float(k) / float(sampleResolution[2]) }) * sampleBoundingBox.diag();
-
-            f[i + j * sampleResolution[0] + k * sampleResolution[0] * sampleResolution[1]] = m_F->sample(pos);
-            auto d = m_D->sample(pos);
-            
-            dir[i + j * sampleResolution[0] + k * sampleResolution[0] * sampleResolution[1]][0] = d[0];
-            dir[i + j * sampleResolution[0] + k * sampleResolution[0] * sampleResolution[1]][1] = d[1];
-            dir[i + j * sampleResolution[0] + k * sampleResolution[0] * sampleResolution[1]][2] = d[2];
-            
-            div[i + j * sampleResolution[0] + k * sampleResolution[0] * sampleResolution[1]] = 0.0f;
-          }
-        }
-      }
+      std::vector<float> f;
+      std::vector<vec4f> dir;
+      std::vector<float> div(sampleResolution[0] * sampleResolution[1] * sampleResolution[2], 0.0f);
+
+      vec3f step = sampleBoundingBox.diag() / vec3f({ float(sampleResolution[0]), float(sampleResolution[1]), float(sampleResolution[2]) });
+      m_F->sampleMany(sampleBoundingBox.A(), step, sampleResolution, f);
+      sampleDirections(sampleBoundingBox.A(), step, sampleResolution, dir);
       cmdBuff.wait(UINT32_MAX);
       cmdBuff.resetFence();
       Framework::Buffer* dirBuffer = new Framework::Buffer();
@@ -181,17 +202,27 @@ namespace LavaCake {
       m_samplingUniformBuffer->setVariable("sampleMin",  vec4f({ sampleBoundingBox.A()[0],sampleBoundingBox.A()[1],sampleBoundingBox.A()[2],0.0f }));
       m_samplingUniformBuffer->setVariable("sampleMax",  vec4f({ sampleBoundingBox.B()[0],sampleBoundingBox.B()[1],sampleBoundingBox.B()[2],0.0f }));
 
-      m_samplingPipeline = new Framework::ComputePipeline();
+      // the pipeline is compiled once, later calls only rebind the buffers that changed
+      if (m_samplingPipeline == nullptr) {
+        m_samplingPipeline = new Framework::ComputePipeline();
 
-      m_samplingPipeline->setComputeModule(m_samplingModule);
+        m_samplingPipeline->setComputeModule(m_samplingModule);
 
-      m_samplingPipeline->addTexelBuffer(m_kernelBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 1);
-      m_samplingPipeline->addUniformBuffer(m_samplingUniformBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 2);
-      m_samplingPipeline->addTexelBuffer(fBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 3);
-      m_samplingPipeline->addTexelBuffer(dirBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 4);
-      m_samplingPipeline->addTexelBuffer(divBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 5);
-      m_samplingPipeline->addTexelBuffer(m_samplingBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 6);
-      m_samplingPipeline->compile();
+        m_samplingPipeline->addTexelBuffer(m_kernelBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 1);
+        m_samplingPipeline->addUniformBuffer(m_samplingUniformBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 2);
+        m_samplingPipeline->addTexelBuffer(fBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 3);
+        m_samplingPipeline->addTexelBuffer(dirBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 4);
+        m_samplingPipeline->addTexelBuffer(divBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 5);
+        m_samplingPipeline->addTexelBuffer(m_samplingBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 6);
+        m_samplingPipeline->compile();
+      }
+      else {
+        m_samplingPipeline->setTexelBuffer(fBuffer, 3);
+        m_samplingPipeline->setTexelBuffer(dirBuffer, 4);
+        m_samplingPipeline->setTexelBuffer(divBuffer, 5);
+        m_samplingPipeline->setTexelBuffer(m_samplingBuffer, 6);
+        m_samplingPipeline->updateDescriptorSet();
+      }
 
       cmdBuff.resetFence();
       cmdBuff.beginRecord();
@@ -211,5 +242,220 @@ namespace LavaCake {
 
 
 
+    struct SampleSlab {
+      Framework::Buffer*            fBuffer = nullptr;
+      Framework::Buffer*            dirBuffer = nullptr;
+      Framework::Buffer*            divBuffer = nullptr;
+      Framework::Buffer*            resultBuffer = nullptr;
+      Framework::CommandBuffer*     commandBuffer = nullptr;
+      Framework::Readback*          readback = nullptr;
+      uint32_t                      firstSlice = 0;
+      uint32_t                      sliceCount = 0;
+    };
+
+
+    void Phasor3D::sampleTiled(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff, Helpers::ABBox<3> sampleBoundingBox, vec3u sampleResolution, uint32_t slabDepth, std::function<void(uint32_t, uint32_t, const float*)> callback) {
+      if (sampleResolution[0] == 0 || sampleResolution[1] == 0 || sampleResolution[2] == 0) {
+        Framework::ErrorCheck::setError((char*)"The sample resolution of sampleTiled must be at least 1 in each dimension");
+        return;
+      }
+      if (slabDepth == 0 || slabDepth > sampleResolution[2]) {
+        slabDepth = sampleResolution[2];
+      }
+      if (m_readbackPool == nullptr) {
+        m_readbackPool = new Framework::ReadbackPool(queue);
+      }
+
+      // 64 bits, a slab of a large volume holds more than 4G bytes
+      VkDeviceSize sliceSize = VkDeviceSize(sampleResolution[0]) * sampleResolution[1];
+      Framework::CommandBuffer secondCommandBuffer;
+
+      // two slabs are in flight : the CPU fills one while the GPU samples and reads back the other
+      SampleSlab slabs[2];
+      for (uint32_t slot = 0; slot < 2; slot++) {
+        SampleSlab& slab = slabs[slot];
+        slab.fBuffer = new Framework::Buffer();
+        slab.fBuffer->allocate(sliceSize * slabDepth * sizeof(float), VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        slab.dirBuffer = new Framework::Buffer();
+        slab.dirBuffer->allocate(sliceSize * slabDepth * sizeof(vec4f), VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_FORMAT_R32G32B32A32_SFLOAT);
+        slab.divBuffer = new Framework::Buffer();
+        slab.divBuffer->allocate(sliceSize * slabDepth * sizeof(float), VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        slab.resultBuffer = new Framework::Buffer();
+        slab.resultBuffer->allocate(sliceSize * slabDepth * sizeof(float), VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT);
+        slab.commandBuffer = slot == 0 ? &cmdBuff : &secondCommandBuffer;
+      }
+
+      // one descriptor set per slot, the pipeline is compiled once
+      for (uint32_t slot = 0; slot < 2; slot++) {
+        SampleSlab& slab = slabs[slot];
+        if (m_tiledSamplingPipeline == nullptr) {
+          m_tiledSamplingPipeline = new Framework::ComputePipeline();
+          m_tiledSamplingPipeline->setComputeModule(m_samplingModule);
+          m_tiledSamplingPipeline->addTexelBuffer(m_kernelBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 1);
+          m_tiledSamplingPipeline->addUniformBuffer(m_tileUniformBuffers[slot], VK_SHADER_STAGE_COMPUTE_BIT, 2);
+          m_tiledSamplingPipeline->addTexelBuffer(slab.fBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 3);
+          m_tiledSamplingPipeline->addTexelBuffer(slab.dirBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 4);
+          m_tiledSamplingPipeline->addTexelBuffer(slab.divBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 5);
+          m_tiledSamplingPipeline->addTexelBuffer(slab.resultBuffer, VK_SHADER_STAGE_COMPUTE_BIT, 6);
+          m_tiledSamplingPipeline->compile();
+          continue;
+        }
+        m_tiledSamplingPipeline->setUniformBuffer(m_tileUniformBuffers[slot], 2);
+        m_tiledSamplingPipeline->setTexelBuffer(slab.fBuffer, 3);
+        m_tiledSamplingPipeline->setTexelBuffer(slab.dirBuffer, 4);
+        m_tiledSamplingPipeline->setTexelBuffer(slab.divBuffer, 5);
+        m_tiledSamplingPipeline->setTexelBuffer(slab.resultBuffer, 6);
+        if (slot < m_tiledSamplingPipeline->getDescriptorSetCount()) {
+          m_tiledSamplingPipeline->selectDescriptorSet(slot);
+          m_tiledSamplingPipeline->updateDescriptorSet();
+        }
+        else {
+          m_tiledSamplingPipeline->addDescriptorSet();
+        }
+      }
+
+      auto deliver = [&](SampleSlab& slab) {
+        if (slab.readback == nullptr) {
+          return;
+        }
+        callback(slab.firstSlice, slab.sliceCount, static_cast<const float*>(slab.readback->data()));
+        m_readbackPool->release(slab.readback);
+        slab.readback = nullptr;
+      };
+
+      std::vector<float> f;
+      std::vector<vec4f> dir;
+      std::vector<float> div;
+
+      vec3f sampleSize = sampleBoundingBox.diag();
+      vec3f step = sampleSize / vec3f({ float(sampleResolution[0]), float(sampleResolution[1]), float(sampleResolution[2]) });
+      uint32_t nbSlabs = (sampleResolution[2] + slabDepth - 1) / slabDepth;
+      for (uint32_t s = 0; s < nbSlabs; s++) {
+        SampleSlab& slab = slabs[s % 2];
+
+        // the slot is free once the slab it sampled two steps ago has been read back
+        deliver(slab);
+        slab.commandBuffer->wait(UINT32_MAX);
+
+        slab.firstSlice = s * slabDepth;
+        slab.sliceCount = std::min(slabDepth, sampleResolution[2] - slab.firstSlice);
+
+        vec3f slabOrigin = sampleBoundingBox.A();
+        slabOrigin[2] += float(slab.firstSlice) * step[2];
+        vec3u slabResolution = vec3u({ sampleResolution[0], sampleResolution[1], slab.sliceCount });
+        m_F->sampleMany(slabOrigin, step, slabResolution, f);
+        sampleDirections(slabOrigin, step, slabResolution, dir);
+        div.assign(size_t(sliceSize * slab.sliceCount), 0.0f);
+        slab.fBuffer->write(f);
+        slab.dirBuffer->write(dir);
+        slab.divBuffer->write(div);
+
+        // the slab covers [firstSlice, firstSlice + sliceCount) of the full volume, so the shader sees the same positions
+        float zMin = sampleBoundingBox.A()[2] + float(slab.firstSlice) / float(sampleResolution[2]) * sampleSize[2];
+        float zMax = zMin + float(slab.sliceCount) / float(sampleResolution[2]) * sampleSize[2];
+        Framework::UniformBuffer* uniform = m_tileUniformBuffers[s % 2];
+        uniform->setVariable("resultSize", vec4u({ sampleResolution[0],sampleResolution[1],slab.sliceCount,0 }));
+        uniform->setVariable("sampleMin", vec4f({ sampleBoundingBox.A()[0],sampleBoundingBox.A()[1],zMin,0.0f }));
+        uniform->setVariable("sampleMax", vec4f({ sampleBoundingBox.B()[0],sampleBoundingBox.B()[1],zMax,0.0f }));
+
+        Framework::CommandBuffer& slabCommandBuffer = *slab.commandBuffer;
+        slabCommandBuffer.resetFence();
+        slabCommandBuffer.beginRecord();
+
+        uniform->update(slabCommandBuffer);
+        slab.resultBuffer->setAccess(slabCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+        m_tiledSamplingPipeline->selectDescriptorSet(s % 2);
+        m_tiledSamplingPipeline->compute(slabCommandBuffer, sampleResolution[0] / 16 + 1, sampleResolution[1], slab.sliceCount);
+
+        slabCommandBuffer.endRecord();
+        slabCommandBuffer.submit(queue, {}, {});
+
+        // submitted behind the dispatch, the next slab is prepared while this one is copied back
+        slab.readback = m_readbackPool->readBack(*slab.resultBuffer, 0, sliceSize * slab.sliceCount * sizeof(float));
+      }
+
+      for (uint32_t s = nbSlabs; s < nbSlabs + 2; s++) {
+        deliver(slabs[s % 2]);
+      }
+
+      for (uint32_t slot = 0; slot < 2; slot++) {
+        slabs[slot].commandBuffer->wait(UINT32_MAX);
+        delete slabs[slot].fBuffer;
+        delete slabs[slot].dirBuffer;
+        delete slabs[slot].divBuffer;
+        delete slabs[slot].resultBuffer;
+      }
+      cmdBuff.resetFence();
+    }
+
+
+    bool Phasor3D::sampleTiled(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff, Helpers::ABBox<3> sampleBoundingBox, vec3u sampleResolution, uint32_t slabDepth, const std::string& path) {
+      if (sampleResolution[0] == 0 || sampleResolution[1] == 0 || sampleResolution[2] == 0) {
+        Framework::ErrorCheck::setError((char*)"The sample resolution of sampleTiled must be at least 1 in each dimension");
+        return false;
+      }
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      if (!file) {
+        Framework::ErrorCheck::setError((char*)"Could not open the sample file");
+        return false;
+      }
+      sampleTiled(queue, cmdBuff, sampleBoundingBox, sampleResolution, slabDepth, [&](uint32_t firstSlice, uint32_t sliceCount, const float* data) {
+        file.write(reinterpret_cast<const char*>(data), std::streamsize(sampleResolution[0]) * sampleResolution[1] * sliceCount * sizeof(float));
+      });
+      if (!file) {
+        Framework::ErrorCheck::setError((char*)"Could not write the sample file");
+        return false;
+      }
+      return true;
+    }
+
+
+    void Phasor3D::phaseOptimisation(uint32_t nbOptimisation) {
+      if (!m_cpuKernelsReady) {
+        m_cpuKernels.set(m_cells, m_cellsDim);
+        m_cpuKernelsReady = true;
+      }
+      for (uint32_t i = 0; i < nbOptimisation; i++) {
+        m_cpuKernels.optimise();
+      }
+      for (size_t c = 0; c < m_cells.size(); c++) {
+        for (size_t k = 0; k < phasorKernelsPerCell; k++) {
+          m_cells[c].kernels[k].phase = m_cpuKernels.phase[c * phasorKernelsPerCell + k];
+        }
+      }
+    }
+
+
+    std::vector<float> Phasor3D::sample(Helpers::ABBox<3> sampleBoundingBox, vec3u sampleResolution) {
+      if (!m_cpuKernelsReady) {
+        m_cpuKernels.set(m_cells, m_cellsDim);
+        m_cpuKernelsReady = true;
+      }
+
+      std::vector<float> result(sampleResolution[0] * sampleResolution[1] * sampleResolution[2]);
+      vec3f sampleMin = sampleBoundingBox.A();
+      vec3f sampleSize = sampleBoundingBox.diag();
+      vec3f gridMin = m_kernelBoundingBox.A();
+
+      // one job per row of samples along x
+      JobSystem::getJobSystem()->parallelFor(0, sampleResolution[1] * sampleResolution[2], 1, [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; row++) {
+          size_t j = row % sampleResolution[1];
+          size_t k = row / sampleResolution[1];
+          for (uint32_t i = 0; i < sampleResolution[0]; i++) {
+            // same sample positions as the sampling shader, in cell units
+            std::array<float, 3> at;
+            at[0] = (float(i) / float(sampleResolution[0]) * sampleSize[0] + sampleMin[0] - gridMin[0]) / m_cellsize;
+            at[1] = (float(j) / float(sampleResolution[1]) * sampleSize[1] + sampleMin[1] - gridMin[1]) / m_cellsize;
+            at[2] = (float(k) / float(sampleResolution[2]) * sampleSize[2] + sampleMin[2] - gridMin[2]) / m_cellsize;
+            result[i + row * sampleResolution[0]] = m_cpuKernels.evaluate(at);
+          }
+        }
+      });
+      return result;
+    }
+
+
+
   }
 }
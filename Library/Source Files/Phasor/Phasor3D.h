@@ -2,6 +2,9 @@
 #include "AllHeaders.h"
 #include "../Helpers/Field.h"
 #include "../Framework/Framework.h"
+#include "PhasorCPU.h"
+
+#include <functional>
 
 
 
@@ -39,7 +42,7 @@ namespace LavaCake {
       void init(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff);
 
       /**
-       *\brief execute a predefined number of optimisation step
+       *\brief execute a predefined number of optimisation step, all the steps are recorded in a single command buffer and submitted once
        *\param nBoptimisation the number of optimisation step
        */
       void phaseOptimisation(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff, uint32_t nbOptimisation);
@@ -48,6 +51,38 @@ namespace LavaCake {
 
       Framework::Buffer* getSampleBuffer() { return m_samplingBuffer; }
 
+      /**
+       *\brief sample the noise slab by slab along z, only the field data and the result of two slabs live on the GPU at once
+       * The readback of a slab overlaps the dispatch of the next one, slabs are given to the callback in order.
+       *\param sampleBoundingBox the sampled domain in mm
+       *\param sampleResolution the number of samples in each dimension, an error is set if one of them is 0
+       *\param slabDepth the number of z slices sampled per slab
+       *\param callback called with the first slice of a slab, its number of slices and its samples, the data is only valid during the call
+       */
+      void sampleTiled(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff, Helpers::ABBox<3> sampleBoundingBox, vec3u sampleResolution, uint32_t slabDepth, std::function<void(uint32_t, uint32_t, const float*)> callback);
+
+      /**
+       *\brief sample the noise slab by slab along z and stream the slabs to a raw float file, ordered as getSampleBuffer
+       *\param path the file to write
+       *\return true if the file could be written
+       */
+      bool sampleTiled(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff, Helpers::ABBox<3> sampleBoundingBox, vec3u sampleResolution, uint32_t slabDepth, const std::string& path);
+
+      /**
+       *\brief execute a predefined number of optimisation step on the CPU, the cells are processed in parallel by the job system
+       * The optimised phases are written back to the kernels uploaded by init, call it before init to use them on the GPU.
+       *\param nBoptimisation the number of optimisation step
+       */
+      void phaseOptimisation(uint32_t nbOptimisation);
+
+      /**
+       *\brief sample the noise on the CPU, the rows of samples are computed in parallel by the job system
+       *\param sampleBoundingBox the sampled domain in mm
+       *\param sampleResolution the number of samples in each dimension
+       *\return the samples, ordered as in the buffer returned by getSampleBuffer after a GPU sampling
+       */
+      std::vector<float> sample(Helpers::ABBox<3> sampleBoundingBox, vec3u sampleResolution);
+
     private:
       vec3u                             m_cellsDim;
       std::vector<phasor3DCell>         m_cells;
@@ -63,12 +98,22 @@ namespace LavaCake {
       Framework::ComputeShaderModule* m_optimisationModule;
       Framework::ComputePipeline* m_optimisationPipeline;
       Framework::UniformBuffer* m_optimisationBuffer;
+      bool m_optimisationBufferUploaded = false;
 
 
       Framework::Buffer* m_samplingBuffer = nullptr;
       Framework::ComputeShaderModule* m_samplingModule;
       Framework::ComputePipeline* m_samplingPipeline = nullptr;
       Framework::UniformBuffer* m_samplingUniformBuffer;
+
+      void sampleDirections(vec3f origin, vec3f step, vec3u resolution, std::vector<vec4f>& dir);
+
+      Framework::ComputePipeline* m_tiledSamplingPipeline = nullptr;
+      Framework::UniformBuffer* m_tileUniformBuffers[2];
+      Framework::ReadbackPool* m_readbackPool = nullptr;
+
+      PhasorKernelArrays<3> m_cpuKernels;
+      bool m_cpuKernelsReady = false;
     };
 
   }
@@ -0,0 +1,254 @@
+#pragma once
+#include "AllHeaders.h"
+#include "../Helpers/JobSystem.h"
+#include "../Math/simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace LavaCake {
+  namespace Phasor {
+
+  // number of kernels per cell, the ranges of kernels evaluated together are whole cells
+  const size_t phasorKernelsPerCell = 8;
+  const float phasorPi = 3.14159265358979323846f;
+
+  /**
+   *\brief The kernels of a phasor grid stored as a structure of arrays for the CPU backend
+   * The kernels of consecutive cells along x are contiguous, so a row of neighbour cells is a single range of each array.
+   *\param D the dimension of the grid
+   */
+  template<size_t D>
+  struct PhasorKernelArrays {
+    std::array<uint32_t, D>                 dim;
+    std::array<std::vector<float>, D>       pos;          // position in cell units, cell coordinates included
+    std::vector<float>                      f;
+    std::vector<float>                      phase;
+    std::array<std::vector<float>, D>       direction;
+
+    /**
+     *\brief copy the kernels of a grid of cells
+     *\param cells the cells, ordered along x then y then z
+     *\param cellsDim the number of cells in each dimension
+     */
+    template<typename Cell>
+    void set(const std::vector<Cell>& cells, const std::array<uint32_t, D>& cellsDim) {
+      dim = cellsDim;
+      size_t n = cells.size() * phasorKernelsPerCell;
+      for (size_t d = 0; d < D; d++) {
+        pos[d].resize(n);
+        direction[d].resize(n);
+      }
+      f.resize(n);
+      phase.resize(n);
+
+      for (size_t c = 0; c < cells.size(); c++) {
+        std::array<uint32_t, D> coord = cellCoord(c);
+        for (size_t k = 0; k < phasorKernelsPerCell; k++) {
+          size_t id = c * phasorKernelsPerCell + k;
+          for (size_t d = 0; d < D; d++) {
+            pos[d][id] = float(coord[d]) + cells[c].kernels[k].pos[d];
+            direction[d][id] = cells[c].kernels[k].direction[d];
+          }
+          f[id] = cells[c].kernels[k].f;
+          phase[id] = cells[c].kernels[k].phase;
+        }
+      }
+    }
+
+    std::array<uint32_t, D> cellCoord(size_t index) const {
+      std::array<uint32_t, D> coord;
+      for (size_t d = 0; d < D; d++) {
+        coord[d] = uint32_t(index % dim[d]);
+        index /= dim[d];
+      }
+      return coord;
+    }
+
+    /**
+     *\brief call rowJob(firstKernel, kernelCount) on each row of the cells at most radius cells away from a cell, cells outside of the grid are skipped
+     */
+    template<typename RowJob>
+    void forEachNeighbourRow(const std::array<int, D>& cell, int radius, RowJob rowJob) const {
+      int first = std::max(cell[0] - radius, 0);
+      int last = std::min(cell[0] + radius, int(dim[0]) - 1);
+      if (first > last) {
+        return;
+      }
+
+      std::array<int, D> offset;
+      offset.fill(-radius);
+      while (true) {
+        bool inside = true;
+        size_t index = size_t(first);
+        size_t stride = 1;
+        for (size_t d = 1; d < D; d++) {
+          stride *= dim[d - 1];
+          int c = cell[d] + offset[d];
+          if (c < 0 || c >= int(dim[d])) {
+            inside = false;
+          }
+          index += size_t(c) * stride;
+        }
+        if (inside) {
+          rowJob(index * phasorKernelsPerCell, size_t(last - first + 1) * phasorKernelsPerCell);
+        }
+
+        size_t d = 1;
+        while (d < D && offset[d] == radius) {
+          offset[d] = -radius;
+          d++;
+        }
+        if (d == D) {
+          return;
+        }
+        offset[d]++;
+      }
+    }
+
+    /**
+     *\brief sum the votes of a range of kernels for the phase of a kernel, as in the optimisation shader
+     * With SSE2 or NEON, see Math/simd.h, 4 kernels are evaluated at a time with a vectorised sincos, the range length is a multiple of 8.
+     */
+    void accumulateVotes(size_t first, size_t count, const std::array<float, D>& kpos, const std::array<float, D>& kdir, float& re, float& im) const {
+#if defined(MATH_SSE) || defined(MATH_NEON)
+      Simd::float4 sumRe = Simd::set(0.0f);
+      Simd::float4 sumIm = Simd::set(0.0f);
+      for (size_t n = first; n < first + count; n += 4) {
+        Simd::float4 w = Simd::set(0.0f);
+        Simd::float4 x = Simd::set(0.0f);
+        for (size_t d = 0; d < D; d++) {
+          Simd::float4 dir = Simd::load(&direction[d][n]);
+          w = Simd::add(w, Simd::mul(Simd::set(kdir[d]), dir));
+          x = Simd::add(x, Simd::mul(Simd::sub(Simd::set(kpos[d]), Simd::load(&pos[d][n])), dir));
+        }
+        w = Simd::max(w, Simd::set(0.0f));
+        Simd::float4 osc = Simd::add(Simd::mul(Simd::mul(Simd::load(&f[n]), x), Simd::set(2.0f * phasorPi)), Simd::load(&phase[n]));
+        Simd::float4 s, c;
+        Simd::sincos(osc, s, c);
+        sumRe = Simd::add(sumRe, Simd::mul(w, c));
+        sumIm = Simd::add(sumIm, Simd::mul(w, s));
+      }
+      re += Simd::horizontalSum(sumRe);
+      im += Simd::horizontalSum(sumIm);
+#else
+      for (size_t n = first; n < first + count; n++) {
+        float w = 0.0f;
+        float x = 0.0f;
+        for (size_t d = 0; d < D; d++) {
+          w += kdir[d] * direction[d][n];
+          x += (kpos[d] - pos[d][n]) * direction[d][n];
+        }
+        w = std::max(w, 0.0f);
+        float osc = f[n] * x * 2.0f * phasorPi + phase[n];
+        re += w * std::cos(osc);
+        im += w * std::sin(osc);
+      }
+#endif
+    }
+
+    /**
+     *\brief sum the contributions of a range of kernels at a point, as kernelAt in the sampling shader
+     * The sampling shader uses a null divergence, the frequency and direction at the sample point do not contribute.
+     * With SSE2 or NEON, see Math/simd.h, 4 kernels are evaluated at a time with a vectorised exp and sincos.
+     */
+    void accumulateKernels(size_t first, size_t count, const std::array<float, D>& at, float& re, float& im) const {
+      const float a = 5.0f;
+      const float b = 9.0f;
+      const float falloff = a * b / (a + b);
+
+#if defined(MATH_SSE) || defined(MATH_NEON)
+      Simd::float4 sumRe = Simd::set(0.0f);
+      Simd::float4 sumIm = Simd::set(0.0f);
+      for (size_t n = first; n < first + count; n += 4) {
+        Simd::float4 distance = Simd::set(0.0f);
+        Simd::float4 x = Simd::set(0.0f);
+        for (size_t d = 0; d < D; d++) {
+          Simd::float4 delta = Simd::sub(Simd::set(at[d]), Simd::load(&pos[d][n]));
+          distance = Simd::add(distance, Simd::mul(delta, delta));
+          x = Simd::add(x, Simd::mul(delta, Simd::load(&direction[d][n])));
+        }
+        Simd::float4 g = Simd::exp(Simd::mul(Simd::set(-falloff), distance));
+        Simd::float4 ocs = Simd::add(Simd::mul(Simd::mul(Simd::set(2.0f * phasorPi), Simd::load(&f[n])), x), Simd::load(&phase[n]));
+        Simd::float4 s, c;
+        Simd::sincos(ocs, s, c);
+        sumRe = Simd::add(sumRe, Simd::mul(g, c));
+        sumIm = Simd::add(sumIm, Simd::mul(g, s));
+      }
+      re += Simd::horizontalSum(sumRe);
+      im += Simd::horizontalSum(sumIm);
+#else
+      for (size_t n = first; n < first + count; n++) {
+        float distance = 0.0f;
+        float x = 0.0f;
+        for (size_t d = 0; d < D; d++) {
+          float delta = at[d] - pos[d][n];
+          distance += delta * delta;
+          x += delta * direction[d][n];
+        }
+        float g = std::exp(-falloff * distance);
+        float ocs = 2.0f * phasorPi * f[n] * x + phase[n];
+        re += g * std::cos(ocs);
+        im += g * std::sin(ocs);
+      }
+#endif
+    }
+
+    /**
+     *\brief execute one optimisation step on every kernel, the cells are processed in parallel by the job system
+     * Every kernel reads the phases of the previous step, the result does not depend on the order in which cells are processed.
+     */
+    void optimise() {
+      std::vector<float> newPhase(phase.size());
+      size_t nbCells = phase.size() / phasorKernelsPerCell;
+
+      Helpers::JobSystem::getJobSystem()->parallelFor(0, nbCells, 64, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+          std::array<uint32_t, D> coord = cellCoord(c);
+          std::array<int, D> cell;
+          for (size_t d = 0; d < D; d++) {
+            cell[d] = int(coord[d]);
+          }
+
+          for (size_t k = 0; k < phasorKernelsPerCell; k++) {
+            size_t id = c * phasorKernelsPerCell + k;
+            std::array<float, D> kpos, kdir;
+            for (size_t d = 0; d < D; d++) {
+              kpos[d] = pos[d][id];
+              kdir[d] = direction[d][id];
+            }
+
+            float re = 0.0f;
+            float im = 0.0f;
+            forEachNeighbourRow(cell, 1, [&](size_t first, size_t count) {
+              accumulateVotes(first, count, kpos, kdir, re, im);
+            });
+            newPhase[id] = std::atan2(im, re);
+          }
+        }
+      });
+
+      phase.swap(newPhase);
+    }
+
+    /**
+     *\brief evaluate the noise at a point given in cell units, as the sampling shader
+     *\return the phase of the noise remapped to [0,1]
+     */
+    float evaluate(const std::array<float, D>& at) const {
+      std::array<int, D> cell;
+      for (size_t d = 0; d < D; d++) {
+        cell[d] = int(at[d]);
+      }
+
+      float re = 0.0f;
+      float im = 0.0f;
+      forEachNeighbourRow(cell, 2, [&](size_t first, size_t count) {
+        accumulateKernels(first, count, at, re, im);
+      });
+      return std::atan2(im, re) / (2.0f * phasorPi) + 0.5f;
+    }
+  };
+
+  }
+}
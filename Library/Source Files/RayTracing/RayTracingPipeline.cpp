@@ -24,6 +24,7 @@ namespace LavaCake {
 				stageCreate.pSpecializationInfo = nullptr;
 
 				m_shaderStages.emplace_back(stageCreate);
+				m_modules.push_back(module);
 				uint32_t shaderIndex = static_cast<uint32_t>(m_shaderStages.size() - 1);
 
 				VkRayTracingShaderGroupCreateInfoKHR groupInfo;
@@ -59,6 +60,7 @@ namespace LavaCake {
 				stageCreate.pSpecializationInfo = nullptr;
 
 				m_shaderStages.emplace_back(stageCreate);
+				m_modules.push_back(module);
 				uint32_t shaderIndex = static_cast<uint32_t>(m_shaderStages.size() - 1);
 
 				VkRayTracingShaderGroupCreateInfoKHR groupInfo;
@@ -111,6 +113,7 @@ namespace LavaCake {
 				stageCreate.pSpecializationInfo = nullptr;
 
 				m_shaderStages.emplace_back(stageCreate);
+				m_modules.push_back(module);
 				uint32_t shaderIndex = static_cast<uint32_t>(m_shaderStages.size() - 1);
 				m_shaderGroups[m_shaderGroups.size() - 1].closestHitShader = shaderIndex;
 			}
@@ -131,6 +134,7 @@ namespace LavaCake {
 				stageCreate.pSpecializationInfo = nullptr;
 
 				m_shaderStages.emplace_back(stageCreate);
+				m_modules.push_back(module);
 				uint32_t shaderIndex = static_cast<uint32_t>(m_shaderStages.size() - 1);
 				m_shaderGroups[m_shaderGroups.size() - 1].anyHitShader = shaderIndex;
 			}
@@ -151,6 +155,7 @@ namespace LavaCake {
 				stageCreate.pSpecializationInfo = nullptr;
 
 				m_shaderStages.emplace_back(stageCreate);
+				m_modules.push_back(module);
 				uint32_t shaderIndex = static_cast<uint32_t>(m_shaderStages.size() - 1);
 				m_shaderGroups[m_shaderGroups.size() - 1].intersectionShader = shaderIndex;
 			}
@@ -173,7 +178,7 @@ namespace LavaCake {
 
 				generateDescriptorLayout();
 				InitVkDestroyer(logical, m_pipelineLayout);
-				if (!CreatePipelineLayout(logical, { *m_descriptorSetLayout }, {}, *m_pipelineLayout)) {
+				if (!CreatePipelineLayout(logical, { m_descriptorSetLayout }, {}, *m_pipelineLayout)) {
 					Framework::ErrorCheck::setError((char*)"Can't create compute pipeline layout");
 				}
 
@@ -194,7 +199,10 @@ namespace LavaCake {
 
 				InitVkDestroyer(logical, m_pipeline);
 				std::vector<VkPipeline> pipelines(pipelineInfos.size());
-				VkResult code = vkCreateRayTracingPipelinesKHR(logical, nullptr, nullptr, (uint32_t)pipelineInfos.size(), pipelineInfos.data(), nullptr, pipelines.data());
+				Framework::PipelineCache& cache = Framework::Device::getDevice()->getPipelineCache();
+				auto start = std::chrono::high_resolution_clock::now();
+				VkResult code = vkCreateRayTracingPipelinesKHR(logical, nullptr, cache.getHandle(), (uint32_t)pipelineInfos.size(), pipelineInfos.data(), nullptr, pipelines.data());
+				cache.addCreationTime((uint32_t)pipelineInfos.size(), std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
 				*m_pipeline = pipelines[0];
 
 
@@ -212,7 +220,9 @@ namespace LavaCake {
 
 			void RayTracingPipeline::trace(Framework::CommandBuffer& cmdbuff) {
 				vkCmdBindPipeline(cmdbuff.getHandle(), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, *m_pipeline);
-				vkCmdBindDescriptorSets(cmdbuff.getHandle(), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, *m_pipelineLayout, 0, (uint32_t)m_descriptorSets.size(), m_descriptorSets.data(), 0, 0);
+				if (m_descriptorSets.size() > 0) {
+					vkCmdBindDescriptorSets(cmdbuff.getHandle(), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, *m_pipelineLayout, 0, 1, &m_descriptorSets[m_currentDescriptorSet], 0, 0);
+				}
 
 				VkStridedDeviceAddressRegionKHR callableShaderSbtEntry{};
                 
@@ -242,10 +252,8 @@ namespace LavaCake {
 
 			void RayTracingPipeline::generateDescriptorLayout() {
 
-				Framework::Device* d = Framework::Device::getDevice();
-				VkDevice logical = d->getLogicalDevice();
-
 				m_descriptorSetLayoutBinding = {};
+				applyReflection();
 
 				for (uint32_t i = 0; i < m_uniforms.size(); i++) {
 					m_descriptorSetLayoutBinding.push_back({
@@ -320,71 +328,21 @@ namespace LavaCake {
 						});
 				}
 
-				InitVkDestroyer(logical, m_descriptorSetLayout);
-				if (!LavaCake::Core::CreateDescriptorSetLayout(logical, m_descriptorSetLayoutBinding, *m_descriptorSetLayout)) {
-					Framework::ErrorCheck::setError((char*)"Can't create descriptor set layout");
-				}
-
 				m_descriptorCount = static_cast<uint32_t>(m_uniforms.size() + m_textures.size() + m_storageImages.size() + m_attachments.size() + m_frameBuffers.size() + m_texelBuffers.size() + m_buffers.size() + m_AS.size());
+				allocateDescriptorSet();
 				if (m_descriptorCount == 0) return;
 
-				m_descriptorPoolSize = {};
+				writeDescriptorSet(m_descriptorSets[0]);
+			}
 
-				if (m_uniforms.size() > 0) {
-					m_descriptorPoolSize.push_back({
-						VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-							uint32_t(m_uniforms.size())
-						});
-				}
-				if (m_textures.size() + m_frameBuffers.size() > 0) {
-					m_descriptorPoolSize.push_back({
-						VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-							uint32_t(m_textures.size() + m_frameBuffers.size())
-						});
-				}
-				if (m_attachments.size() > 0) {
-					m_descriptorPoolSize.push_back({
-						VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
-							uint32_t(m_attachments.size())
-						});
-				}
-				if (m_storageImages.size() > 0) {
-					m_descriptorPoolSize.push_back({
-						VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-							uint32_t(m_storageImages.size())
-						});
-				}
-				if (m_texelBuffers.size() > 0) {
-					m_descriptorPoolSize.push_back({
-						VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
-							uint32_t(m_texelBuffers.size())
-						});
-				}
-				if (m_buffers.size() > 0) {
-					m_descriptorPoolSize.push_back({
-						VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-							uint32_t(m_buffers.size())
-						});
-				}
-				if (m_AS.size() > 0) {
-					m_descriptorPoolSize.push_back({
-						VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
-							uint32_t(m_AS.size())
-						});
-				}
-				InitVkDestroyer(logical, m_descriptorPool);
-				if (!LavaCake::Core::CreateDescriptorPool(logical, false, m_descriptorCount, m_descriptorPoolSize, *m_descriptorPool)) {
-					Framework::ErrorCheck::setError((char*)"Can't create descriptor pool");
-				}
+			void RayTracingPipeline::writeDescriptorSet(VkDescriptorSet set) {
+				Framework::Device* d = Framework::Device::getDevice();
+				VkDevice logical = d->getLogicalDevice();
 
-				if (!LavaCake::Core::AllocateDescriptorSets(logical, *m_descriptorPool, { *m_descriptorSetLayout }, m_descriptorSets)) {
-					Framework::ErrorCheck::setError((char*)"Can't allocate descriptor set");
-				}
 				m_bufferDescriptorUpdate = { };
-				int descriptorCount = 0;
 				for (uint32_t i = 0; i < m_uniforms.size(); i++) {
 					m_bufferDescriptorUpdate.push_back({
-						m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+						set,							// VkDescriptorSet                      TargetDescriptorSet
 						uint32_t(m_uniforms[i].binding),								// uint32_t                             TargetDescriptorBinding
 						0,																							// uint32_t                             TargetArrayElement
 						VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,							// VkDescriptorType                     TargetDescriptorType
@@ -401,7 +359,7 @@ namespace LavaCake {
 				m_imageDescriptorUpdate = { };
 				for (uint32_t i = 0; i < m_textures.size(); i++) {
 					m_imageDescriptorUpdate.push_back({
-						m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+						set,							// VkDescriptorSet                      TargetDescriptorSet
 						uint32_t(m_textures[i].binding),								// uint32_t                             TargetDescriptorBinding
 						0,																							// uint32_t                             TargetArrayElement
 						VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,			// VkDescriptorType                     TargetDescriptorType
@@ -424,7 +382,7 @@ namespace LavaCake {
 						});
 
 					m_imageDescriptorUpdate.push_back({
-						m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+						set,							// VkDescriptorSet                      TargetDescriptorSet
 						uint32_t(m_frameBuffers[i].binding),						// uint32_t                             TargetDescriptorBinding
 						0,																							// uint32_t                             TargetArrayElement
 						VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,			// VkDescriptorType                     TargetDescriptorType
@@ -433,7 +391,7 @@ namespace LavaCake {
 				}
 				for (uint32_t i = 0; i < m_attachments.size(); i++) {
 					m_imageDescriptorUpdate.push_back({
-							m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+							set,							// VkDescriptorSet                      TargetDescriptorSet
 							uint32_t(m_attachments[i].binding),								// uint32_t                             TargetDescriptorBinding
 							0,																							// uint32_t                             TargetArrayElement
 							VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,						// VkDescriptorType                     TargetDescriptorType
@@ -449,7 +407,7 @@ namespace LavaCake {
 
 				for (uint32_t i = 0; i < m_storageImages.size(); i++) {
 					m_imageDescriptorUpdate.push_back({
-							m_descriptorSets[descriptorCount],							// VkDescriptorSet                      TargetDescriptorSet
+							set,							// VkDescriptorSet                      TargetDescriptorSet
 							uint32_t(m_storageImages[i].binding),						// uint32_t                             TargetDescriptorBinding
 							0,																							// uint32_t                             TargetArrayElement
 							VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,								// VkDescriptorType                     TargetDescriptorType
@@ -467,7 +425,7 @@ namespace LavaCake {
 				for (uint32_t i = 0; i < m_texelBuffers.size(); i++) {
 
 					LavaCake::Core::TexelBufferDescriptorInfo info = {
-						m_descriptorSets[descriptorCount],
+						set,
 						uint32_t(m_texelBuffers[i].binding),
 						0,
 						VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
@@ -483,7 +441,7 @@ namespace LavaCake {
 				for (uint32_t i = 0; i < m_buffers.size(); i++) {
 
 					LavaCake::Core::BufferDescriptorInfo info = {
-						m_descriptorSets[descriptorCount],
+						set,
 						uint32_t(m_buffers[i].binding),
 						0,
 						VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
@@ -569,7 +527,7 @@ namespace LavaCake {
 					write_descriptors.push_back({
 						VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,                                 // VkStructureType                  sType
 						&descriptorAccelerationStructureInfos[i],																																// const void                     * pNext
-						m_descriptorSets[descriptorCount],																			// VkDescriptorSet                  dstSet
+						set,																			// VkDescriptorSet                  dstSet
 						m_AS[i].binding,																												// uint32_t                         dstBinding
 						0,																																			// uint32_t                         dstArrayElement
 						static_cast<uint32_t>(1),																								// uint32_t                         descriptorCount
@@ -50,6 +50,14 @@ namespace LavaCake {
 
 			void generateDescriptorLayout() override;
 
+		protected :
+
+			void writeDescriptorSet(VkDescriptorSet set) override;
+
+			std::vector<Framework::ShaderModule*> getShaderModules() override {
+				return m_modules;
+			};
+
 			
 
 
@@ -66,6 +74,7 @@ namespace LavaCake {
 			uint32_t m_currentGroupIndex = 0;
 
 			std::vector<VkPipelineShaderStageCreateInfo> m_shaderStages;
+			std::vector<Framework::ShaderModule*> m_modules;
 			std::vector<accelerationStructure> m_AS;
 
 			uint32_t m_width;
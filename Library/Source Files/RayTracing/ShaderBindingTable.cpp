@@ -33,7 +33,7 @@ namespace LavaCake {
       m_raygenShaderBindingTable.deviceAddress = m_raygenBuffer.getBufferDeviceAddress();
       m_raygenShaderBindingTable.stride = handleSizeAligned;
       m_raygenShaderBindingTable.size = m_rayGen.size() * handleSizeAligned;
-      vkMapMemory(logical, m_raygenBuffer.getMemory(), 0, VK_WHOLE_SIZE, 0, &raygenMem);
+      raygenMem = m_raygenBuffer.map();
 
       void* missMem;
       m_missBuffer.allocate(handleSize * m_miss.size(), VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VkMemoryPropertyFlagBits(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
@@ -41,7 +41,7 @@ namespace LavaCake {
       m_missShaderBindingTable.deviceAddress = m_missBuffer.getBufferDeviceAddress();
       m_missShaderBindingTable.stride = handleSizeAligned;
       m_missShaderBindingTable.size = m_miss.size() * handleSizeAligned;
-      vkMapMemory(logical, m_missBuffer.getMemory(), 0, VK_WHOLE_SIZE, 0, &missMem);
+      missMem = m_missBuffer.map();
 
       void* hitMem;
       m_hitBuffer.allocate(handleSize * m_hitGroup.size(), VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VkMemoryPropertyFlagBits(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
@@ -49,7 +49,7 @@ namespace LavaCake {
       m_hitShaderBindingTable.deviceAddress = m_hitBuffer.getBufferDeviceAddress();
       m_hitShaderBindingTable.stride = handleSizeAligned;
       m_hitShaderBindingTable.size = m_hitGroup.size() * handleSizeAligned;
-      vkMapMemory(logical, m_hitBuffer.getMemory(), 0, VK_WHOLE_SIZE, 0, &hitMem);
+      hitMem = m_hitBuffer.map();
 
       // Copy handles
       memcpy(raygenMem, shaderHandleStorage.data(), handleSize * m_rayGen.size());
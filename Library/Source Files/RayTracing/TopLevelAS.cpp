@@ -1,6 +1,8 @@
 #ifdef RAYTRACING
 #include "TopLevelAS.h"
 
+#include <cstring>
+
 namespace LavaCake {
   namespace RayTracing {
 
@@ -19,6 +21,13 @@ namespace LavaCake {
 
       }
 
+      void TopLevelAS::addInstance(BottomLevelAS* bottomLevelAS, const mat4& transform, uint32_t instanceID, uint32_t hitGroupOffset) {
+        std::array<float, 12> rows = affineRows(transform);
+        VkTransformMatrixKHR matrix;
+        std::memcpy(matrix.matrix, rows.data(), sizeof(matrix.matrix));
+        addInstance(bottomLevelAS, matrix, instanceID, hitGroupOffset);
+      }
+
       void TopLevelAS::alloctate(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff, bool allowUpdate) {
         Framework::Device* d = Framework::Device::getDevice();
         VkDevice logical = d->getLogicalDevice();
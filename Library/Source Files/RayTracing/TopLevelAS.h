@@ -2,6 +2,7 @@
 #pragma once
 #include "AllHeaders.h"
 #include "BottomLevelAS.h"
+#include "Math/basics.h"
 
 
 
@@ -12,6 +13,11 @@ namespace LavaCake {
     public:
       void addInstance(BottomLevelAS* bottomLevelAS, VkTransformMatrixKHR& transform, uint32_t instanceID, uint32_t hitGroupOffset);
 
+      /**
+       *\brief add an instance placed by an affine matrix, its three first rows are copied to the VkTransformMatrixKHR of the instance
+       */
+      void addInstance(BottomLevelAS* bottomLevelAS, const mat4& transform, uint32_t instanceID, uint32_t hitGroupOffset);
+
       void alloctate(Framework::Queue* queue, Framework::CommandBuffer& cmdBuff, bool allowUpdate = false);
 
       VkAccelerationStructureKHR& getHandle() {
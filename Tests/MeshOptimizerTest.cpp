@@ -0,0 +1,87 @@
+// The optimization passes reorder the triangles of a mesh, they must never add, remove or flip one.
+// Each triangle is compared through the positions of its corners, so the vertex reordering of optimizeVertexFetch is allowed.
+
+#include "Geometry/meshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+
+using namespace LavaCake;
+using namespace LavaCake::Geometry;
+
+typedef std::array<float, 9> Triangle;
+
+// the triangles of the mesh as positions, each starting at its smallest corner so that only the winding is kept
+static std::vector<Triangle> triangles(TriangleIndexedMesh* mesh) {
+  std::vector<Triangle> result;
+  const std::vector<float>& vertices = mesh->vertices();
+  const std::vector<uint32_t>& indices = mesh->indices();
+  size_t stride = mesh->vertexSize();
+  for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+    std::array<std::array<float, 3>, 3> corners;
+    for (size_t c = 0; c < 3; c++) {
+      const float* p = &vertices[size_t(indices[t + c]) * stride];
+      corners[c] = { p[0], p[1], p[2] };
+    }
+    size_t first = size_t(std::min_element(corners.begin(), corners.end()) - corners.begin());
+    Triangle triangle;
+    for (size_t c = 0; c < 3; c++) {
+      std::copy(corners[(first + c) % 3].begin(), corners[(first + c) % 3].end(), triangle.begin() + 3 * c);
+    }
+    result.push_back(triangle);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+// a bumpy grid of n x n quads, its triangles are shuffled so that the passes have work to do
+static void makeGrid(uint32_t n, std::vector<float>& vertices, std::vector<uint32_t>& indices) {
+  for (uint32_t j = 0; j <= n; j++) {
+    for (uint32_t i = 0; i <= n; i++) {
+      vertices.insert(vertices.end(), { float(i), float(j), float((i * 7 + j * 13) % 5) });
+    }
+  }
+  std::vector<std::array<uint32_t, 3>> quads;
+  for (uint32_t j = 0; j < n; j++) {
+    for (uint32_t i = 0; i < n; i++) {
+      uint32_t v = j * (n + 1) + i;
+      quads.push_back({ v, v + 1, v + n + 2 });
+      quads.push_back({ v, v + n + 2, v + n + 1 });
+    }
+  }
+  std::srand(1);
+  for (size_t q = quads.size(); q > 1; q--) {
+    std::swap(quads[q - 1], quads[size_t(std::rand()) % q]);
+  }
+  for (const std::array<uint32_t, 3>& q : quads) {
+    indices.insert(indices.end(), q.begin(), q.end());
+  }
+}
+
+static bool check(const char* name, std::vector<float> vertices, std::vector<uint32_t> indices) {
+  TriangleIndexedMesh mesh(vertices, indices, P3);
+  std::vector<Triangle> before = triangles(&mesh);
+  bool valid = true;
+  optimizeVertexCache(&mesh);
+  valid = valid && triangles(&mesh) == before;
+  optimizeOverdraw(&mesh);
+  valid = valid && triangles(&mesh) == before;
+  optimizeVertexFetch(&mesh);
+  valid = valid && triangles(&mesh) == before;
+  std::cout << name << (valid ? " : passed" : " : FAILED") << std::endl;
+  return valid;
+}
+
+int main() {
+  std::vector<float> quad = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f };
+  bool valid = true;
+  valid = check("degenerate first triangle", quad, { 0, 0, 1, 0, 1, 2, 1, 3, 2 }) && valid;
+  valid = check("degenerate mesh", quad, { 0, 0, 0, 1, 1, 1, 0, 0, 1 }) && valid;
+  std::vector<float> gridVertices;
+  std::vector<uint32_t> gridIndices;
+  makeGrid(64, gridVertices, gridIndices);
+  valid = check("shuffled grid", gridVertices, gridIndices) && valid;
+  return valid ? 0 : 1;
+}